@@ -0,0 +1,217 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains parallel serialization of object collections.
+//  Objects are split into chunks of BatchOptions::chunkSize objects, which are
+//  serialized by a pool of threads into per-chunk buffers and passed to the
+//  sink in the original order. At most BatchOptions::windowSize chunks are in
+//  flight, so memory usage doesn't depend on the size of the collection.
+//  Sink is any callable with void(const char* data, size_t size) signature,
+//  it's always called from the calling thread. Neither sink nor serialization
+//  should throw.
+//  E.g.:
+//  BatchToString(objects.begin(), objects.end(), [&](const char* data, size_t size)
+//  {
+//      file.write(data, size);
+//  });
+//
+
+#pragma once
+
+#include "FlatBuffer.h"
+#include "Serialization.h"
+#include "TextWriter.h"
+#include "ToJson.h"
+#include "ToString.h"
+#include <stddef.h>
+#include <algorithm>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace vklib
+{
+
+struct BatchOptions
+{
+    unsigned threadCount = std::thread::hardware_concurrency();
+    size_t chunkSize = 1024;
+    //  0 means twice the count of threads
+    size_t windowSize = 0;
+};
+
+//
+//  Calls writeObject(std::string& buffer, const T& obj) for every object of
+//  [begin, end) and passes concatenated buffers to the sink in order
+//
+template<class IteratorT, class WriteObjectT, class SinkT>
+void BatchWrite(IteratorT begin, IteratorT end, WriteObjectT writeObject, SinkT&& sink,
+    const BatchOptions& options = BatchOptions())
+{
+    static_assert(std::is_base_of<std::random_access_iterator_tag,
+        typename std::iterator_traits<IteratorT>::iterator_category>::value, "Random access iterators are expected");
+
+    const size_t count = end - begin;
+    const size_t chunkSize = std::max<size_t>(options.chunkSize, 1);
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    const size_t threadCount = std::min<size_t>(std::max(options.threadCount, 1u), chunkCount);
+
+    const auto writeChunk = [&](size_t chunk, std::string& buffer)
+    {
+        buffer.clear();
+        const IteratorT chunkEnd = begin + std::min(count, (chunk + 1) * chunkSize);
+        for(IteratorT item = begin + chunk * chunkSize; item != chunkEnd; ++item)
+            writeObject(buffer, *item);
+    };
+
+    if(threadCount <= 1)
+    {
+        std::string buffer;
+        for(size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            writeChunk(chunk, buffer);
+            sink(buffer.data(), buffer.size());
+        }
+        return;
+    }
+
+    //  Chunk n is written to slot n % windowSize, which is reused only after
+    //  the chunk was passed to the sink
+    struct Slot
+    {
+        std::string buffer;
+        bool ready = false;
+    };
+
+    const size_t windowSize = std::max(options.windowSize ? options.windowSize : threadCount * 2, threadCount);
+    std::vector<Slot> slots(windowSize);
+    std::mutex mutex;
+    std::condition_variable produced;
+    std::condition_variable consumed;
+    size_t nextChunk = 0;
+    size_t writtenCount = 0;
+
+    const auto runWorker = [&]()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for(;;)
+        {
+            consumed.wait(lock, [&]() { return nextChunk == chunkCount || nextChunk < writtenCount + windowSize; });
+            if(nextChunk == chunkCount)
+                return;
+
+            const size_t chunk = nextChunk++;
+            Slot& slot = slots[chunk % windowSize];
+            lock.unlock();
+            writeChunk(chunk, slot.buffer);
+            lock.lock();
+            slot.ready = true;
+            produced.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < threadCount; ++i)
+        threads.emplace_back(runWorker);
+
+    for(size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        Slot& slot = slots[chunk % windowSize];
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            produced.wait(lock, [&]() { return slot.ready; });
+        }
+        sink(slot.buffer.data(), slot.buffer.size());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            slot.ready = false;
+            ++writtenCount;
+        }
+        consumed.notify_all();
+    }
+
+    for(std::thread& thread : threads)
+        thread.join();
+}
+
+//
+//  ToString of every object followed by new line
+//
+template<class IteratorT, class SinkT>
+void BatchToString(IteratorT begin, IteratorT end, SinkT&& sink, const BatchOptions& options = BatchOptions())
+{
+    BatchWrite(begin, end, [](std::string& buffer, const auto& obj)
+    {
+        StringWriter writer(buffer);
+        ToString(writer, obj);
+        buffer.push_back('\n');
+    }, sink, options);
+}
+
+//
+//  JSON lines: ToJson of every object followed by new line
+//
+template<class IteratorT, class SinkT>
+void BatchToJson(IteratorT begin, IteratorT end, SinkT&& sink, const BatchOptions& options = BatchOptions())
+{
+    BatchWrite(begin, end, [](std::string& buffer, const auto& obj)
+    {
+        StringWriter writer(buffer);
+        ToJson(writer, obj);
+        buffer.push_back('\n');
+    }, sink, options);
+}
+
+//
+//  Concatenated BinarySerialize of every object
+//
+template<class IteratorT, class SinkT>
+void BatchBinarySerialize(IteratorT begin, IteratorT end, SinkT&& sink, const BatchOptions& options = BatchOptions())
+{
+    BatchWrite(begin, end, [](std::string& buffer, const auto& obj)
+    {
+        BinarySerialize(buffer, obj);
+    }, sink, options);
+}
+
+//
+//  FlatSerialize of every object. Every object is padded to 8 bytes, so the
+//  output can be read by FlatView object by object.
+//
+template<class IteratorT, class SinkT>
+void BatchFlatSerialize(IteratorT begin, IteratorT end, SinkT&& sink, const BatchOptions& options = BatchOptions())
+{
+    BatchWrite(begin, end, [](std::string& buffer, const auto& obj)
+    {
+        FlatSerialize(buffer, obj);
+        buffer.resize(FlatLayout::Align(buffer.size(), FlatLayout::OBJECT_ALIGNMENT));
+    }, sink, options);
+}
+
+};  //  namespace vklib
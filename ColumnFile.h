@@ -0,0 +1,880 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains columnar file format of sets of reflectable objects.
+//  Every field becomes a column, which encoding is chosen by its values:
+//  - integers, bools and enums take the smallest of plain, bit packed
+//    difference from minimum, bit packed zigzag delta and run length
+//    encodings;
+//  - strings take dictionary with bit packed indexes, when it's smaller than
+//    plain strings;
+//  - floating point values are plain;
+//  - other fields are written with BinarySerialize (see Serialization.h).
+//  File consists of:
+//  - header: "VKCF", uint32 version, uint64 count of rows, uint32 count of
+//    columns;
+//  - column directory: uint32 name size, name, uint8 kind of values, uint8
+//    size of value, uint8 encoding, uint64 offset and uint64 size of column;
+//  - columns, aligned to 8 bytes.
+//  Columns are found by field names, so fields can be added, removed and
+//  reordered. Reader maps the file and decodes only the requested columns.
+//  Numbers are written in host byte order.
+//  E.g.:
+//  WriteColumnFile("users.vkcf", users);
+//  ColumnFileReader reader;
+//  std::vector<User> loaded;
+//  bool ok = reader.Open("users.vkcf") && reader.Read<ID, NAME>(loaded);
+//
+
+#pragma once
+
+#include "FlatBuffer.h"
+#include "Reflection.h"
+#include "Serialization.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vklib
+{
+
+enum class ColumnEncoding : uint8_t
+{
+    Plain,
+    FrameOfReference,
+    Delta,
+    RunLength,
+    Dictionary,
+    Strings,
+    Binary
+};
+
+enum class ColumnValueKind : uint8_t
+{
+    Signed,
+    Unsigned,
+    Float,
+    String,
+    Binary
+};
+
+template<class T>
+struct ColumnInteger
+{
+    typedef std::conditional_t<std::is_enum<T>::value, std::underlying_type<T>, std::remove_cv<T>> UnderlyingType;
+    typedef typename UnderlyingType::type type;
+};
+
+template<class T, class = void>
+struct IsColumnString : std::false_type {};
+
+template<class T>
+struct IsColumnString<T, std::void_t<typename T::value_type>> : std::bool_constant<
+    std::is_same<typename T::value_type, char>::value && std::is_convertible<const T&, std::string_view>::value> {};
+
+template<class T>
+constexpr ColumnValueKind GetColumnValueKind()
+{
+    if constexpr(std::is_floating_point<T>::value)
+        return ColumnValueKind::Float;
+    else if constexpr(std::is_integral<T>::value || std::is_enum<T>::value)
+        return std::is_signed<typename ColumnInteger<T>::type>::value ? ColumnValueKind::Signed : ColumnValueKind::Unsigned;
+    else if constexpr(IsColumnString<T>::value)
+        return ColumnValueKind::String;
+    else
+        return ColumnValueKind::Binary;
+}
+
+//
+//  Bit packing, integer mapping and layout of the format
+//
+class ColumnCodec
+{
+public:
+    static constexpr uint32_t MAGIC = 0x46434B56;   //  "VKCF"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 20;
+    //  Packed bits are followed by zero bytes, so reader always loads 9 bytes
+    static constexpr size_t BITS_PADDING = 9;
+    static constexpr uint64_t SIGN_BIT = uint64_t(1) << 63;
+
+    static uint32_t GetBitWidth(uint64_t value)
+    {
+        uint32_t width = 0;
+        for(; value; value >>= 1)
+            ++width;
+        return width;
+    }
+
+    static size_t GetPackedSize(size_t count, uint32_t width)
+    {
+        return (uint64_t(count) * width + 7) / 8 + BITS_PADDING;
+    }
+
+    template<class BufferT, class ValueFunctionT>
+    static void WriteBits(BufferT& buffer, size_t count, uint32_t width, ValueFunctionT&& getValue)
+    {
+        const size_t start = buffer.size();
+        buffer.resize(start + GetPackedSize(count, width), 0);
+        uint8_t* data = reinterpret_cast<uint8_t*>(&buffer[start]);
+        uint64_t position = 0;
+        for(size_t i = 0; i < count && width; ++i, position += width)
+        {
+            const uint64_t value = getValue(i);
+            const uint32_t shift = position % 8;
+            uint8_t* place = data + position / 8;
+            uint64_t word;
+            memcpy(&word, place, sizeof(word));
+            word |= value << shift;
+            memcpy(place, &word, sizeof(word));
+            if(shift + width > 64)
+                place[8] |= static_cast<uint8_t>(value >> (64 - shift));
+        }
+    }
+
+    static uint64_t ReadBits(const uint8_t* data, uint64_t position, uint32_t width)
+    {
+        const uint8_t* place = data + position / 8;
+        const uint32_t shift = position % 8;
+        uint64_t word;
+        memcpy(&word, place, sizeof(word));
+        uint64_t value = word >> shift;
+        if(shift + width > 64)
+            value |= uint64_t(place[8]) << (64 - shift);
+        return width == 64 ? value : value & ((uint64_t(1) << width) - 1);
+    }
+
+    //
+    //  Integers are mapped to uint64 with the same order
+    //
+    template<class T>
+    static uint64_t ToOrdered(T value)
+    {
+        typedef typename ColumnInteger<T>::type IntegerT;
+        if constexpr(std::is_signed<IntegerT>::value)
+            return static_cast<uint64_t>(static_cast<int64_t>(static_cast<IntegerT>(value))) ^ SIGN_BIT;
+        else
+            return static_cast<uint64_t>(static_cast<IntegerT>(value));
+    }
+
+    template<class T>
+    static T FromOrdered(uint64_t value)
+    {
+        typedef typename ColumnInteger<T>::type IntegerT;
+        if constexpr(std::is_signed<IntegerT>::value)
+            return static_cast<T>(static_cast<IntegerT>(static_cast<int64_t>(value ^ SIGN_BIT)));
+        else
+            return static_cast<T>(static_cast<IntegerT>(value));
+    }
+
+    static uint64_t ZigZag(uint64_t delta)
+    {
+        return (delta << 1) ^ (static_cast<int64_t>(delta) < 0 ? ~uint64_t(0) : 0);
+    }
+
+    static uint64_t UnZigZag(uint64_t value)
+    {
+        return (value >> 1) ^ (~(value & 1) + 1);
+    }
+
+    template<class BufferT, class T>
+    static void Append(BufferT& buffer, const T& value)
+    {
+        const auto* bytes = reinterpret_cast<const typename BufferT::value_type*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<class T>
+    static T Load(const uint8_t* data)
+    {
+        T value;
+        memcpy(&value, data, sizeof(T));
+        return value;
+    }
+};
+
+//
+//  Encodes values of one column
+//
+template<class BufferT>
+class ColumnEncoder
+{
+protected:
+    BufferT& _buffer;
+
+    template<class T>
+    ColumnEncoding EncodeIntegers(const std::vector<uint64_t>& values)
+    {
+        const size_t count = values.size();
+        uint64_t minimum = ~uint64_t(0);
+        uint64_t maximum = 0;
+        uint64_t maximumDelta = 0;
+        size_t runCount = 0;
+        for(size_t i = 0; i < count; ++i)
+        {
+            minimum = std::min(minimum, values[i]);
+            maximum = std::max(maximum, values[i]);
+            if(i > 0)
+                maximumDelta = std::max(maximumDelta, ColumnCodec::ZigZag(values[i] - values[i - 1]));
+            if(i == 0 || values[i] != values[i - 1])
+                ++runCount;
+        }
+
+        //  Bit width is at least 1, so size of the column bounds count of rows
+        //  (see ColumnFileReader::CheckRowCount), equal values take a single run
+        const uint32_t referenceWidth = std::max(ColumnCodec::GetBitWidth(maximum - minimum), uint32_t(1));
+        const uint32_t deltaWidth = std::max(ColumnCodec::GetBitWidth(maximumDelta), uint32_t(1));
+        const size_t plainSize = count * sizeof(T);
+        const size_t referenceSize = 9 + ColumnCodec::GetPackedSize(count, referenceWidth);
+        const size_t deltaSize = 9 + ColumnCodec::GetPackedSize(count ? count - 1 : 0, deltaWidth);
+        const size_t runLengthSize = 8 + runCount * 12;
+        const size_t smallest = std::min({ plainSize, referenceSize, deltaSize, runLengthSize });
+
+        if(smallest == plainSize)
+        {
+            for(uint64_t value : values)
+                ColumnCodec::Append(_buffer, ColumnCodec::FromOrdered<T>(value));
+            return ColumnEncoding::Plain;
+        }
+        if(smallest == referenceSize)
+        {
+            ColumnCodec::Append(_buffer, minimum);
+            ColumnCodec::Append(_buffer, static_cast<uint8_t>(referenceWidth));
+            ColumnCodec::WriteBits(_buffer, count, referenceWidth, [&](size_t i) { return values[i] - minimum; });
+            return ColumnEncoding::FrameOfReference;
+        }
+        if(smallest == deltaSize)
+        {
+            ColumnCodec::Append(_buffer, count ? values[0] : 0);
+            ColumnCodec::Append(_buffer, static_cast<uint8_t>(deltaWidth));
+            ColumnCodec::WriteBits(_buffer, count ? count - 1 : 0, deltaWidth,
+                [&](size_t i) { return ColumnCodec::ZigZag(values[i + 1] - values[i]); });
+            return ColumnEncoding::Delta;
+        }
+
+        ColumnCodec::Append(_buffer, static_cast<uint64_t>(runCount));
+        for(size_t i = 0; i < count; )
+        {
+            size_t next = i + 1;
+            while(next < count && values[next] == values[i] && next - i < UINT32_MAX)
+                ++next;
+            ColumnCodec::Append(_buffer, values[i]);
+            ColumnCodec::Append(_buffer, static_cast<uint32_t>(next - i));
+            i = next;
+        }
+        return ColumnEncoding::RunLength;
+    }
+
+    void WriteStrings(const std::vector<std::string_view>& values)
+    {
+        uint32_t offset = 0;
+        ColumnCodec::Append(_buffer, offset);
+        for(std::string_view value : values)
+        {
+            offset += static_cast<uint32_t>(value.size());
+            ColumnCodec::Append(_buffer, offset);
+        }
+        for(std::string_view value : values)
+            _buffer.insert(_buffer.end(), value.begin(), value.end());
+    }
+
+    ColumnEncoding EncodeStrings(const std::vector<std::string_view>& values)
+    {
+        std::unordered_map<std::string_view, uint32_t> index;
+        std::vector<std::string_view> dictionary;
+        std::vector<uint32_t> indexes;
+        indexes.reserve(values.size());
+        size_t plainSize = sizeof(uint32_t) * (values.size() + 1);
+        size_t dictionarySize = sizeof(uint32_t) * 2;
+        for(std::string_view value : values)
+        {
+            plainSize += value.size();
+            const auto inserted = index.emplace(value, static_cast<uint32_t>(dictionary.size()));
+            if(inserted.second)
+            {
+                dictionary.push_back(value);
+                dictionarySize += sizeof(uint32_t) + value.size();
+            }
+            indexes.push_back(inserted.first->second);
+        }
+
+        const uint32_t width = std::max(ColumnCodec::GetBitWidth(dictionary.size() > 1 ? dictionary.size() - 1 : 0), uint32_t(1));
+        dictionarySize += 1 + ColumnCodec::GetPackedSize(values.size(), width);
+        if(plainSize <= dictionarySize)
+        {
+            WriteStrings(values);
+            return ColumnEncoding::Strings;
+        }
+
+        ColumnCodec::Append(_buffer, static_cast<uint32_t>(dictionary.size()));
+        WriteStrings(dictionary);
+        ColumnCodec::Append(_buffer, static_cast<uint8_t>(width));
+        ColumnCodec::WriteBits(_buffer, indexes.size(), width, [&](size_t i) { return indexes[i]; });
+        return ColumnEncoding::Dictionary;
+    }
+
+public:
+    explicit ColumnEncoder(BufferT& buffer) : _buffer(buffer) {}
+
+    //
+    //  Writes the field of all objects and returns its encoding
+    //
+    template<uint32_t fieldId, class RangeT>
+    ColumnEncoding Encode(const RangeT& objects)
+    {
+        typedef std::remove_cv_t<std::remove_reference_t<decltype(Reflection::GetFieldValue<fieldId>(*objects.begin()))>> FieldT;
+        constexpr ColumnValueKind kind = GetColumnValueKind<FieldT>();
+        if constexpr(kind == ColumnValueKind::Signed || kind == ColumnValueKind::Unsigned)
+        {
+            std::vector<uint64_t> values;
+            for(const auto& obj : objects)
+                values.push_back(ColumnCodec::ToOrdered(Reflection::GetFieldValue<fieldId>(obj)));
+            return EncodeIntegers<FieldT>(values);
+        }
+        else if constexpr(kind == ColumnValueKind::Float)
+        {
+            for(const auto& obj : objects)
+                ColumnCodec::Append(_buffer, Reflection::GetFieldValue<fieldId>(obj));
+            return ColumnEncoding::Plain;
+        }
+        else if constexpr(kind == ColumnValueKind::String)
+        {
+            std::vector<std::string_view> values;
+            for(const auto& obj : objects)
+                values.push_back(Reflection::GetFieldValue<fieldId>(obj));
+            return EncodeStrings(values);
+        }
+        else
+        {
+            BinarySerializer<BufferT> serializer(_buffer);
+            for(const auto& obj : objects)
+                serializer.Visit(Reflection::GetFieldValue<fieldId>(obj));
+            return ColumnEncoding::Binary;
+        }
+    }
+};
+
+template<class BufferT, class RangeT>
+class ColumnFileWriter
+{
+protected:
+    typedef std::remove_cv_t<std::remove_reference_t<decltype(*std::declval<const RangeT&>().begin())>> ReflectableClass;
+    static constexpr uint32_t COUNT_OF_FIELDS = Reflection::GetFieldCount<ReflectableClass>();
+
+    static constexpr size_t DIRECTORY_ENTRY_SIZE = sizeof(uint32_t) + 3 + 2 * sizeof(uint64_t);
+
+    template<uint32_t... Index>
+    static size_t GetDirectorySize(std::integer_sequence<uint32_t, Index...>)
+    {
+        return (0 + ... + (DIRECTORY_ENTRY_SIZE + strlen(Reflection::GetFieldName<ReflectableClass, Index>())));
+    }
+
+    template<uint32_t fieldId>
+    static void WriteColumn(BufferT& buffer, const RangeT& objects, size_t start, size_t& directoryPosition)
+    {
+        typedef Reflection::FieldType<ReflectableClass, fieldId> FieldT;
+        while((buffer.size() - start) % 8)
+            buffer.push_back(0);
+
+        const uint64_t offset = buffer.size() - start;
+        const ColumnEncoding encoding = ColumnEncoder<BufferT>(buffer).template Encode<fieldId>(objects);
+        const uint64_t size = buffer.size() - start - offset;
+
+        const char* name = Reflection::GetFieldName<ReflectableClass, fieldId>();
+        const uint32_t nameSize = static_cast<uint32_t>(strlen(name));
+        const uint8_t entry[] = { static_cast<uint8_t>(GetColumnValueKind<FieldT>()),
+            static_cast<uint8_t>(sizeof(FieldT) < 256 ? sizeof(FieldT) : 0), static_cast<uint8_t>(encoding) };
+        uint8_t* place = reinterpret_cast<uint8_t*>(&buffer[directoryPosition]);
+        memcpy(place, &nameSize, sizeof(nameSize));
+        memcpy(place += sizeof(nameSize), name, nameSize);
+        memcpy(place += nameSize, entry, sizeof(entry));
+        memcpy(place += sizeof(entry), &offset, sizeof(offset));
+        memcpy(place += sizeof(offset), &size, sizeof(size));
+        directoryPosition += DIRECTORY_ENTRY_SIZE + nameSize;
+    }
+
+    template<uint32_t... Index>
+    static void WriteColumns(BufferT& buffer, const RangeT& objects, size_t start, size_t directoryPosition,
+        std::integer_sequence<uint32_t, Index...>)
+    {
+        (WriteColumn<Index>(buffer, objects, start, directoryPosition), ...);
+    }
+
+public:
+    static void Write(BufferT& buffer, const RangeT& objects)
+    {
+        typedef std::make_integer_sequence<uint32_t, COUNT_OF_FIELDS> FieldIndexes;
+        const size_t start = buffer.size();
+        ColumnCodec::Append(buffer, ColumnCodec::MAGIC);
+        ColumnCodec::Append(buffer, ColumnCodec::VERSION);
+        ColumnCodec::Append(buffer, static_cast<uint64_t>(std::distance(objects.begin(), objects.end())));
+        ColumnCodec::Append(buffer, COUNT_OF_FIELDS);
+        const size_t directoryPosition = buffer.size();
+        buffer.resize(directoryPosition + GetDirectorySize(FieldIndexes()));
+        //  Offsets are from the beginning of the file
+        WriteColumns(buffer, objects, start, directoryPosition, FieldIndexes());
+    }
+};
+
+//
+//  Appends columnar file of the objects (any range of reflectable objects)
+//  to the buffer
+//
+template<class BufferT, class RangeT>
+void ColumnSerialize(BufferT& buffer, const RangeT& objects)
+{
+    ColumnFileWriter<BufferT, RangeT>::Write(buffer, objects);
+}
+
+template<class RangeT>
+bool WriteColumnFile(const char* path, const RangeT& objects)
+{
+    std::vector<uint8_t> buffer;
+    ColumnSerialize(buffer, objects);
+    FILE* file = fopen(path, "wb");
+    if(!file)
+        return false;
+
+    const bool written = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    return fclose(file) == 0 && written;
+}
+
+class ColumnFileReader
+{
+public:
+    struct Column
+    {
+        std::string_view name;
+        ColumnValueKind kind;
+        uint8_t valueSize;
+        ColumnEncoding encoding;
+        const uint8_t* data;
+        size_t size;
+    };
+
+protected:
+    MappedFile _file;
+    uint64_t _rowCount = 0;
+    std::vector<Column> _columns;
+
+    //
+    //  Calls setValue(row, value) for every row
+    //
+    template<class T, class SetterT>
+    bool DecodeIntegers(const Column& column, SetterT&& setValue) const
+    {
+        const uint8_t* data = column.data;
+        const size_t count = _rowCount;
+        switch(column.encoding)
+        {
+        case ColumnEncoding::Plain:
+            if(column.size != count * sizeof(T))
+                return false;
+            for(size_t i = 0; i < count; ++i)
+                setValue(i, ColumnCodec::Load<T>(data + i * sizeof(T)));
+            return true;
+
+        case ColumnEncoding::FrameOfReference:
+        case ColumnEncoding::Delta:
+        {
+            if(column.size < 9)
+                return false;
+            const uint64_t first = ColumnCodec::Load<uint64_t>(data);
+            const uint32_t width = data[8];
+            const bool isDelta = column.encoding == ColumnEncoding::Delta;
+            const size_t packedCount = isDelta && count ? count - 1 : count;
+            if(width > 64 || column.size < 9 + ColumnCodec::GetPackedSize(packedCount, width))
+                return false;
+            const uint8_t* bits = data + 9;
+            uint64_t value = first;
+            for(size_t i = 0; i < count; ++i)
+            {
+                if(!isDelta)
+                    value = first + ColumnCodec::ReadBits(bits, uint64_t(i) * width, width);
+                else if(i > 0)
+                    value += ColumnCodec::UnZigZag(ColumnCodec::ReadBits(bits, uint64_t(i - 1) * width, width));
+                setValue(i, ColumnCodec::FromOrdered<T>(value));
+            }
+            return true;
+        }
+
+        case ColumnEncoding::RunLength:
+        {
+            if(column.size < 8)
+                return false;
+            const uint64_t runCount = ColumnCodec::Load<uint64_t>(data);
+            if((column.size - 8) / 12 < runCount)
+                return false;
+            size_t row = 0;
+            for(uint64_t run = 0; run < runCount; ++run)
+            {
+                const uint8_t* place = data + 8 + run * 12;
+                const T value = ColumnCodec::FromOrdered<T>(ColumnCodec::Load<uint64_t>(place));
+                const uint32_t length = ColumnCodec::Load<uint32_t>(place + 8);
+                if(length > count - row)
+                    return false;
+                for(const size_t end = row + length; row < end; ++row)
+                    setValue(row, value);
+            }
+            return row == count;
+        }
+
+        default:
+            return false;
+        }
+    }
+
+    //
+    //  Strings of plain encoding or dictionary, count of strings is given
+    //
+    static bool ParseStrings(const uint8_t* data, size_t size, size_t count, const uint8_t*& offsets,
+        const char*& characters, size_t& consumed)
+    {
+        const size_t offsetsSize = sizeof(uint32_t) * (count + 1);
+        if(size < offsetsSize)
+            return false;
+
+        offsets = data;
+        characters = reinterpret_cast<const char*>(data + offsetsSize);
+        const uint32_t total = ColumnCodec::Load<uint32_t>(data + sizeof(uint32_t) * count);
+        if(size - offsetsSize < total)
+            return false;
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            if(ColumnCodec::Load<uint32_t>(data + sizeof(uint32_t) * i) > ColumnCodec::Load<uint32_t>(data + sizeof(uint32_t) * (i + 1)))
+                return false;
+        }
+        consumed = offsetsSize + total;
+        return true;
+    }
+
+    static std::string_view GetString(const uint8_t* offsets, const char* characters, size_t index)
+    {
+        const uint32_t begin = ColumnCodec::Load<uint32_t>(offsets + sizeof(uint32_t) * index);
+        const uint32_t end = ColumnCodec::Load<uint32_t>(offsets + sizeof(uint32_t) * (index + 1));
+        return std::string_view(characters + begin, end - begin);
+    }
+
+    template<class SetterT>
+    bool DecodeStrings(const Column& column, SetterT&& setValue) const
+    {
+        const uint8_t* offsets = nullptr;
+        const char* characters = nullptr;
+        size_t consumed = 0;
+        if(column.encoding == ColumnEncoding::Strings)
+        {
+            if(!ParseStrings(column.data, column.size, _rowCount, offsets, characters, consumed))
+                return false;
+            for(size_t i = 0; i < _rowCount; ++i)
+                setValue(i, GetString(offsets, characters, i));
+            return true;
+        }
+
+        if(column.encoding != ColumnEncoding::Dictionary || column.size < sizeof(uint32_t))
+            return false;
+
+        const uint32_t dictionarySize = ColumnCodec::Load<uint32_t>(column.data);
+        if(!ParseStrings(column.data + sizeof(uint32_t), column.size - sizeof(uint32_t), dictionarySize, offsets,
+            characters, consumed))
+        {
+            return false;
+        }
+
+        const uint8_t* data = column.data + sizeof(uint32_t) + consumed;
+        const size_t remaining = column.size - sizeof(uint32_t) - consumed;
+        if(remaining < 1)
+            return false;
+        const uint32_t width = data[0];
+        if(width > 32 || remaining < 1 + ColumnCodec::GetPackedSize(_rowCount, width))
+            return false;
+
+        for(size_t i = 0; i < _rowCount; ++i)
+        {
+            const uint64_t index = ColumnCodec::ReadBits(data + 1, uint64_t(i) * width, width);
+            if(index >= dictionarySize)
+                return false;
+            setValue(i, GetString(offsets, characters, index));
+        }
+        return true;
+    }
+
+    template<class FieldT, class AccessorT>
+    bool DecodeColumn(const Column& column, AccessorT&& getField) const
+    {
+        constexpr ColumnValueKind kind = GetColumnValueKind<FieldT>();
+        if(column.kind != kind || (kind != ColumnValueKind::String && kind != ColumnValueKind::Binary
+            && column.valueSize != sizeof(FieldT)))
+        {
+            return false;
+        }
+
+        if constexpr(kind == ColumnValueKind::Signed || kind == ColumnValueKind::Unsigned)
+            return DecodeIntegers<FieldT>(column, [&](size_t row, FieldT value) { getField(row) = value; });
+        else if constexpr(kind == ColumnValueKind::Float)
+        {
+            if(column.encoding != ColumnEncoding::Plain || column.size != _rowCount * sizeof(FieldT))
+                return false;
+            for(size_t i = 0; i < _rowCount; ++i)
+                getField(i) = ColumnCodec::Load<FieldT>(column.data + i * sizeof(FieldT));
+            return true;
+        }
+        else if constexpr(kind == ColumnValueKind::String)
+        {
+            return DecodeStrings(column,
+                [&](size_t row, std::string_view value) { getField(row).assign(value.data(), value.size()); });
+        }
+        else
+        {
+            if(column.encoding != ColumnEncoding::Binary)
+                return false;
+            BinaryDeserializer<> deserializer(column.data, column.size);
+            for(size_t i = 0; i < _rowCount; ++i)
+            {
+                if(!deserializer.Visit(getField(i)))
+                    return false;
+            }
+            return deserializer.Remaining() == 0;
+        }
+    }
+
+    template<class ReflectableClass, uint32_t fieldId>
+    bool ReadField(std::vector<ReflectableClass>& objects) const
+    {
+        const Column* column = FindColumn(Reflection::GetFieldName<ReflectableClass, fieldId>());
+        if(!column)
+            return true;
+
+        return DecodeColumn<Reflection::FieldType<ReflectableClass, fieldId>>(*column,
+            [&](size_t row) -> decltype(auto) { return Reflection::GetFieldValue<fieldId>(objects[row]); });
+    }
+
+    template<class ReflectableClass, uint32_t... Index>
+    bool ReadFields(std::vector<ReflectableClass>& objects, std::integer_sequence<uint32_t, Index...>) const
+    {
+        return (ReadField<ReflectableClass, Index>(objects) && ...);
+    }
+
+    //
+    //  Count of rows from the header isn't trusted, it should fit sizes of
+    //  the columns, which depend on it. bounded is set if the column depends
+    //  on it: packed columns of zero bit width don't, writer doesn't create
+    //  them.
+    //
+    static bool CheckRowCount(const Column& column, uint64_t rowCount, bool& bounded)
+    {
+        bounded = true;
+        const uint8_t* data = column.data;
+        const size_t size = column.size;
+        switch(column.encoding)
+        {
+        case ColumnEncoding::Plain:
+            return column.valueSize != 0 && rowCount <= size / column.valueSize;
+
+        case ColumnEncoding::FrameOfReference:
+        case ColumnEncoding::Delta:
+        {
+            if(size < 9 + ColumnCodec::BITS_PADDING || data[8] > 64)
+                return false;
+            const uint32_t width = data[8];
+            const uint64_t packedCount = column.encoding == ColumnEncoding::Delta && rowCount ? rowCount - 1 : rowCount;
+            bounded = width != 0;
+            return width == 0 || packedCount <= (size - 9 - ColumnCodec::BITS_PADDING) * 8 / width;
+        }
+
+        case ColumnEncoding::RunLength:
+        {
+            if(size < 8)
+                return false;
+            const uint64_t runCount = ColumnCodec::Load<uint64_t>(data);
+            if((size - 8) / 12 < runCount)
+                return false;
+            uint64_t total = 0;
+            for(uint64_t run = 0; run < runCount; ++run)
+                total += ColumnCodec::Load<uint32_t>(data + 8 + run * 12 + 8);
+            return total == rowCount;
+        }
+
+        case ColumnEncoding::Strings:
+            return rowCount < size / sizeof(uint32_t);
+
+        case ColumnEncoding::Dictionary:
+        {
+            const uint8_t* offsets = nullptr;
+            const char* characters = nullptr;
+            size_t consumed = 0;
+            if(size < sizeof(uint32_t) || !ParseStrings(data + sizeof(uint32_t), size - sizeof(uint32_t),
+                ColumnCodec::Load<uint32_t>(data), offsets, characters, consumed))
+            {
+                return false;
+            }
+            const size_t remaining = size - sizeof(uint32_t) - consumed;
+            if(remaining < 1 + ColumnCodec::BITS_PADDING)
+                return false;
+            const uint32_t width = data[sizeof(uint32_t) + consumed];
+            bounded = width != 0;
+            return width <= 32 && (width == 0 || rowCount <= (remaining - 1 - ColumnCodec::BITS_PADDING) * 8 / width);
+        }
+
+        case ColumnEncoding::Binary:
+            //  Every value takes at least one byte
+            return rowCount <= size;
+
+        default:
+            //  Unknown encodings are rejected when the column is read
+            bounded = false;
+            return true;
+        }
+    }
+
+    bool Parse(const uint8_t* data, size_t size)
+    {
+        _columns.clear();
+        _rowCount = 0;
+        if(size < ColumnCodec::HEADER_SIZE || ColumnCodec::Load<uint32_t>(data) != ColumnCodec::MAGIC
+            || ColumnCodec::Load<uint32_t>(data + 4) != ColumnCodec::VERSION)
+        {
+            return false;
+        }
+
+        const uint64_t rowCount = ColumnCodec::Load<uint64_t>(data + 8);
+        const uint32_t columnCount = ColumnCodec::Load<uint32_t>(data + 16);
+        size_t position = ColumnCodec::HEADER_SIZE;
+        bool isRowCountBounded = false;
+        for(uint32_t i = 0; i < columnCount; ++i)
+        {
+            if(size - position < sizeof(uint32_t))
+                return false;
+            const uint32_t nameSize = ColumnCodec::Load<uint32_t>(data + position);
+            position += sizeof(uint32_t);
+            if(size - position < nameSize + 3 + 2 * sizeof(uint64_t))
+                return false;
+
+            Column column;
+            column.name = std::string_view(reinterpret_cast<const char*>(data + position), nameSize);
+            position += nameSize;
+            column.kind = static_cast<ColumnValueKind>(data[position]);
+            column.valueSize = data[position + 1];
+            column.encoding = static_cast<ColumnEncoding>(data[position + 2]);
+            const uint64_t offset = ColumnCodec::Load<uint64_t>(data + position + 3);
+            const uint64_t columnSize = ColumnCodec::Load<uint64_t>(data + position + 3 + sizeof(uint64_t));
+            position += 3 + 2 * sizeof(uint64_t);
+            if(offset > size || size - offset < columnSize)
+                return false;
+            column.data = data + offset;
+            column.size = columnSize;
+            bool bounded = false;
+            if(!CheckRowCount(column, rowCount, bounded))
+                return false;
+            isRowCountBounded |= bounded;
+            _columns.push_back(column);
+        }
+
+        //  No column depends on count of rows, so limit it by size of the file
+        if(!isRowCountBounded && rowCount > size)
+            return false;
+
+        _rowCount = rowCount;
+        return true;
+    }
+
+public:
+    ColumnFileReader() = default;
+    ColumnFileReader(const ColumnFileReader&) = delete;
+    ColumnFileReader& operator=(const ColumnFileReader&) = delete;
+
+    //
+    //  Maps the file, columns are decoded only when they are read
+    //
+    bool Open(const char* path)
+    {
+        _columns.clear();
+        _rowCount = 0;
+        return _file.Open(path) && Parse(_file.Data(), _file.Size());
+    }
+
+    //
+    //  Reads file in memory, which should outlive the reader
+    //
+    bool Open(const void* data, size_t size)
+    {
+        _file.Close();
+        return Parse(static_cast<const uint8_t*>(data), size);
+    }
+
+    uint64_t GetRowCount() const { return _rowCount; }
+    const std::vector<Column>& GetColumns() const { return _columns; }
+
+    const Column* FindColumn(std::string_view name) const
+    {
+        for(const Column& column : _columns)
+        {
+            if(column.name == name)
+                return &column;
+        }
+        return nullptr;
+    }
+
+    //
+    //  Resizes objects to count of rows and reads the given fields (all when
+    //  none are given) into them, fields, which are absent in the file, are
+    //  left as is. Returns false if the file is corrupted or types of columns
+    //  don't match types of the fields.
+    //
+    template<uint32_t... fieldIds, class ReflectableClass>
+    bool Read(std::vector<ReflectableClass>& objects) const
+    {
+        objects.resize(_rowCount);
+        if constexpr(sizeof...(fieldIds) == 0)
+            return ReadFields(objects, std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<ReflectableClass>()>());
+        else
+            return ReadFields(objects, std::integer_sequence<uint32_t, fieldIds...>());
+    }
+
+    //
+    //  Reads one column, returns false if it's absent
+    //
+    template<class ReflectableClass, uint32_t fieldId>
+    bool ReadColumn(std::vector<Reflection::FieldType<ReflectableClass, fieldId>>& values) const
+    {
+        const Column* column = FindColumn(Reflection::GetFieldName<ReflectableClass, fieldId>());
+        if(!column)
+            return false;
+
+        values.resize(_rowCount);
+        return DecodeColumn<Reflection::FieldType<ReflectableClass, fieldId>>(*column,
+            [&](size_t row) -> decltype(auto) { return values[row]; });
+    }
+};
+
+};  //  namespace vklib
@@ -0,0 +1,268 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains ReflectableColumnStore, a struct-of-arrays container of
+//  reflectable objects: every field is kept in its own contiguous column, so
+//  scans over one or two fields touch only their columns.
+//  Columns are addressed by field id, e.g.:
+//  ReflectableColumnStore<Record> store;
+//  store.push_back(record);
+//  constexpr uint32_t AMOUNT = Reflection::FindFieldId<Record>("amount");
+//  int64_t total = store.Sum<AMOUNT>();
+//  Record first = store.Get(0);
+//  bool fields are stored as uint8_t, as std::vector<bool> isn't contiguous.
+//
+
+#pragma once
+
+#include "Reflection.h"
+#include "Span.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace vklib
+{
+
+template<class FieldT>
+struct ColumnValue
+{
+    typedef FieldT type;
+};
+
+template<>
+struct ColumnValue<bool>
+{
+    typedef uint8_t type;
+};
+
+//
+//  Sum of integral column is accumulated in 64 bit integer of the same
+//  signedness, sum of floating point one in double
+//
+template<class T>
+struct ColumnSum
+{
+    typedef std::conditional_t<std::is_floating_point<T>::value, double,
+        std::conditional_t<std::is_signed<T>::value, int64_t, uint64_t>> type;
+};
+
+template<class ReflectableClass>
+class ReflectableColumnStore
+{
+public:
+    static constexpr uint32_t COUNT_OF_FIELDS = Reflection::GetFieldCount<ReflectableClass>();
+
+    template<uint32_t fieldId>
+    using ColumnType = typename ColumnValue<Reflection::FieldType<ReflectableClass, fieldId>>::type;
+
+protected:
+    typedef std::make_integer_sequence<uint32_t, COUNT_OF_FIELDS> FieldIndexes;
+
+    template<uint32_t... Index>
+    static std::tuple<std::vector<ColumnType<Index>>...> GetColumns(std::integer_sequence<uint32_t, Index...>);
+
+    decltype(GetColumns(FieldIndexes())) _columns;
+    size_t _size = 0;
+
+    template<uint32_t... Index>
+    void Reserve(size_t size, std::integer_sequence<uint32_t, Index...>)
+    {
+        (std::get<Index>(_columns).reserve(size), ...);
+    }
+
+    template<uint32_t... Index>
+    void Clear(std::integer_sequence<uint32_t, Index...>)
+    {
+        (std::get<Index>(_columns).clear(), ...);
+    }
+
+    template<uint32_t... Index>
+    void PushBack(const ReflectableClass& obj, std::integer_sequence<uint32_t, Index...>)
+    {
+        (std::get<Index>(_columns).push_back(Reflection::GetFieldValue<Index>(obj)), ...);
+    }
+
+    template<uint32_t... Index>
+    void PushBack(ReflectableClass&& obj, std::integer_sequence<uint32_t, Index...>)
+    {
+        (std::get<Index>(_columns).push_back(std::move(Reflection::GetFieldValue<Index>(obj))), ...);
+    }
+
+    template<uint32_t... Index>
+    void Set(size_t index, const ReflectableClass& obj, std::integer_sequence<uint32_t, Index...>)
+    {
+        ((std::get<Index>(_columns)[index] = Reflection::GetFieldValue<Index>(obj)), ...);
+    }
+
+    template<uint32_t... Index>
+    void Get(size_t index, ReflectableClass& obj, std::integer_sequence<uint32_t, Index...>) const
+    {
+        ((Reflection::GetFieldValue<Index>(obj) = std::get<Index>(_columns)[index]), ...);
+    }
+
+public:
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    void reserve(size_t size)
+    {
+        Reserve(size, FieldIndexes());
+    }
+
+    void clear()
+    {
+        Clear(FieldIndexes());
+        _size = 0;
+    }
+
+    void push_back(const ReflectableClass& obj)
+    {
+        PushBack(obj, FieldIndexes());
+        ++_size;
+    }
+
+    void push_back(ReflectableClass&& obj)
+    {
+        PushBack(std::move(obj), FieldIndexes());
+        ++_size;
+    }
+
+    void Set(size_t index, const ReflectableClass& obj)
+    {
+        Set(index, obj, FieldIndexes());
+    }
+
+    //
+    //  Materializes the record. The overload with output object reuses its
+    //  strings and containers.
+    //
+    void Get(size_t index, ReflectableClass& obj) const
+    {
+        Get(index, obj, FieldIndexes());
+    }
+
+    ReflectableClass Get(size_t index) const
+    {
+        ReflectableClass obj;
+        Get(index, obj);
+        return obj;
+    }
+
+    template<uint32_t fieldId>
+    Span<ColumnType<fieldId>> Column()
+    {
+        auto& column = std::get<fieldId>(_columns);
+        return Span<ColumnType<fieldId>>(column.data(), column.size());
+    }
+
+    template<uint32_t fieldId>
+    Span<const ColumnType<fieldId>> Column() const
+    {
+        const auto& column = std::get<fieldId>(_columns);
+        return Span<const ColumnType<fieldId>>(column.data(), column.size());
+    }
+
+    //
+    //  Scans. The loops have no data dependent branches, so compiler can
+    //  vectorize them for arithmetic columns.
+    //
+    template<uint32_t fieldId>
+    typename ColumnSum<ColumnType<fieldId>>::type Sum() const
+    {
+        typedef typename ColumnSum<ColumnType<fieldId>>::type SumT;
+        const Span<const ColumnType<fieldId>> column = Column<fieldId>();
+        const ColumnType<fieldId>* data = column.data();
+        const size_t size = column.size();
+        if constexpr(std::is_floating_point<SumT>::value)
+        {
+            //  Independent partial sums break the dependency chain of additions
+            SumT sums[4] = {};
+            size_t i = 0;
+            for(; i + 4 <= size; i += 4)
+            {
+                sums[0] += data[i];
+                sums[1] += data[i + 1];
+                sums[2] += data[i + 2];
+                sums[3] += data[i + 3];
+            }
+            for(; i < size; ++i)
+                sums[0] += data[i];
+            return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        }
+        else
+        {
+            SumT sum = 0;
+            for(size_t i = 0; i < size; ++i)
+                sum += data[i];
+            return sum;
+        }
+    }
+
+    //
+    //  Returns minimal and maximal values of the column, which shouldn't be empty
+    //
+    template<uint32_t fieldId>
+    std::pair<ColumnType<fieldId>, ColumnType<fieldId>> MinMax() const
+    {
+        const Span<const ColumnType<fieldId>> column = Column<fieldId>();
+        const ColumnType<fieldId>* data = column.data();
+        ColumnType<fieldId> minValue = data[0];
+        ColumnType<fieldId> maxValue = data[0];
+        for(size_t i = 1; i < column.size(); ++i)
+        {
+            minValue = data[i] < minValue ? data[i] : minValue;
+            maxValue = maxValue < data[i] ? data[i] : maxValue;
+        }
+        return std::make_pair(minValue, maxValue);
+    }
+
+    //
+    //  Appends indexes of the records, which field satisfies the predicate,
+    //  to rows and returns their count
+    //
+    template<uint32_t fieldId, class PredicateT>
+    size_t Filter(PredicateT predicate, std::vector<uint32_t>& rows) const
+    {
+        const Span<const ColumnType<fieldId>> column = Column<fieldId>();
+        const ColumnType<fieldId>* data = column.data();
+        const size_t offset = rows.size();
+        rows.resize(offset + column.size());
+        uint32_t* output = rows.data() + offset;
+        size_t count = 0;
+        for(size_t i = 0; i < column.size(); ++i)
+        {
+            output[count] = static_cast<uint32_t>(i);
+            count += predicate(data[i]) ? 1 : 0;
+        }
+        rows.resize(offset + count);
+        return count;
+    }
+};
+
+};  //  namespace vklib
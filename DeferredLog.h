@@ -0,0 +1,579 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains deferred logging of reflectable objects. Logging thread
+//  only captures raw field values into its own lock-free ring buffer:
+//  - trivially copyable values without pointers (including whole trivially
+//    copyable reflectable classes) are copied as is;
+//  - strings, const char* and std::string_view are deep copied and prefixed
+//    by uint32 size, decoded text points into the record;
+//  - other pointers aren't supported, since they can dangle before the
+//    record is formatted;
+//  - std::vector is prefixed by uint32 count;
+//  - other reflectable classes are captured field by field.
+//  Background thread of DeferredLogger decodes the records and formats them
+//  with ToString. Records of the same thread are formatted in order, records
+//  of different threads aren't ordered. When ring buffer is full, records are
+//  dropped and counted, so logging never blocks.
+//  E.g.:
+//  DeferredLogger logger([](std::string_view line) { std::cerr << line << std::endl; });
+//  logger.Log(request);
+//
+
+#pragma once
+
+#include "Reflection.h"
+#include "TextWriter.h"
+#include "ToString.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace vklib
+{
+
+template<class T>
+struct IsCaptureString : std::false_type {};
+
+template<class Traits, class Allocator>
+struct IsCaptureString<std::basic_string<char, Traits, Allocator>> : std::true_type {};
+
+//
+//  Text captured by value, though the field holds only its address
+//
+template<class T>
+struct IsCaptureText : std::integral_constant<bool, std::is_same<T, const char*>::value || std::is_same<T, std::string_view>::value> {};
+
+template<class T>
+struct IsCaptureVector : std::false_type {};
+
+template<class T, class Allocator>
+struct IsCaptureVector<std::vector<T, Allocator>> : std::integral_constant<bool, !std::is_same<T, bool>::value> {};
+
+//
+//  Raw capture of field values
+//
+class DeferredCapture
+{
+protected:
+    //  Size of null const char*
+    static constexpr uint32_t NULL_TEXT_SIZE = UINT32_MAX;
+
+    template<class T>
+    static constexpr bool IsPointerLike()
+    {
+        return std::is_pointer<T>::value || std::is_member_pointer<T>::value || std::is_null_pointer<T>::value || IsCaptureText<T>::value;
+    }
+
+    template<class ReflectableClass, uint32_t... Index>
+    static constexpr bool AreFieldsRaw(std::integer_sequence<uint32_t, Index...>)
+    {
+        return (IsRaw<Reflection::FieldType<ReflectableClass, Index>>() && ...);
+    }
+
+    //
+    //  Values copied as is: trivially copyable and without pointers, which
+    //  could dangle. Reflectable classes with pointer fields are captured
+    //  field by field, so text fields are deep copied.
+    //
+    template<class T>
+    static constexpr bool IsRaw()
+    {
+        if constexpr(!std::is_trivially_copyable<T>::value || IsPointerLike<T>())
+            return false;
+        else if constexpr(Reflection::IsReflectable<T>())
+            return AreFieldsRaw<T>(std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<T>()>());
+        else
+            return true;
+    }
+
+    template<class T>
+    static std::string_view GetText(const T& value)
+    {
+        if constexpr(std::is_same<T, const char*>::value)
+            return value ? std::string_view(value) : std::string_view();
+        else
+            return value;
+    }
+
+    template<class ReflectableClass, uint32_t... Index>
+    static size_t GetFieldsSize(const ReflectableClass& obj, std::integer_sequence<uint32_t, Index...>)
+    {
+        return (size_t(0) + ... + GetSize(Reflection::GetFieldValue<Index>(obj)));
+    }
+
+    template<class ReflectableClass, uint32_t... Index>
+    static uint8_t* WriteFields(uint8_t* output, const ReflectableClass& obj, std::integer_sequence<uint32_t, Index...>)
+    {
+        ((output = Write(output, Reflection::GetFieldValue<Index>(obj))), ...);
+        return output;
+    }
+
+    template<class ReflectableClass, uint32_t... Index>
+    static const uint8_t* ReadFields(const uint8_t* input, ReflectableClass& obj, std::integer_sequence<uint32_t, Index...>)
+    {
+        ((input = Read(input, Reflection::GetFieldValue<Index>(obj))), ...);
+        return input;
+    }
+
+    static inline uint8_t* WriteSize(uint8_t* output, size_t size)
+    {
+        const uint32_t size32 = static_cast<uint32_t>(size);
+        memcpy(output, &size32, sizeof(size32));
+        return output + sizeof(size32);
+    }
+
+    static inline const uint8_t* ReadSize(const uint8_t* input, size_t& size)
+    {
+        uint32_t size32;
+        memcpy(&size32, input, sizeof(size32));
+        size = size32;
+        return input + sizeof(size32);
+    }
+
+public:
+    template<class T>
+    static size_t GetSize(const T& value)
+    {
+        static_assert(!IsPointerLike<T>() || IsCaptureText<T>::value, "Pointers aren't supported by deferred logging, they could dangle before formatting");
+        if constexpr(IsRaw<T>())
+            return sizeof(T);
+        else if constexpr(IsCaptureText<T>::value)
+            //  const char* is null terminated after decoding
+            return sizeof(uint32_t) + GetText(value).size() + 1;
+        else if constexpr(IsCaptureString<T>::value)
+            return sizeof(uint32_t) + value.size();
+        else if constexpr(IsCaptureVector<T>::value)
+        {
+            if constexpr(IsRaw<typename T::value_type>())
+                return sizeof(uint32_t) + value.size() * sizeof(typename T::value_type);
+            else
+            {
+                size_t size = sizeof(uint32_t);
+                for(const auto& item : value)
+                    size += GetSize(item);
+                return size;
+            }
+        }
+        else
+        {
+            static_assert(Reflection::IsReflectable<T>(), "Type isn't supported by deferred logging");
+            return GetFieldsSize(value, std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<T>()>());
+        }
+    }
+
+    template<class T>
+    static uint8_t* Write(uint8_t* output, const T& value)
+    {
+        if constexpr(IsRaw<T>())
+        {
+            memcpy(output, &value, sizeof(T));
+            return output + sizeof(T);
+        }
+        else if constexpr(IsCaptureText<T>::value)
+        {
+            const std::string_view text = GetText(value);
+            if constexpr(std::is_same<T, const char*>::value)
+                output = WriteSize(output, value ? text.size() : NULL_TEXT_SIZE);
+            else
+                output = WriteSize(output, text.size());
+            if(!text.empty())
+                memcpy(output, text.data(), text.size());
+            output[text.size()] = 0;
+            return output + text.size() + 1;
+        }
+        else if constexpr(IsCaptureString<T>::value)
+        {
+            output = WriteSize(output, value.size());
+            memcpy(output, value.data(), value.size());
+            return output + value.size();
+        }
+        else if constexpr(IsCaptureVector<T>::value)
+        {
+            output = WriteSize(output, value.size());
+            if constexpr(IsRaw<typename T::value_type>())
+            {
+                const size_t size = value.size() * sizeof(typename T::value_type);
+                if(size)
+                    memcpy(output, value.data(), size);
+                return output + size;
+            }
+            else
+            {
+                for(const auto& item : value)
+                    output = Write(output, item);
+                return output;
+            }
+        }
+        else
+            return WriteFields(output, value, std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<T>()>());
+    }
+
+    //
+    //  Decodes the value, reusing strings and containers of the target.
+    //  const char* and std::string_view point into the input.
+    //
+    template<class T>
+    static const uint8_t* Read(const uint8_t* input, T& value)
+    {
+        if constexpr(IsRaw<T>())
+        {
+            memcpy(&value, input, sizeof(T));
+            return input + sizeof(T);
+        }
+        else if constexpr(IsCaptureText<T>::value)
+        {
+            size_t size = 0;
+            input = ReadSize(input, size);
+            const char* text = reinterpret_cast<const char*>(input);
+            if(size == NULL_TEXT_SIZE)
+            {
+                value = T();
+                size = 0;
+            }
+            else if constexpr(std::is_same<T, const char*>::value)
+                value = text;
+            else
+                value = T(text, size);
+            return input + size + 1;
+        }
+        else if constexpr(IsCaptureString<T>::value)
+        {
+            size_t size = 0;
+            input = ReadSize(input, size);
+            value.assign(reinterpret_cast<const char*>(input), size);
+            return input + size;
+        }
+        else if constexpr(IsCaptureVector<T>::value)
+        {
+            size_t size = 0;
+            input = ReadSize(input, size);
+            value.resize(size);
+            if constexpr(IsRaw<typename T::value_type>())
+            {
+                if(size)
+                    memcpy(value.data(), input, size * sizeof(typename T::value_type));
+                return input + size * sizeof(typename T::value_type);
+            }
+            else
+            {
+                for(auto& item : value)
+                    input = Read(input, item);
+                return input;
+            }
+        }
+        else
+            return ReadFields(input, value, std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<T>()>());
+    }
+};
+
+//
+//  Single producer single consumer ring of records. Records are contiguous
+//  and aligned to 8 bytes, a record, which doesn't fit before the end of the
+//  ring, is preceded by a wrap marker and written from the beginning.
+//
+class DeferredLogRing
+{
+public:
+    typedef void (*FormatFunction)(const uint8_t* payload, TextBuffer<>& text);
+
+    struct RecordHeader
+    {
+        //  Size of the record including header, 0 is wrap marker
+        uint32_t size;
+        uint32_t reserved;
+        FormatFunction format;
+    };
+
+    static constexpr size_t ALIGNMENT = 8;
+
+protected:
+    std::unique_ptr<uint8_t[]> _data;
+    const size_t _capacity;
+
+    alignas(64) std::atomic<uint64_t> _writePosition { 0 };
+    uint64_t _cachedReadPosition = 0;
+    uint64_t _reservedPosition = 0;
+    std::atomic<uint64_t> _droppedCount { 0 };
+
+    alignas(64) std::atomic<uint64_t> _readPosition { 0 };
+
+    static inline size_t Align(size_t size)
+    {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+public:
+    //
+    //  Memory of the ring is zeroed, so logging doesn't cause page faults
+    //
+    explicit DeferredLogRing(size_t capacity)
+        : _data(new uint8_t[Align(capacity)]()), _capacity(Align(capacity))
+    {
+    }
+
+    //
+    //  Producer: returns place for the record of the given size (including
+    //  header) or nullptr if the ring is full
+    //
+    uint8_t* Reserve(size_t size)
+    {
+        size = Align(size);
+        uint64_t position = _writePosition.load(std::memory_order_relaxed);
+        const size_t offset = position % _capacity;
+        const size_t tail = _capacity - offset;
+        const size_t required = size + (tail < size ? tail : 0);
+        if(size > _capacity || position + required - _cachedReadPosition > _capacity)
+        {
+            _cachedReadPosition = _readPosition.load(std::memory_order_acquire);
+            if(size > _capacity || position + required - _cachedReadPosition > _capacity)
+            {
+                _droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+
+        if(tail < size)
+        {
+            RecordHeader marker = {};
+            memcpy(_data.get() + offset, &marker, sizeof(marker.size));
+            position += tail;
+        }
+        _reservedPosition = position;
+        return _data.get() + position % _capacity;
+    }
+
+    //
+    //  Producer: publishes the reserved record
+    //
+    void Commit(size_t size)
+    {
+        _writePosition.store(_reservedPosition + Align(size), std::memory_order_release);
+    }
+
+    //
+    //  Consumer: calls function for every published record, returns their count
+    //
+    template<class FunctionT>
+    size_t Consume(FunctionT&& function)
+    {
+        uint64_t position = _readPosition.load(std::memory_order_relaxed);
+        const uint64_t end = _writePosition.load(std::memory_order_acquire);
+        size_t count = 0;
+        while(position < end)
+        {
+            const size_t offset = position % _capacity;
+            RecordHeader header;
+            memcpy(&header.size, _data.get() + offset, sizeof(header.size));
+            if(header.size == 0)
+            {
+                position += _capacity - offset;
+                continue;
+            }
+
+            memcpy(&header, _data.get() + offset, sizeof(header));
+            function(header, _data.get() + offset + sizeof(header));
+            position += Align(header.size);
+            _readPosition.store(position, std::memory_order_release);
+            ++count;
+        }
+        _readPosition.store(position, std::memory_order_release);
+        return count;
+    }
+
+    uint64_t GetDroppedCount() const { return _droppedCount.load(std::memory_order_relaxed); }
+};
+
+//
+//  Owns ring buffers of the logging threads and the background thread, which
+//  formats their records and passes the lines to the sink. Ring buffers of
+//  finished threads are kept until the logger is destroyed.
+//
+class DeferredLogger
+{
+public:
+    typedef std::function<void(std::string_view line)> SinkT;
+
+protected:
+    typedef DeferredLogRing::RecordHeader RecordHeader;
+
+    struct ThreadRing
+    {
+        uint64_t loggerId;
+        DeferredLogRing* ring;
+    };
+
+    static inline std::atomic<uint64_t> _lastLoggerId { 0 };
+
+    const uint64_t _id = ++_lastLoggerId;
+    const size_t _ringCapacity;
+    SinkT _sink;
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::vector<std::unique_ptr<DeferredLogRing>> _rings;
+    uint64_t _flushRequestCount = 0;
+    uint64_t _flushedCount = 0;
+    bool _stop = false;
+    std::thread _thread;
+
+    template<class T>
+    static void Format(const uint8_t* payload, TextBuffer<>& text)
+    {
+        thread_local T obj;
+        DeferredCapture::Read(payload, obj);
+        ToString(text, obj);
+    }
+
+    DeferredLogRing& GetRing()
+    {
+        thread_local std::vector<ThreadRing> threadRings;
+        for(const ThreadRing& threadRing : threadRings)
+        {
+            if(threadRing.loggerId == _id)
+                return *threadRing.ring;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _rings.emplace_back(new DeferredLogRing(_ringCapacity));
+        threadRings.push_back({ _id, _rings.back().get() });
+        return *_rings.back();
+    }
+
+    void Run()
+    {
+        TextBuffer<> text;
+        std::vector<DeferredLogRing*> rings;
+        std::unique_lock<std::mutex> lock(_mutex);
+        for(;;)
+        {
+            const uint64_t flushRequestCount = _flushRequestCount;
+            const bool stop = _stop;
+            rings.clear();
+            for(const auto& ring : _rings)
+                rings.push_back(ring.get());
+            lock.unlock();
+
+            size_t count = 0;
+            for(DeferredLogRing* ring : rings)
+            {
+                count += ring->Consume([&](const RecordHeader& header, const uint8_t* payload)
+                {
+                    text.Clear();
+                    header.format(payload, text);
+                    _sink(text.View());
+                });
+            }
+
+            lock.lock();
+            _flushedCount = flushRequestCount;
+            _condition.notify_all();
+            if(stop)
+                return;
+
+            if(count == 0)
+                _condition.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+
+public:
+    explicit DeferredLogger(SinkT sink, size_t ringCapacity = 1 << 20)
+        : _ringCapacity(ringCapacity), _sink(std::move(sink))
+    {
+        _thread = std::thread([this]() { Run(); });
+    }
+
+    DeferredLogger(const DeferredLogger&) = delete;
+    DeferredLogger& operator=(const DeferredLogger&) = delete;
+
+    //
+    //  Formats all records logged before the call
+    //
+    ~DeferredLogger()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _condition.notify_all();
+        _thread.join();
+    }
+
+    //
+    //  Captures the object. Returns false if ring buffer of the thread is full
+    //  and the record was dropped.
+    //
+    template<class ReflectableClass>
+    bool Log(const ReflectableClass& obj)
+    {
+        static_assert(Reflection::IsReflectable<ReflectableClass>(), "Class should be reflectable");
+        static_assert(std::is_default_constructible<ReflectableClass>::value, "Class should be default constructible");
+
+        const size_t size = sizeof(RecordHeader) + DeferredCapture::GetSize(obj);
+        DeferredLogRing& ring = GetRing();
+        uint8_t* record = ring.Reserve(size);
+        if(!record)
+            return false;
+
+        const RecordHeader header = { static_cast<uint32_t>(size), 0, &Format<ReflectableClass> };
+        memcpy(record, &header, sizeof(header));
+        DeferredCapture::Write(record + sizeof(header), obj);
+        ring.Commit(size);
+        return true;
+    }
+
+    //
+    //  Waits until all records logged before the call are passed to the sink
+    //
+    void Flush()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        const uint64_t flushRequestCount = ++_flushRequestCount;
+        _condition.notify_all();
+        _condition.wait(lock, [&]() { return _flushedCount >= flushRequestCount; });
+    }
+
+    uint64_t GetDroppedCount()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        uint64_t count = 0;
+        for(const auto& ring : _rings)
+            count += ring->GetDroppedCount();
+        return count;
+    }
+};
+
+};  //  namespace vklib
@@ -0,0 +1,366 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains field level diff and patch of reflectable classes.
+//  Delta is a sequence of changed fields terminated by 0. Every field starts
+//  with LEB128 tag ((fieldId + 1) << 1 | nested):
+//  - changed nested reflectable classes (nested == 1) are followed by their
+//    own delta;
+//  - other changed fields (nested == 0) are followed by the new value in
+//    binary format (see Serialization.h).
+//  E.g.:
+//  std::string delta;
+//  if(Diff(delta, previousState, state))
+//      Send(delta);
+//  ...
+//  bool ok = Apply(replicaState, delta);
+//  Tracked<T> keeps a dirty bit per field, which are set by field accessors,
+//  so its delta is built in O(changed fields) without comparison.
+//
+
+#pragma once
+
+#include "Reflection.h"
+#include "Serialization.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+namespace vklib
+{
+
+//
+//  Set of field ids of reflectable class
+//
+template<class ReflectableClass>
+class DirtyFields
+{
+public:
+    static constexpr uint32_t COUNT_OF_FIELDS = Reflection::GetFieldCount<ReflectableClass>();
+
+protected:
+    static constexpr uint32_t COUNT_OF_WORDS = (COUNT_OF_FIELDS + 63) / 64;
+
+    uint64_t _words[COUNT_OF_WORDS > 0 ? COUNT_OF_WORDS : 1] = {};
+
+public:
+    void Set(uint32_t fieldId) { _words[fieldId / 64] |= uint64_t(1) << (fieldId % 64); }
+    void Reset(uint32_t fieldId) { _words[fieldId / 64] &= ~(uint64_t(1) << (fieldId % 64)); }
+    bool Test(uint32_t fieldId) const { return (_words[fieldId / 64] >> (fieldId % 64)) & 1; }
+
+    void SetAll()
+    {
+        for(uint32_t fieldId = 0; fieldId < COUNT_OF_FIELDS; ++fieldId)
+            Set(fieldId);
+    }
+
+    void Clear()
+    {
+        for(uint64_t& word : _words)
+            word = 0;
+    }
+
+    bool Any() const
+    {
+        for(uint64_t word : _words)
+        {
+            if(word)
+                return true;
+        }
+        return false;
+    }
+
+    //
+    //  Calls function for every field id in the set in increasing order
+    //
+    template<class FunctionT>
+    void ForEach(FunctionT&& function) const
+    {
+        for(uint32_t i = 0; i < COUNT_OF_WORDS; ++i)
+        {
+            for(uint64_t word = _words[i]; word; word &= word - 1)
+                function(i * 64 + static_cast<uint32_t>(__builtin_ctzll(word)));
+        }
+    }
+};
+
+//
+//  Reflectable object with dirty bit per field. Fields changed through
+//  Mutable or Set are written by Diff(delta, tracked).
+//
+template<class ReflectableClass>
+class Tracked
+{
+protected:
+    ReflectableClass _value;
+    DirtyFields<ReflectableClass> _dirty;
+
+public:
+    Tracked() = default;
+    explicit Tracked(ReflectableClass value) : _value(std::move(value)) {}
+
+    const ReflectableClass& Get() const { return _value; }
+
+    template<uint32_t fieldId>
+    const auto& Get() const
+    {
+        return Reflection::GetFieldValue<fieldId>(_value);
+    }
+
+    template<uint32_t fieldId>
+    auto& Mutable()
+    {
+        _dirty.Set(fieldId);
+        return Reflection::GetFieldValue<fieldId>(_value);
+    }
+
+    template<uint32_t fieldId, class FieldT>
+    void Set(FieldT&& value)
+    {
+        Mutable<fieldId>() = std::forward<FieldT>(value);
+    }
+
+    //
+    //  Direct access to the whole object marks all fields dirty
+    //
+    ReflectableClass& MutableAll()
+    {
+        _dirty.SetAll();
+        return _value;
+    }
+
+    const DirtyFields<ReflectableClass>& GetDirty() const { return _dirty; }
+    void ClearDirty() { _dirty.Clear(); }
+};
+
+template<class BufferT>
+class DiffWriter : public BinarySerializer<BufferT>
+{
+protected:
+    typedef BinarySerializer<BufferT> Base;
+
+    using Base::_buffer;
+    using Base::WriteSize;
+
+    void WriteTag(uint32_t fieldId, bool nested)
+    {
+        WriteSize(((uint64_t(fieldId) + 1) << 1) | (nested ? 1 : 0));
+    }
+
+    template<class T>
+    bool WriteFieldDiff(uint32_t fieldId, const T& from, const T& to)
+    {
+        if constexpr(Reflection::IsReflectable<T>())
+        {
+            const size_t position = _buffer.size();
+            WriteTag(fieldId, true);
+            if(WriteDiff(from, to))
+                return true;
+
+            _buffer.resize(position);
+            return false;
+        }
+        else
+        {
+            if(Reflection::EqualValues(from, to))
+                return false;
+
+            WriteTag(fieldId, false);
+            this->Visit(to);
+            return true;
+        }
+    }
+
+    template<class ReflectableClass, uint32_t... Index>
+    bool WriteFieldsDiff(const ReflectableClass& from, const ReflectableClass& to, std::integer_sequence<uint32_t, Index...>)
+    {
+        //  Comma fold keeps the order of fields in the buffer
+        bool changed = false;
+        ((changed |= WriteFieldDiff(Index, Reflection::GetFieldValue<Index>(from), Reflection::GetFieldValue<Index>(to))), ...);
+        return changed;
+    }
+
+    template<class T>
+    void WriteField(uint32_t fieldId, const T& value)
+    {
+        WriteTag(fieldId, Reflection::IsReflectable<T>());
+        if constexpr(Reflection::IsReflectable<T>())
+            WriteAll(value);
+        else
+            this->Visit(value);
+    }
+
+    template<class ReflectableClass, uint32_t... Index>
+    void WriteFields(const ReflectableClass& obj, std::integer_sequence<uint32_t, Index...>)
+    {
+        (WriteField(Index, Reflection::GetFieldValue<Index>(obj)), ...);
+    }
+
+    class FieldWriter
+    {
+        DiffWriter& _writer;
+
+    public:
+        uint32_t fieldId = 0;
+
+        FieldWriter(DiffWriter& writer) : _writer(writer) {}
+
+        template<class T>
+        bool VisitField(const char* /*fieldName*/, const T& value)
+        {
+            _writer.WriteField(fieldId, value);
+            return true;
+        }
+    };
+
+public:
+    DiffWriter(BufferT& buffer) : Base(buffer) {}
+
+    //
+    //  Writes delta, which turns from into to. Returns false if they are equal.
+    //
+    template<class ReflectableClass>
+    bool WriteDiff(const ReflectableClass& from, const ReflectableClass& to)
+    {
+        const bool changed = WriteFieldsDiff(from, to,
+            std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<ReflectableClass>()>());
+        WriteSize(0);
+        return changed;
+    }
+
+    //
+    //  Writes delta with all fields
+    //
+    template<class ReflectableClass>
+    void WriteAll(const ReflectableClass& obj)
+    {
+        WriteFields(obj, std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<ReflectableClass>()>());
+        WriteSize(0);
+    }
+
+    //
+    //  Writes delta with the given fields
+    //
+    template<class ReflectableClass>
+    void WriteFields(const ReflectableClass& obj, const DirtyFields<ReflectableClass>& fields)
+    {
+        FieldWriter writer(*this);
+        fields.ForEach([&](uint32_t fieldId)
+        {
+            writer.fieldId = fieldId;
+            Reflection::VisitFieldById(obj, fieldId, writer);
+        });
+        WriteSize(0);
+    }
+};
+
+class DiffApplier : public BinaryDeserializer<>
+{
+protected:
+    class FieldApplier
+    {
+        DiffApplier& _applier;
+        const bool _nested;
+
+    public:
+        FieldApplier(DiffApplier& applier, bool nested) : _applier(applier), _nested(nested) {}
+
+        template<class T>
+        bool VisitField(const char* /*fieldName*/, T& value)
+        {
+            if constexpr(Reflection::IsReflectable<T>())
+                return _nested && _applier.Apply(value);
+            else
+                return !_nested && _applier.Visit(value);
+        }
+    };
+
+public:
+    DiffApplier(const void* data, size_t size) : BinaryDeserializer(data, size) {}
+
+    template<class ReflectableClass>
+    bool Apply(ReflectableClass& obj)
+    {
+        for(;;)
+        {
+            uint64_t tag = 0;
+            if(!ReadSize(tag))
+                return false;
+
+            if(tag == 0)
+                return true;
+
+            const uint64_t fieldId = (tag >> 1) - 1;
+            if(fieldId >= Reflection::GetFieldCount<ReflectableClass>())
+                return false;
+
+            FieldApplier applier(*this, tag & 1);
+            if(!Reflection::VisitFieldById(obj, static_cast<uint32_t>(fieldId), applier))
+                return false;
+        }
+    }
+};
+
+//
+//  Appends delta, which turns from into to, to the buffer. Returns false if
+//  objects are equal.
+//
+template<class BufferT, class ReflectableClass>
+bool Diff(BufferT& delta, const ReflectableClass& from, const ReflectableClass& to)
+{
+    return DiffWriter<BufferT>(delta).WriteDiff(from, to);
+}
+
+//
+//  Appends delta with dirty fields of the object and clears them. Returns
+//  false if there were no dirty fields.
+//
+template<class BufferT, class ReflectableClass>
+bool Diff(BufferT& delta, Tracked<ReflectableClass>& obj)
+{
+    const bool changed = obj.GetDirty().Any();
+    DiffWriter<BufferT>(delta).WriteFields(obj.Get(), obj.GetDirty());
+    obj.ClearDirty();
+    return changed;
+}
+
+//
+//  Returns false if delta is truncated, corrupted, has trailing bytes or
+//  doesn't match the class. In case of failure object can be partially updated.
+//
+template<class ReflectableClass>
+bool Apply(ReflectableClass& obj, const void* delta, size_t size)
+{
+    DiffApplier applier(delta, size);
+    return applier.Apply(obj) && applier.Remaining() == 0;
+}
+
+template<class ReflectableClass, class BufferT>
+bool Apply(ReflectableClass& obj, const BufferT& delta)
+{
+    return Apply(obj, delta.data(), delta.size());
+}
+
+};  //  namespace vklib
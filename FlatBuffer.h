@@ -0,0 +1,483 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains flat binary layout of reflectable classes, which fields
+//  can be read in place without decoding of the whole object.
+//  Object is written as:
+//  - uint32 size of the object in bytes;
+//  - uint32 offset of every field from the beginning of the object;
+//  - the fields in declaration order.
+//  Fields are written as:
+//  - arithmetic types and enums as is, aligned to their alignment;
+//  - strings as uint32 size followed by characters;
+//  - std::vector and std::array of arithmetic types as uint32 count followed
+//    by elements, aligned to their alignment;
+//  - nested reflectable classes as nested objects, aligned to 8 bytes;
+//  - std::vector of strings or reflectable classes as uint32 count, uint32
+//    offset of every element from the beginning of the field and elements.
+//  Numbers are written in host byte order. Data given to FlatView has to be
+//  aligned to 8 bytes (heap allocations and mapped files are).
+//  E.g.:
+//  std::string buffer;
+//  FlatSerialize(buffer, message);
+//  FlatView<Message> view(buffer.data(), buffer.size());
+//  if(view.IsValid())
+//      std::string_view name = view.Get<Reflection::FindFieldId<Message>("name")>();
+//
+
+#pragma once
+
+#include "Reflection.h"
+#include "Span.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace vklib
+{
+
+template<class T>
+struct IsFlatScalar : std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_enum<T>::value> {};
+
+template<class T>
+struct IsFlatString : std::false_type {};
+
+template<class Traits, class Allocator>
+struct IsFlatString<std::basic_string<char, Traits, Allocator>> : std::true_type {};
+
+template<class T>
+struct IsFlatArray : std::false_type {};
+
+template<class T, class Allocator>
+struct IsFlatArray<std::vector<T, Allocator>> : std::integral_constant<bool, IsFlatScalar<T>::value && !std::is_same<T, bool>::value> {};
+
+template<class T, size_t N>
+struct IsFlatArray<std::array<T, N>> : IsFlatScalar<T> {};
+
+template<class T>
+struct IsFlatList : std::false_type {};
+
+template<class T, class Allocator>
+struct IsFlatList<std::vector<T, Allocator>> : std::integral_constant<bool, IsFlatString<T>::value || Reflection::IsReflectable<T>()> {};
+
+template<class ReflectableClass>
+class FlatView;
+
+template<class ItemT>
+class FlatListView;
+
+//
+//  Type returned by FlatView::Get for the field of type T
+//
+template<class T, class = void>
+struct FlatValue
+{
+    static_assert(IsFlatScalar<T>::value, "Type isn't supported by flat layout");
+    typedef T type;
+};
+
+template<class T>
+struct FlatValue<T, std::enable_if_t<IsFlatString<T>::value>>
+{
+    typedef std::string_view type;
+};
+
+template<class T>
+struct FlatValue<T, std::enable_if_t<IsFlatArray<T>::value>>
+{
+    typedef Span<const typename T::value_type> type;
+};
+
+template<class T>
+struct FlatValue<T, std::enable_if_t<IsFlatList<T>::value>>
+{
+    typedef FlatListView<typename T::value_type> type;
+};
+
+template<class T>
+struct FlatValue<T, std::enable_if_t<Reflection::IsReflectable<T>()>>
+{
+    typedef FlatView<T> type;
+};
+
+class FlatLayout
+{
+public:
+    static constexpr size_t OBJECT_ALIGNMENT = 8;
+
+    static inline size_t Align(size_t offset, size_t alignment)
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    static inline uint32_t ReadUInt32(const uint8_t* data)
+    {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    //
+    //  First element of flat array, which count is at data
+    //
+    template<class ItemT>
+    static inline const uint8_t* GetArrayItems(const uint8_t* data)
+    {
+        return reinterpret_cast<const uint8_t*>(Align(reinterpret_cast<uintptr_t>(data) + sizeof(uint32_t), alignof(ItemT)));
+    }
+
+    template<class T>
+    static inline size_t GetAlignment()
+    {
+        if constexpr(IsFlatScalar<T>::value)
+            return alignof(T);
+        else if constexpr(Reflection::IsReflectable<T>())
+            return OBJECT_ALIGNMENT;
+        else
+            return alignof(uint32_t);
+    }
+
+    template<class T>
+    static typename FlatValue<T>::type Read(const uint8_t* data)
+    {
+        if constexpr(IsFlatScalar<T>::value)
+        {
+            T value;
+            memcpy(&value, data, sizeof(T));
+            return value;
+        }
+        else if constexpr(IsFlatString<T>::value)
+            return std::string_view(reinterpret_cast<const char*>(data + sizeof(uint32_t)), ReadUInt32(data));
+        else if constexpr(IsFlatArray<T>::value)
+        {
+            typedef typename T::value_type ItemT;
+            return Span<const ItemT>(reinterpret_cast<const ItemT*>(GetArrayItems<ItemT>(data)), ReadUInt32(data));
+        }
+        else if constexpr(IsFlatList<T>::value)
+            return FlatListView<typename T::value_type>(data);
+        else
+            return FlatView<T>(data, ReadUInt32(data));
+    }
+
+    //
+    //  Checks that the value at offset of the object lies within the object
+    //
+    template<class T>
+    static bool IsValid(const uint8_t* data, size_t offset, size_t size)
+    {
+        if(offset > size || (reinterpret_cast<uintptr_t>(data + offset) & (GetAlignment<T>() - 1)) != 0)
+            return false;
+
+        const uint8_t* value = data + offset;
+        const size_t remaining = size - offset;
+        if constexpr(IsFlatScalar<T>::value)
+            return remaining >= sizeof(T);
+        else if constexpr(Reflection::IsReflectable<T>())
+            return FlatView<T>(value, remaining).IsValid();
+        else
+        {
+            if(remaining < sizeof(uint32_t))
+                return false;
+
+            const uint64_t count = ReadUInt32(value);
+            if constexpr(IsFlatString<T>::value)
+                return count <= remaining - sizeof(uint32_t);
+            else if constexpr(IsFlatArray<T>::value)
+            {
+                typedef typename T::value_type ItemT;
+                const size_t itemsOffset = GetArrayItems<ItemT>(value) - value;
+                return itemsOffset <= remaining && count * sizeof(ItemT) <= remaining - itemsOffset;
+            }
+            else
+            {
+                static_assert(IsFlatList<T>::value, "Type isn't supported by flat layout");
+                if(count > (remaining - sizeof(uint32_t)) / sizeof(uint32_t))
+                    return false;
+
+                for(size_t i = 0; i < count; ++i)
+                {
+                    const size_t itemOffset = ReadUInt32(value + sizeof(uint32_t) * (i + 1));
+                    if(!IsValid<typename T::value_type>(value, itemOffset, remaining))
+                        return false;
+                }
+                return true;
+            }
+        }
+    }
+};
+
+template<class BufferT>
+class FlatSerializer
+{
+protected:
+    static_assert(sizeof(typename BufferT::value_type) == 1, "Buffer should be a container of bytes");
+
+    typedef typename BufferT::value_type ByteT;
+
+    BufferT& _buffer;
+
+    void Write(const void* data, size_t size)
+    {
+        const ByteT* bytes = static_cast<const ByteT*>(data);
+        _buffer.insert(_buffer.end(), bytes, bytes + size);
+    }
+
+    void WriteUInt32(size_t value)
+    {
+        const uint32_t value32 = static_cast<uint32_t>(value);
+        Write(&value32, sizeof(value32));
+    }
+
+    void Patch(size_t position, size_t value)
+    {
+        const uint32_t value32 = static_cast<uint32_t>(value);
+        memcpy(&_buffer[position], &value32, sizeof(value32));
+    }
+
+    void Pad(size_t begin, size_t alignment)
+    {
+        _buffer.resize(begin + FlatLayout::Align(_buffer.size() - begin, alignment), ByteT(0));
+    }
+
+    template<class T>
+    void WriteValue(const T& value, size_t begin)
+    {
+        Pad(begin, FlatLayout::GetAlignment<T>());
+        if constexpr(IsFlatScalar<T>::value)
+            Write(&value, sizeof(T));
+        else if constexpr(IsFlatString<T>::value)
+        {
+            WriteUInt32(value.size());
+            Write(value.data(), value.size());
+        }
+        else if constexpr(IsFlatArray<T>::value)
+        {
+            typedef typename T::value_type ItemT;
+            WriteUInt32(value.size());
+            Pad(begin, alignof(ItemT));
+            Write(value.data(), value.size() * sizeof(ItemT));
+        }
+        else if constexpr(IsFlatList<T>::value)
+        {
+            const size_t listBegin = _buffer.size();
+            WriteUInt32(value.size());
+            const size_t offsetsBegin = _buffer.size();
+            _buffer.resize(offsetsBegin + value.size() * sizeof(uint32_t), ByteT(0));
+            for(size_t i = 0; i < value.size(); ++i)
+            {
+                Pad(begin, FlatLayout::GetAlignment<typename T::value_type>());
+                Patch(offsetsBegin + i * sizeof(uint32_t), _buffer.size() - listBegin);
+                WriteValue(value[i], begin);
+            }
+        }
+        else if constexpr(Reflection::IsReflectable<T>())
+            WriteObject(value);
+        else
+            static_assert(IsFlatScalar<T>::value, "Type isn't supported by flat layout");
+    }
+
+    template<class ReflectableClass, uint32_t... Index>
+    void WriteFields(const ReflectableClass& obj, size_t begin, std::integer_sequence<uint32_t, Index...>)
+    {
+        ((Patch(begin + sizeof(uint32_t) * (Index + 1), FlatLayout::Align(_buffer.size() - begin,
+            FlatLayout::GetAlignment<Reflection::FieldType<ReflectableClass, Index>>())),
+            WriteValue(Reflection::GetFieldValue<Index>(obj), begin)), ...);
+    }
+
+public:
+    FlatSerializer(BufferT& buffer) : _buffer(buffer) {}
+
+    //
+    //  Writes the object at the next offset of the buffer aligned to 8 bytes
+    //
+    template<class ReflectableClass>
+    void WriteObject(const ReflectableClass& obj)
+    {
+        _buffer.resize(FlatLayout::Align(_buffer.size(), FlatLayout::OBJECT_ALIGNMENT), ByteT(0));
+        const size_t begin = _buffer.size();
+        constexpr uint32_t count = Reflection::GetFieldCount<ReflectableClass>();
+        _buffer.resize(begin + sizeof(uint32_t) * (count + 1), ByteT(0));
+        WriteFields(obj, begin, std::make_integer_sequence<uint32_t, count>());
+        Patch(begin, _buffer.size() - begin);
+    }
+};
+
+//
+//  Read only view of flat object. Get doesn't check the data, so untrusted
+//  data should be checked with IsValid first.
+//
+template<class ReflectableClass>
+class FlatView
+{
+protected:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+
+    template<uint32_t... Index>
+    bool IsValidFields(std::integer_sequence<uint32_t, Index...>) const
+    {
+        return (FlatLayout::IsValid<Reflection::FieldType<ReflectableClass, Index>>(_data, GetFieldOffset(Index), _size) && ...);
+    }
+
+    inline size_t GetFieldOffset(uint32_t fieldId) const
+    {
+        return FlatLayout::ReadUInt32(_data + sizeof(uint32_t) * (fieldId + 1));
+    }
+
+public:
+    static constexpr uint32_t COUNT_OF_FIELDS = Reflection::GetFieldCount<ReflectableClass>();
+    static constexpr size_t HEADER_SIZE = sizeof(uint32_t) * (COUNT_OF_FIELDS + 1);
+
+    FlatView() = default;
+
+    //
+    //  Size can exceed the size of the object, e.g. for the view of the first
+    //  object in a file
+    //
+    FlatView(const void* data, size_t size) : _data(static_cast<const uint8_t*>(data)), _size(size)
+    {
+        if(_size >= HEADER_SIZE)
+            _size = std::min<size_t>(_size, FlatLayout::ReadUInt32(_data));
+    }
+
+    bool IsValid() const
+    {
+        return _size >= HEADER_SIZE && FlatLayout::ReadUInt32(_data) == _size
+            && (reinterpret_cast<uintptr_t>(_data) & (FlatLayout::OBJECT_ALIGNMENT - 1)) == 0
+            && IsValidFields(std::make_integer_sequence<uint32_t, COUNT_OF_FIELDS>());
+    }
+
+    //
+    //  Object bytes, e.g. for forwarding them as is
+    //
+    const uint8_t* Data() const { return _data; }
+    size_t Size() const { return _size; }
+
+    template<uint32_t fieldId>
+    typename FlatValue<Reflection::FieldType<ReflectableClass, fieldId>>::type Get() const
+    {
+        static_assert(fieldId < COUNT_OF_FIELDS, "There is no field with such id");
+        return FlatLayout::Read<Reflection::FieldType<ReflectableClass, fieldId>>(_data + GetFieldOffset(fieldId));
+    }
+};
+
+//
+//  View of flat std::vector of strings or reflectable classes
+//
+template<class ItemT>
+class FlatListView
+{
+protected:
+    const uint8_t* _data = nullptr;
+
+public:
+    FlatListView() = default;
+    explicit FlatListView(const uint8_t* data) : _data(data) {}
+
+    size_t size() const { return FlatLayout::ReadUInt32(_data); }
+    bool empty() const { return size() == 0; }
+
+    typename FlatValue<ItemT>::type operator[](size_t index) const
+    {
+        const size_t offset = FlatLayout::ReadUInt32(_data + sizeof(uint32_t) * (index + 1));
+        return FlatLayout::Read<ItemT>(_data + offset);
+    }
+};
+
+//
+//  Read only memory mapped file
+//
+class MappedFile
+{
+protected:
+    void* _data = nullptr;
+    size_t _size = 0;
+
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const char* path)
+    {
+        Open(path);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        Close();
+    }
+
+    bool Open(const char* path)
+    {
+        Close();
+        const int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if(fd < 0)
+            return false;
+
+        struct stat status;
+        if(fstat(fd, &status) == 0 && status.st_size > 0)
+        {
+            void* data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(data != MAP_FAILED)
+            {
+                _data = data;
+                _size = status.st_size;
+            }
+        }
+        close(fd);
+        return _data != nullptr;
+    }
+
+    void Close()
+    {
+        if(_data)
+            munmap(_data, _size);
+        _data = nullptr;
+        _size = 0;
+    }
+
+    bool IsOpen() const { return _data != nullptr; }
+    const uint8_t* Data() const { return static_cast<const uint8_t*>(_data); }
+    size_t Size() const { return _size; }
+};
+
+template<class BufferT, class ReflectableClass>
+void FlatSerialize(BufferT& buffer, const ReflectableClass& obj)
+{
+    static_assert(Reflection::IsReflectable<ReflectableClass>(), "Class should be reflectable");
+    FlatSerializer<BufferT>(buffer).WriteObject(obj);
+}
+
+};  //  namespace vklib
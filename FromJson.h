@@ -0,0 +1,695 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains implementation of FromJson function, which reads JSON
+//  produced by ToJson (see ToJson.h) back into objects. It's a single-pass
+//  parser without intermediate DOM: object keys are dispatched directly to
+//  the fields of reflectable class (see Reflection::FindFieldId), unknown keys
+//  are skipped, missing fields keep their values. Maps are read either from
+//  arrays of [key,value] pairs (ToJson output) or from JSON objects.
+//  Object is updated in place, so decoding into recycled object reuses
+//  capacity of its strings and containers:
+//  while(ReadMessage(text))
+//      FromJson(text, obj);
+//
+
+#pragma once
+
+#include "Reflection.h"
+#include <math.h>
+#include <array>
+#include <charconv>
+#include <deque>
+#include <forward_list>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace vklib
+{
+
+class JsonReader
+{
+protected:
+    const char* _position;
+    const char* _end;
+
+    class FieldReader
+    {
+        JsonReader& _reader;
+
+    public:
+        FieldReader(JsonReader& reader) : _reader(reader) {}
+
+        template<class T>
+        bool VisitField(const char* /*fieldName*/, T& value)
+        {
+            return _reader.Visit(value);
+        }
+    };
+
+    void SkipWhitespace()
+    {
+        while(_position != _end && (*_position == ' ' || *_position == '\n' || *_position == '\r' || *_position == '\t'))
+            ++_position;
+    }
+
+    //
+    //  Skips whitespace and consumes the character if it's the next one
+    //
+    bool Consume(char c)
+    {
+        SkipWhitespace();
+        if(_position == _end || *_position != c)
+            return false;
+
+        ++_position;
+        return true;
+    }
+
+    bool ConsumeLiteral(std::string_view literal)
+    {
+        SkipWhitespace();
+        if(static_cast<size_t>(_end - _position) < literal.size() || std::string_view(_position, literal.size()) != literal)
+            return false;
+
+        _position += literal.size();
+        return true;
+    }
+
+    static bool ReadHex(const char* text, uint32_t& value)
+    {
+        value = 0;
+        for(int i = 0; i < 4; ++i)
+        {
+            const char c = text[i];
+            value <<= 4;
+            if(c >= '0' && c <= '9')
+                value |= c - '0';
+            else if(c >= 'a' && c <= 'f')
+                value |= c - 'a' + 10;
+            else if(c >= 'A' && c <= 'F')
+                value |= c - 'A' + 10;
+            else
+                return false;
+        }
+        return true;
+    }
+
+    template<class StringT>
+    static void AppendUtf8(StringT& value, uint32_t codePoint)
+    {
+        if(codePoint < 0x80)
+            value += static_cast<char>(codePoint);
+        else if(codePoint < 0x800)
+        {
+            value += static_cast<char>(0xC0 | (codePoint >> 6));
+            value += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if(codePoint < 0x10000)
+        {
+            value += static_cast<char>(0xE0 | (codePoint >> 12));
+            value += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            value += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            value += static_cast<char>(0xF0 | (codePoint >> 18));
+            value += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            value += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            value += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    template<class StringT>
+    bool ReadEscape(StringT& value)
+    {
+        if(_position == _end)
+            return false;
+
+        const char c = *_position++;
+        switch(c)
+        {
+        case '"': value += '"'; return true;
+        case '\\': value += '\\'; return true;
+        case '/': value += '/'; return true;
+        case 'b': value += '\b'; return true;
+        case 'f': value += '\f'; return true;
+        case 'n': value += '\n'; return true;
+        case 'r': value += '\r'; return true;
+        case 't': value += '\t'; return true;
+        case 'u':
+            break;
+        default:
+            return false;
+        }
+
+        uint32_t codePoint = 0;
+        if(_end - _position < 4 || !ReadHex(_position, codePoint))
+            return false;
+        _position += 4;
+
+        if(codePoint >= 0xD800 && codePoint < 0xDC00)
+        {
+            uint32_t low = 0;
+            if(_end - _position < 6 || _position[0] != '\\' || _position[1] != 'u' || !ReadHex(_position + 2, low)
+                || low < 0xDC00 || low >= 0xE000)
+                return false;
+            _position += 6;
+            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        AppendUtf8(value, codePoint);
+        return true;
+    }
+
+    //
+    //  Reads string content after opening quote
+    //
+    template<class StringT>
+    bool ReadString(StringT& value)
+    {
+        while(true)
+        {
+            const char* start = _position;
+            while(_position != _end && *_position != '"' && *_position != '\\')
+                ++_position;
+
+            value.append(start, _position - start);
+            if(_position == _end)
+                return false;
+
+            if(*_position++ == '"')
+                return true;
+
+            if(!ReadEscape(value))
+                return false;
+        }
+    }
+
+    //
+    //  Reads object key. Keys without escapes refer directly to the input,
+    //  others are decoded into _key.
+    //
+    bool ReadKey(std::string_view& key)
+    {
+        if(!Consume('"'))
+            return false;
+
+        const char* start = _position;
+        while(_position != _end && *_position != '"' && *_position != '\\')
+            ++_position;
+
+        if(_position == _end)
+            return false;
+
+        if(*_position == '"')
+        {
+            key = std::string_view(start, _position++ - start);
+            return Consume(':');
+        }
+
+        _key.assign(start, _position - start);
+        ++_position;
+        if(!ReadEscape(_key) || !ReadString(_key))
+            return false;
+
+        key = _key;
+        return Consume(':');
+    }
+
+    std::string_view ReadNumberToken()
+    {
+        SkipWhitespace();
+        const char* start = _position;
+        while(_position != _end && ((*_position >= '0' && *_position <= '9') || *_position == '-' || *_position == '+'
+            || *_position == '.' || *_position == 'e' || *_position == 'E'))
+            ++_position;
+
+        return std::string_view(start, _position - start);
+    }
+
+    //
+    //  Skips any JSON value (used for unknown keys)
+    //
+    bool SkipValue()
+    {
+        SkipWhitespace();
+        size_t depth = 0;
+        do
+        {
+            if(_position == _end)
+                return false;
+
+            const char c = *_position++;
+            if(c == '{' || c == '[')
+                ++depth;
+            else if(c == '}' || c == ']')
+            {
+                if(depth == 0)
+                    return false;
+                --depth;
+            }
+            else if(c == '"')
+            {
+                while(_position != _end && *_position != '"')
+                {
+                    if(*_position == '\\' && _position + 1 != _end)
+                        ++_position;
+                    ++_position;
+                }
+                if(_position == _end)
+                    return false;
+                ++_position;
+            }
+            else if(c != ',' && c != ':' && c != ' ' && c != '\n' && c != '\r' && c != '\t')
+            {
+                while(_position != _end && *_position != ',' && *_position != '}' && *_position != ']'
+                    && *_position != ' ' && *_position != '\n' && *_position != '\r' && *_position != '\t')
+                    ++_position;
+            }
+        }
+        while(depth != 0);
+
+        return true;
+    }
+
+    //
+    //  Calls function(itemIndex) for every item of JSON array
+    //
+    template<class FunctionT>
+    bool VisitArray(FunctionT&& function)
+    {
+        if(!Consume('['))
+            return false;
+
+        if(Consume(']'))
+            return true;
+
+        size_t index = 0;
+        do
+        {
+            if(!function(index++))
+                return false;
+        }
+        while(Consume(','));
+
+        return Consume(']');
+    }
+
+    //
+    //  Sequence containers are decoded in place: existing elements are reused
+    //  and extra ones are removed
+    //
+    template<class T>
+    bool VisitList(T& value)
+    {
+        auto item = value.begin();
+        size_t size = 0;
+        bool result = VisitArray([&](size_t /*index*/)
+        {
+            if(item == value.end())
+            {
+                value.emplace_back();
+                item = std::prev(value.end());
+            }
+            ++size;
+            return Visit(*item++);
+        });
+
+        value.resize(size);
+        return result;
+    }
+
+    template<class T>
+    bool VisitSet(T& value)
+    {
+        value.clear();
+        return VisitArray([&](size_t /*index*/)
+        {
+            typename T::value_type item;
+            if(!Visit(item))
+                return false;
+
+            value.insert(value.end(), std::move(item));
+            return true;
+        });
+    }
+
+    template<class T>
+    bool VisitMap(T& value)
+    {
+        value.clear();
+        SkipWhitespace();
+        if(_position != _end && *_position == '{')
+        {
+            ++_position;
+            if(Consume('}'))
+                return true;
+
+            do
+            {
+                std::pair<typename T::key_type, typename T::mapped_type> item;
+                if(!Visit(item.first) || !Consume(':') || !Visit(item.second))
+                    return false;
+
+                value.insert(value.end(), std::move(item));
+            }
+            while(Consume(','));
+
+            return Consume('}');
+        }
+
+        return VisitArray([&](size_t /*index*/)
+        {
+            std::pair<typename T::key_type, typename T::mapped_type> item;
+            if(!Visit(item))
+                return false;
+
+            value.insert(value.end(), std::move(item));
+            return true;
+        });
+    }
+
+    template<class T, size_t... Index>
+    bool VisitTuple(T& value, std::index_sequence<Index...>)
+    {
+        if(!Consume('['))
+            return false;
+
+        bool result = true;
+        ((result = result && (Index == 0 || Consume(',')) && Visit(std::get<Index>(value))), ...);
+        return result && Consume(']');
+    }
+
+    std::string _key;
+
+public:
+    JsonReader(std::string_view text) : _position(text.data()), _end(text.data() + text.size()) {}
+
+    //
+    //  Returns true if there is nothing except whitespace left
+    //
+    bool AtEnd()
+    {
+        SkipWhitespace();
+        return _position == _end;
+    }
+
+    //
+    //  Strings
+    //
+    template<class Traits, class Allocator>
+    bool Visit(std::basic_string<char, Traits, Allocator>& value)
+    {
+        value.clear();
+        return Consume('"') && ReadString(value);
+    }
+
+    //
+    //  Smart pointers. Existing pointee of unique_ptr is reused. Deleter with
+    //  New() creates the pointee itself (see PmrDeleter in Pmr.h).
+    //
+    template<class T, class Deleter>
+    bool Visit(std::unique_ptr<T, Deleter>& value)
+    {
+        if(ConsumeLiteral("null"))
+        {
+            value.reset();
+            return true;
+        }
+
+        if(!value)
+        {
+            if constexpr(HasPointeeFactory<Deleter>::value)
+                value.reset(value.get_deleter().New());
+            else
+                value.reset(new T());
+        }
+        return Visit(*value);
+    }
+
+    template<class T>
+    bool Visit(std::shared_ptr<T>& value)
+    {
+        if(ConsumeLiteral("null"))
+        {
+            value.reset();
+            return true;
+        }
+
+        //  Pointee can be shared with other objects, so never decode in place
+        value = std::make_shared<T>();
+        return Visit(*value);
+    }
+
+    //
+    //  Pairs and tuples
+    //
+    template<typename T1, typename T2>
+    bool Visit(std::pair<T1, T2>& value)
+    {
+        return Consume('[') && Visit(value.first) && Consume(',') && Visit(value.second) && Consume(']');
+    }
+
+    template<typename... TupleTypes>
+    bool Visit(std::tuple<TupleTypes...>& value)
+    {
+        return VisitTuple(value, std::index_sequence_for<TupleTypes...>());
+    }
+
+    //
+    //  Sequence containers
+    //
+    template<class T, std::size_t N>
+    bool Visit(std::array<T, N>& value)
+    {
+        size_t size = 0;
+        return VisitArray([&](size_t index)
+        {
+            size = index + 1;
+            return index < N && Visit(value[index]);
+        }) && size == N;
+    }
+
+    template<class T, class Allocator>
+    bool Visit(std::vector<T, Allocator>& value) { return VisitList(value); }
+
+    template<class Allocator>
+    bool Visit(std::vector<bool, Allocator>& value)
+    {
+        value.clear();
+        return VisitArray([&](size_t /*index*/)
+        {
+            bool item = false;
+            if(!Visit(item))
+                return false;
+
+            value.push_back(item);
+            return true;
+        });
+    }
+
+    template<class T, class Allocator>
+    bool Visit(std::deque<T, Allocator>& value) { return VisitList(value); }
+
+    template<class T, class Allocator>
+    bool Visit(std::forward_list<T, Allocator>& value)
+    {
+        auto previous = value.before_begin();
+        bool result = VisitArray([&](size_t /*index*/)
+        {
+            if(std::next(previous) == value.end())
+                value.emplace_after(previous);
+            return Visit(*++previous);
+        });
+
+        while(std::next(previous) != value.end())
+            value.erase_after(previous);
+        return result;
+    }
+
+    template<class T, class Allocator>
+    bool Visit(std::list<T, Allocator>& value) { return VisitList(value); }
+
+    //
+    //  Associative containers
+    //
+    template<class Key, class Compare, class Allocator>
+    bool Visit(std::set<Key, Compare, Allocator>& value) { return VisitSet(value); }
+
+    template<class Key, class T, class Compare, class Allocator>
+    bool Visit(std::map<Key, T, Compare, Allocator>& value) { return VisitMap(value); }
+
+    template<class Key, class Compare, class Allocator>
+    bool Visit(std::multiset<Key, Compare, Allocator>& value) { return VisitSet(value); }
+
+    template<class Key, class T, class Compare, class Allocator>
+    bool Visit(std::multimap<Key, T, Compare, Allocator>& value) { return VisitMap(value); }
+
+    //
+    //  Unordered associative containers
+    //
+    template<class Key, class Hash, class KeyEqual, class Allocator>
+    bool Visit(std::unordered_set<Key, Hash, KeyEqual, Allocator>& value) { return VisitSet(value); }
+
+    template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+    bool Visit(std::unordered_map<Key, T, Hash, KeyEqual, Allocator>& value) { return VisitMap(value); }
+
+    template<class Key, class Hash, class KeyEqual, class Allocator>
+    bool Visit(std::unordered_multiset<Key, Hash, KeyEqual, Allocator>& value) { return VisitSet(value); }
+
+    template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+    bool Visit(std::unordered_multimap<Key, T, Hash, KeyEqual, Allocator>& value) { return VisitMap(value); }
+
+    //
+    //  Specification for reflectable class
+    //
+    template<class T>
+    typename std::enable_if_t<Reflection::IsReflectable<T>(), bool> Visit(T& value)
+    {
+        if(!Consume('{'))
+            return false;
+
+        if(Consume('}'))
+            return true;
+
+        FieldReader fieldReader(*this);
+        do
+        {
+            std::string_view key;
+            if(!ReadKey(key))
+                return false;
+
+            const uint32_t fieldId = Reflection::FindFieldId<T>(key);
+            if(fieldId == Reflection::GetFieldCount<T>())
+            {
+                if(!SkipValue())
+                    return false;
+            }
+            else if(!Reflection::VisitFieldById(value, fieldId, fieldReader))
+                return false;
+        }
+        while(Consume(','));
+
+        return Consume('}');
+    }
+
+    //
+    //  Primitive types
+    //
+    bool Visit(bool& value)
+    {
+        if(ConsumeLiteral("true"))
+            value = true;
+        else if(ConsumeLiteral("false"))
+            value = false;
+        else
+            return false;
+
+        return true;
+    }
+
+    bool Visit(char& value)
+    {
+        if(!Consume('"') || _position == _end)
+            return false;
+
+        if(*_position == '\\')
+        {
+            ++_position;
+            std::string escaped;
+            if(!ReadEscape(escaped) || escaped.size() != 1)
+                return false;
+
+            value = escaped[0];
+        }
+        else
+            value = *_position++;
+
+        return _position != _end && *_position++ == '"';
+    }
+
+    template<class T>
+    typename std::enable_if_t<std::is_integral<T>::value, bool> Visit(T& value)
+    {
+        const std::string_view token = ReadNumberToken();
+        const auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+        return result.ec == std::errc() && result.ptr == token.data() + token.size() && !token.empty();
+    }
+
+    template<class T>
+    typename std::enable_if_t<std::is_floating_point<T>::value, bool> Visit(T& value)
+    {
+        if(ConsumeLiteral("null"))
+        {
+            value = NAN;
+            return true;
+        }
+
+        const std::string_view token = ReadNumberToken();
+        const auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+        return result.ec == std::errc() && result.ptr == token.data() + token.size() && !token.empty();
+    }
+
+    template<class T>
+    typename std::enable_if_t<std::is_enum<T>::value, bool> Visit(T& value)
+    {
+        std::underlying_type_t<T> number = 0;
+        if(!Visit(number))
+            return false;
+
+        value = static_cast<T>(number);
+        return true;
+    }
+
+    template<class T>
+    typename std::enable_if_t<!Reflection::IsReflectable<T>() && !std::is_arithmetic<T>::value && !std::is_enum<T>::value, bool>
+        Visit(T& value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "Type isn't supported by JSON reader");
+        return false;
+    }
+};
+
+//
+//  Returns false if text isn't valid JSON or doesn't match the object type.
+//  In case of failure object can be partially updated.
+//
+template<typename ObjectT>
+bool FromJson(std::string_view text, ObjectT& obj)
+{
+    JsonReader reader(text);
+    return reader.Visit(obj) && reader.AtEnd();
+}
+
+};  //  namespace vklib
@@ -0,0 +1,144 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains hashing backends for Reflection::Hash.
+//  There are two kinds of backends:
+//  - byte stream hashers (BYTE_STREAM == true) implement
+//    void Update(const void* data, size_t size) and size_t Result(). Result
+//    depends only on the sequence of bytes, but not on how it was split into
+//    Update calls, so Reflection::Hash feeds adjacent fields and contiguous
+//    containers as single blocks;
+//  - value hashers (BYTE_STREAM == false) implement
+//    template<class T> void Combine(const T& value) and size_t Result(), and
+//    get every field as is.
+//  WyHasher is the default backend, BoostHasher reproduces boost::hash_combine
+//  over all fields.
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <boost/functional/hash.hpp>
+
+namespace vklib
+{
+
+//
+//  Streaming hasher built on wyhash mixing function: 16 byte blocks are mixed
+//  with 64x64->128 bit multiplication
+//
+class WyHasher
+{
+protected:
+    static constexpr uint64_t SECRET0 = 0xa0761d6478bd642full;
+    static constexpr uint64_t SECRET1 = 0xe7037ed1a0b428dbull;
+    static constexpr uint64_t SECRET2 = 0x8ebc6af09c88c6e3ull;
+
+    uint64_t _state;
+    uint64_t _length = 0;
+    uint8_t _buffer[16];
+    size_t _bufferSize = 0;
+
+    static inline uint64_t Mix(uint64_t a, uint64_t b)
+    {
+        const __uint128_t product = static_cast<__uint128_t>(a) * b;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+    }
+
+    static inline uint64_t Read64(const uint8_t* data)
+    {
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline void ProcessBlock(const uint8_t* data)
+    {
+        _state = Mix(Read64(data) ^ SECRET0, Read64(data + 8) ^ _state);
+    }
+
+public:
+    static constexpr bool BYTE_STREAM = true;
+
+    explicit WyHasher(uint64_t seed = 0) : _state(seed ^ SECRET2) {}
+
+    inline void Update(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        _length += size;
+
+        if(_bufferSize)
+        {
+            const size_t count = size < 16 - _bufferSize ? size : 16 - _bufferSize;
+            memcpy(_buffer + _bufferSize, bytes, count);
+            _bufferSize += count;
+            bytes += count;
+            size -= count;
+            if(_bufferSize < 16)
+                return;
+
+            ProcessBlock(_buffer);
+            _bufferSize = 0;
+        }
+
+        for(; size >= 16; bytes += 16, size -= 16)
+            ProcessBlock(bytes);
+
+        memcpy(_buffer, bytes, size);
+        _bufferSize = size;
+    }
+
+    inline size_t Result() const
+    {
+        uint8_t tail[16] = {};
+        memcpy(tail, _buffer, _bufferSize);
+        const uint64_t state = Mix(Read64(tail) ^ SECRET1, Read64(tail + 8) ^ _state ^ _bufferSize);
+        return static_cast<size_t>(Mix(state ^ _length, SECRET2 ^ _length));
+    }
+};
+
+//
+//  Legacy backend: boost::hash_combine of every field
+//
+class BoostHasher
+{
+protected:
+    size_t _seed = 0;
+
+public:
+    static constexpr bool BYTE_STREAM = false;
+
+    template<class T>
+    void Combine(const T& value)
+    {
+        boost::hash_combine(_seed, value);
+    }
+
+    size_t Result() const { return _seed; }
+};
+
+};  //  namespace vklib
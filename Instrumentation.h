@@ -0,0 +1,348 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains optional per type instrumentation of
+//  Reflection::VisitFields and ObjectPrinter (ToString, ToJson). It's enabled
+//  by defining VKLIB_INSTRUMENTATION for the whole program (e.g. with
+//  -DVKLIB_INSTRUMENTATION), otherwise VKLIB_INSTRUMENT and
+//  VKLIB_INSTRUMENT_STREAM expand to nothing.
+//  For every reflectable type and operation the registry collects count of
+//  calls, cumulative time, bytes written to the stream and allocations. Time,
+//  bytes and allocations of nested reflectable objects are also included in
+//  their parents.
+//  Allocations are counted only if exactly one translation unit defines
+//  VKLIB_INSTRUMENTATION_ALLOCATIONS before including this file, which
+//  replaces global operators new and delete (over-aligned allocations aren't
+//  counted). Program with its own operator new should increment
+//  vklib::instrumentationAllocationCount there instead.
+//  E.g.:
+//  ToString(obj);
+//  InstrumentationRegistry::Instance().Dump(std::cerr);
+//
+
+#pragma once
+
+#ifdef VKLIB_INSTRUMENTATION
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <cxxabi.h>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace vklib
+{
+
+enum class InstrumentedOperation
+{
+    VisitFields,
+    Print
+};
+
+inline const char* GetOperationName(InstrumentedOperation operation)
+{
+    return operation == InstrumentedOperation::VisitFields ? "VisitFields" : "Print";
+}
+
+//
+//  Allocations of the current thread, counted by replaced operator new
+//
+inline thread_local uint64_t instrumentationAllocationCount = 0;
+
+struct InstrumentationSnapshot
+{
+    std::string typeName;
+    InstrumentedOperation operation = InstrumentedOperation::VisitFields;
+    uint64_t calls = 0;
+    uint64_t nanoseconds = 0;
+    uint64_t bytes = 0;
+    uint64_t allocations = 0;
+};
+
+class InstrumentationRegistry
+{
+public:
+    struct Entry
+    {
+        const std::string typeName;
+        const InstrumentedOperation operation;
+        std::atomic<uint64_t> calls { 0 };
+        std::atomic<uint64_t> nanoseconds { 0 };
+        std::atomic<uint64_t> bytes { 0 };
+        std::atomic<uint64_t> allocations { 0 };
+
+        Entry(std::string name, InstrumentedOperation operation) : typeName(std::move(name)), operation(operation) {}
+    };
+
+protected:
+    mutable std::mutex _mutex;
+    //  Deque keeps addresses of entries stable
+    std::deque<Entry> _entries;
+
+    static InstrumentationSnapshot MakeSnapshot(const Entry& entry)
+    {
+        InstrumentationSnapshot snapshot;
+        snapshot.typeName = entry.typeName;
+        snapshot.operation = entry.operation;
+        snapshot.calls = entry.calls.load(std::memory_order_relaxed);
+        snapshot.nanoseconds = entry.nanoseconds.load(std::memory_order_relaxed);
+        snapshot.bytes = entry.bytes.load(std::memory_order_relaxed);
+        snapshot.allocations = entry.allocations.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+public:
+    static InstrumentationRegistry& Instance()
+    {
+        static InstrumentationRegistry registry;
+        return registry;
+    }
+
+    Entry& Register(std::string typeName, InstrumentedOperation operation)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _entries.emplace_back(std::move(typeName), operation);
+    }
+
+    std::vector<InstrumentationSnapshot> GetSnapshot() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<InstrumentationSnapshot> snapshot;
+        for(const Entry& entry : _entries)
+            snapshot.push_back(MakeSnapshot(entry));
+        return snapshot;
+    }
+
+    bool Find(std::string_view typeName, InstrumentedOperation operation, InstrumentationSnapshot& snapshot) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for(const Entry& entry : _entries)
+        {
+            if(entry.typeName == typeName && entry.operation == operation)
+            {
+                snapshot = MakeSnapshot(entry);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //
+    //  Zeroes counters, types stay registered
+    //
+    void Reset()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for(Entry& entry : _entries)
+        {
+            entry.calls.store(0, std::memory_order_relaxed);
+            entry.nanoseconds.store(0, std::memory_order_relaxed);
+            entry.bytes.store(0, std::memory_order_relaxed);
+            entry.allocations.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    //
+    //  Writes a line per type and operation, which was called
+    //
+    void Dump(std::ostream& stream) const
+    {
+        stream << std::left << std::setw(40) << "type" << std::setw(12) << "operation" << std::right
+            << std::setw(12) << "calls" << std::setw(14) << "total_us" << std::setw(12) << "avg_ns"
+            << std::setw(14) << "bytes" << std::setw(14) << "allocations" << "\n";
+        for(const InstrumentationSnapshot& entry : GetSnapshot())
+        {
+            if(!entry.calls)
+                continue;
+
+            stream << std::left << std::setw(40) << entry.typeName << std::setw(12) << GetOperationName(entry.operation)
+                << std::right << std::setw(12) << entry.calls << std::setw(14) << entry.nanoseconds / 1000
+                << std::setw(12) << entry.nanoseconds / entry.calls << std::setw(14) << entry.bytes
+                << std::setw(14) << entry.allocations << "\n";
+        }
+        stream.flush();
+    }
+};
+
+template<class T>
+std::string GetInstrumentedTypeName()
+{
+    const char* name = typeid(T).name();
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    std::string result = status == 0 && demangled ? demangled : name;
+    free(demangled);
+    return result;
+}
+
+//
+//  Registry entry of the type and operation, registered on first use
+//
+template<class T, InstrumentedOperation Operation>
+InstrumentationRegistry::Entry& GetInstrumentationEntry()
+{
+    static InstrumentationRegistry::Entry& entry = InstrumentationRegistry::Instance().Register(
+        GetInstrumentedTypeName<T>(), Operation);
+    return entry;
+}
+
+template<class T, class = void>
+struct HasInstrumentedSize : std::false_type {};
+
+template<class T>
+struct HasInstrumentedSize<T, std::void_t<decltype(std::declval<const T&>().Size())>> : std::true_type {};
+
+//
+//  Size of text in the stream, 0 if it isn't known
+//
+template<class StreamT>
+uint64_t GetInstrumentedStreamSize(StreamT& stream)
+{
+    if constexpr(std::is_base_of<std::ostream, StreamT>::value)
+    {
+        const auto position = stream.tellp();
+        return position >= 0 ? static_cast<uint64_t>(position) : 0;
+    }
+    else if constexpr(HasInstrumentedSize<StreamT>::value)
+        return stream.Size();
+    else
+        return 0;
+}
+
+//
+//  Adds call, its time and allocations to the entry. With a stream also adds
+//  the bytes written to it.
+//
+template<class T, InstrumentedOperation Operation, class StreamT = void>
+class InstrumentationScope
+{
+protected:
+    InstrumentationRegistry::Entry& _entry;
+    StreamT* const _stream;
+    const uint64_t _streamSize;
+    const uint64_t _allocationCount;
+    const std::chrono::steady_clock::time_point _start;
+
+    uint64_t GetStreamSize() const
+    {
+        if constexpr(std::is_void<StreamT>::value)
+            return 0;
+        else
+            return _stream ? GetInstrumentedStreamSize(*_stream) : 0;
+    }
+
+public:
+    explicit InstrumentationScope(StreamT* stream = nullptr)
+        : _entry(GetInstrumentationEntry<T, Operation>()),
+        _stream(stream),
+        _streamSize(GetStreamSize()),
+        _allocationCount(instrumentationAllocationCount),
+        _start(std::chrono::steady_clock::now())
+    {
+    }
+
+    InstrumentationScope(const InstrumentationScope&) = delete;
+    InstrumentationScope& operator=(const InstrumentationScope&) = delete;
+
+    ~InstrumentationScope()
+    {
+        const auto finish = std::chrono::steady_clock::now();
+        _entry.calls.fetch_add(1, std::memory_order_relaxed);
+        _entry.nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(finish - _start).count(),
+            std::memory_order_relaxed);
+        _entry.allocations.fetch_add(instrumentationAllocationCount - _allocationCount, std::memory_order_relaxed);
+        const uint64_t streamSize = GetStreamSize();
+        if(streamSize > _streamSize)
+            _entry.bytes.fetch_add(streamSize - _streamSize, std::memory_order_relaxed);
+    }
+};
+
+};  //  namespace vklib
+
+#define VKLIB_INSTRUMENT(T, OPERATION)                                                          \
+    ::vklib::InstrumentationScope<std::remove_cv_t<T>, ::vklib::InstrumentedOperation::OPERATION> \
+        vklibInstrumentationScope
+
+#define VKLIB_INSTRUMENT_STREAM(T, OPERATION, stream)                                           \
+    ::vklib::InstrumentationScope<std::remove_cv_t<T>, ::vklib::InstrumentedOperation::OPERATION, \
+        std::remove_reference_t<decltype(stream)>> vklibInstrumentationScope(&(stream))
+
+#ifdef VKLIB_INSTRUMENTATION_ALLOCATIONS
+
+//
+//  All forms of operator new and delete except over-aligned ones are
+//  replaced, so memory is never allocated by one implementation and freed by
+//  another (e.g. by the one of a sanitizer)
+//
+static void* VklibInstrumentedAllocate(size_t size) noexcept
+{
+    ++vklib::instrumentationAllocationCount;
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size)
+{
+    if(void* data = VklibInstrumentedAllocate(size))
+        return data;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    if(void* data = VklibInstrumentedAllocate(size))
+        return data;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return VklibInstrumentedAllocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return VklibInstrumentedAllocate(size); }
+
+void operator delete(void* data) noexcept { free(data); }
+void operator delete[](void* data) noexcept { free(data); }
+void operator delete(void* data, size_t) noexcept { free(data); }
+void operator delete[](void* data, size_t) noexcept { free(data); }
+void operator delete(void* data, const std::nothrow_t&) noexcept { free(data); }
+void operator delete[](void* data, const std::nothrow_t&) noexcept { free(data); }
+
+#endif
+
+#else
+
+#define VKLIB_INSTRUMENT(T, OPERATION)
+#define VKLIB_INSTRUMENT_STREAM(T, OPERATION, stream)
+
+#endif
@@ -0,0 +1,180 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains thread safe interner (hash consing) of reflectable
+//  objects. Equal objects are stored once and shared as immutable handles,
+//  so handles of equal values are equal pointers and Reflection::Equal of
+//  them returns without comparing fields.
+//  Objects are hashed with Reflection::Hash before locking one of the shards,
+//  which are selected by the hash, so threads rarely wait for each other.
+//  Interner keeps canonical objects alive until Collect() removes the ones
+//  without other handles.
+//  E.g.:
+//  Interner<Route> routes;
+//  Interner<Route>::Handle route = routes.Intern(parsedRoute);
+//  assert(route == routes.Intern(Route(parsedRoute)));
+//
+
+#pragma once
+
+#include "Reflection.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace vklib
+{
+
+struct InternerStats
+{
+    //  Calls of Intern
+    uint64_t lookups = 0;
+    //  Calls, which returned an existing object
+    uint64_t hits = 0;
+    //  Objects in the interner
+    uint64_t objects = 0;
+    //  sizeof of the objects, which weren't stored because of hits. Memory
+    //  owned by them (strings, containers, ...) isn't included.
+    uint64_t bytesSaved = 0;
+
+    double GetHitRate() const { return lookups ? double(hits) / lookups : 0; }
+};
+
+template<class ReflectableClass, size_t ShardCount = 64, class HasherT = WyHasher>
+class Interner
+{
+    static_assert(Reflection::IsReflectable<ReflectableClass>(), "Interner requires reflectable class");
+    static_assert(ShardCount > 0, "Interner requires at least one shard");
+
+public:
+    typedef std::shared_ptr<const ReflectableClass> Handle;
+
+protected:
+    //  Own cache line per shard, so locking one doesn't slow down the others
+    struct alignas(64) Shard
+    {
+        std::mutex mutex;
+        std::unordered_multimap<size_t, Handle> objects;
+        uint64_t lookups = 0;
+        uint64_t hits = 0;
+    };
+
+    std::array<Shard, ShardCount> _shards;
+
+    static Handle Find(const Shard& shard, size_t hash, const ReflectableClass& obj)
+    {
+        const auto range = shard.objects.equal_range(hash);
+        for(auto it = range.first; it != range.second; ++it)
+        {
+            if(Reflection::Equal(*it->second, obj))
+                return it->second;
+        }
+        return nullptr;
+    }
+
+    template<class T>
+    Handle InternObject(T&& obj)
+    {
+        const size_t hash = Reflection::Hash<ReflectableClass, HasherT>(obj);
+        Shard& shard = _shards[hash % ShardCount];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            ++shard.lookups;
+            if(Handle existing = Find(shard, hash, obj))
+            {
+                ++shard.hits;
+                return existing;
+            }
+        }
+
+        //  Copy is made without the lock, so another thread could intern
+        //  the same value meanwhile
+        Handle created = std::make_shared<const ReflectableClass>(std::forward<T>(obj));
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if(Handle existing = Find(shard, hash, *created))
+        {
+            ++shard.hits;
+            return existing;
+        }
+        shard.objects.emplace(hash, created);
+        return created;
+    }
+
+public:
+    Interner() = default;
+    Interner(const Interner&) = delete;
+    Interner& operator=(const Interner&) = delete;
+
+    //
+    //  Returns canonical object equal to obj, which is copied or moved into
+    //  the interner, if there is no such object yet
+    //
+    Handle Intern(const ReflectableClass& obj) { return InternObject(obj); }
+    Handle Intern(ReflectableClass&& obj) { return InternObject(std::move(obj)); }
+
+    //
+    //  Removes objects, which aren't referenced outside the interner, and
+    //  returns their count
+    //
+    size_t Collect()
+    {
+        size_t count = 0;
+        for(Shard& shard : _shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for(auto it = shard.objects.begin(); it != shard.objects.end(); )
+            {
+                if(it->second.use_count() == 1)
+                {
+                    it = shard.objects.erase(it);
+                    ++count;
+                }
+                else
+                    ++it;
+            }
+        }
+        return count;
+    }
+
+    InternerStats GetStats()
+    {
+        InternerStats stats;
+        for(Shard& shard : _shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.lookups += shard.lookups;
+            stats.hits += shard.hits;
+            stats.objects += shard.objects.size();
+        }
+        stats.bytesSaved = stats.hits * sizeof(ReflectableClass);
+        return stats;
+    }
+};
+
+};  //  namespace vklib
@@ -0,0 +1,187 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains streaming text sinks for ObjectPrinter (see ToString.h
+//  and TextWriter.h). The text is collected in a fixed size page, which is
+//  flushed as soon as it fills, so memory usage and latency of the first
+//  byte don't depend on the size of the printed object. Writes larger than
+//  the page bypass it: they are flushed together with the buffered text
+//  without copying.
+//  FdWriter flushes to a file descriptor with writev, CallbackWriter passes
+//  the text to a callable with void(const char* data, size_t size) signature,
+//  e.g. for sockets. Both flush the rest of the text in Flush and destructor.
+//  E.g.:
+//  FdWriter<> writer(fd);
+//  ToString(writer, obj);
+//  bool ok = writer.Flush();
+//
+
+#pragma once
+
+#include "TextWriter.h"
+#include <errno.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+namespace vklib
+{
+
+//
+//  Base class of paged sinks. DerivedT implements
+//  bool WriteBlocks(iovec* blocks, int count), which writes all blocks.
+//
+template<class DerivedT, size_t PageSize>
+class PagedWriter : public TextFormatter<DerivedT>
+{
+protected:
+    static_assert(PageSize > 0, "Page can't be empty");
+
+    std::unique_ptr<char[]> _page { new char[PageSize] };
+    size_t _size = 0;
+    bool _good = true;
+
+    bool FlushWith(const char* data, size_t size)
+    {
+        iovec blocks[2];
+        int count = 0;
+        if(_size)
+            blocks[count++] = { _page.get(), _size };
+        if(size)
+            blocks[count++] = { const_cast<char*>(data), size };
+        _size = 0;
+        if(count && _good)
+            _good = this->Self().WriteBlocks(blocks, count);
+        return _good;
+    }
+
+public:
+    PagedWriter() = default;
+    PagedWriter(const PagedWriter&) = delete;
+    PagedWriter& operator=(const PagedWriter&) = delete;
+
+    void Write(const char* data, size_t size)
+    {
+        if(_size + size <= PageSize)
+        {
+            memcpy(_page.get() + _size, data, size);
+            _size += size;
+            return;
+        }
+
+        if(size >= PageSize)
+        {
+            FlushWith(data, size);
+            return;
+        }
+
+        //  Fill the page up, flush it and start the next one. head is less
+        //  than size here, min makes it visible to the compiler.
+        const size_t head = std::min(size, PageSize - _size);
+        memcpy(_page.get() + _size, data, head);
+        _size = PageSize;
+        FlushWith(nullptr, 0);
+        memcpy(_page.get(), data + head, size - head);
+        _size = size - head;
+    }
+
+    //
+    //  Writes buffered text. Returns false if any write has failed.
+    //
+    bool Flush()
+    {
+        return FlushWith(nullptr, 0);
+    }
+
+    bool Good() const { return _good; }
+};
+
+template<size_t PageSize = 64 * 1024>
+class FdWriter : public PagedWriter<FdWriter<PageSize>, PageSize>
+{
+protected:
+    int _fd;
+
+public:
+    explicit FdWriter(int fd) : _fd(fd) {}
+
+    ~FdWriter()
+    {
+        this->Flush();
+    }
+
+    //
+    //  Writes the blocks completely, retrying after partial writes and signals
+    //
+    bool WriteBlocks(iovec* blocks, int count)
+    {
+        while(count > 0)
+        {
+            const ssize_t written = writev(_fd, blocks, count);
+            if(written < 0)
+            {
+                if(errno == EINTR)
+                    continue;
+                return false;
+            }
+
+            size_t remaining = static_cast<size_t>(written);
+            for(; count > 0 && remaining >= blocks->iov_len; ++blocks, --count)
+                remaining -= blocks->iov_len;
+            if(count > 0)
+            {
+                blocks->iov_base = static_cast<char*>(blocks->iov_base) + remaining;
+                blocks->iov_len -= remaining;
+            }
+        }
+        return true;
+    }
+};
+
+template<class CallbackT, size_t PageSize = 64 * 1024>
+class CallbackWriter : public PagedWriter<CallbackWriter<CallbackT, PageSize>, PageSize>
+{
+protected:
+    CallbackT _callback;
+
+public:
+    explicit CallbackWriter(CallbackT callback) : _callback(std::move(callback)) {}
+
+    ~CallbackWriter()
+    {
+        this->Flush();
+    }
+
+    bool WriteBlocks(iovec* blocks, int count)
+    {
+        for(int i = 0; i < count; ++i)
+            _callback(static_cast<const char*>(blocks[i].iov_base), blocks[i].iov_len);
+        return true;
+    }
+};
+
+};  //  namespace vklib
@@ -0,0 +1,296 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains copying, cloning and decoding of reflectable objects
+//  into std::pmr::memory_resource, e.g. std::pmr::monotonic_buffer_resource,
+//  so all objects of a request are released at once. Fields are handled as
+//  follows:
+//  - allocator aware fields (std::pmr::string, std::pmr::vector, ... or
+//    classes with std::pmr::polymorphic_allocator allocator_type) are rebuilt
+//    with the resource. Their elements are in the resource as well, when they
+//    are allocator aware themselves (e.g. std::pmr::vector<std::pmr::string>);
+//  - nested reflectable classes are handled field by field;
+//  - PmrPtr pointees are allocated in the resource;
+//  - other fields are copied as is.
+//  E.g.:
+//  std::pmr::monotonic_buffer_resource arena;
+//  PmrPtr<Request> copy = PmrClone(request, &arena);
+//  Request decoded;
+//  bool ok = PmrBinaryDeserialize(data, size, decoded, &arena);
+//
+
+#pragma once
+
+#include "Reflection.h"
+#include "Serialization.h"
+#include <stddef.h>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace vklib
+{
+
+typedef std::pmr::polymorphic_allocator<std::byte> PmrAllocator;
+
+template<class T>
+struct IsPmrAware : std::uses_allocator<T, PmrAllocator> {};
+
+//
+//  Deleter of objects allocated in memory resource. New() creates pointee in
+//  the resource, which is used by BinaryDeserializer.
+//
+template<class T>
+class PmrDeleter
+{
+protected:
+    std::pmr::memory_resource* _resource;
+
+public:
+    PmrDeleter(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : _resource(resource) {}
+
+    std::pmr::memory_resource* GetResource() const { return _resource; }
+
+    void operator()(T* obj) const
+    {
+        obj->~T();
+        _resource->deallocate(obj, sizeof(T), alignof(T));
+    }
+
+    T* New() const;
+};
+
+template<class T>
+using PmrPtr = std::unique_ptr<T, PmrDeleter<T>>;
+
+template<class T>
+struct IsPmrPtr : std::false_type {};
+
+template<class T>
+struct IsPmrPtr<std::unique_ptr<T, PmrDeleter<T>>> : std::true_type {};
+
+class PmrBuilder
+{
+protected:
+    //
+    //  Uses-allocator construction
+    //
+    template<class T, class... ArgsT>
+    static void Construct(T* place, std::pmr::memory_resource* resource, ArgsT&&... args)
+    {
+        const PmrAllocator allocator(resource);
+        if constexpr(!IsPmrAware<T>::value)
+            new (place) T(std::forward<ArgsT>(args)...);
+        else if constexpr(std::is_constructible<T, std::allocator_arg_t, const PmrAllocator&, ArgsT...>::value)
+            new (place) T(std::allocator_arg, allocator, std::forward<ArgsT>(args)...);
+        else
+            new (place) T(std::forward<ArgsT>(args)..., allocator);
+    }
+
+    //
+    //  Allocator of a constructed object can't be changed, so the field is
+    //  destroyed and constructed again. Only a throwing move constructor
+    //  (e.g. of std::pmr::deque) could fail here, which terminates.
+    //
+    template<class T>
+    static void Replace(T& field, T&& value) noexcept
+    {
+        field.~T();
+        new (&field) T(std::move(value));
+    }
+
+    template<class T>
+    static void CopyField(T& target, const T& source, std::pmr::memory_resource* resource)
+    {
+        if constexpr(IsPmrAware<T>::value)
+        {
+            alignas(T) unsigned char place[sizeof(T)];
+            T* copy = reinterpret_cast<T*>(place);
+            Construct(copy, resource, source);
+            Replace(target, std::move(*copy));
+            copy->~T();
+        }
+        else if constexpr(IsPmrPtr<T>::value)
+            target = source ? Clone(*source, resource) : T(nullptr, typename T::deleter_type(resource));
+        else if constexpr(Reflection::IsReflectable<T>())
+            Copy(target, source, resource);
+        else
+            target = source;
+    }
+
+    template<class T>
+    static void ClearField(T& field, std::pmr::memory_resource* resource)
+    {
+        if constexpr(IsPmrAware<T>::value)
+        {
+            alignas(T) unsigned char place[sizeof(T)];
+            T* empty = reinterpret_cast<T*>(place);
+            Construct(empty, resource);
+            Replace(field, std::move(*empty));
+            empty->~T();
+        }
+        else if constexpr(IsPmrPtr<T>::value)
+            field = T(nullptr, typename T::deleter_type(resource));
+        else if constexpr(Reflection::IsReflectable<T>())
+            Clear(field, resource);
+    }
+
+    template<class ReflectableClass, uint32_t... Index>
+    static void CopyFields(ReflectableClass& target, const ReflectableClass& source, std::pmr::memory_resource* resource,
+        std::integer_sequence<uint32_t, Index...>)
+    {
+        (CopyField(Reflection::GetFieldValue<Index>(target), Reflection::GetFieldValue<Index>(source), resource), ...);
+    }
+
+    template<class ReflectableClass, uint32_t... Index>
+    static void ClearFields(ReflectableClass& obj, std::pmr::memory_resource* resource, std::integer_sequence<uint32_t, Index...>)
+    {
+        (ClearField(Reflection::GetFieldValue<Index>(obj), resource), ...);
+    }
+
+public:
+    template<class ReflectableClass>
+    static void Copy(ReflectableClass& target, const ReflectableClass& source, std::pmr::memory_resource* resource)
+    {
+        CopyFields(target, source, resource,
+            std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<ReflectableClass>()>());
+    }
+
+    template<class ReflectableClass>
+    static void Clear(ReflectableClass& obj, std::pmr::memory_resource* resource)
+    {
+        ClearFields(obj, resource, std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<ReflectableClass>()>());
+    }
+
+    //
+    //  Default constructed object in the resource
+    //
+    template<class T>
+    static PmrPtr<T> New(std::pmr::memory_resource* resource)
+    {
+        void* place = resource->allocate(sizeof(T), alignof(T));
+        try
+        {
+            Construct(static_cast<T*>(place), resource);
+        }
+        catch(...)
+        {
+            resource->deallocate(place, sizeof(T), alignof(T));
+            throw;
+        }
+
+        PmrPtr<T> obj(static_cast<T*>(place), PmrDeleter<T>(resource));
+        if constexpr(Reflection::IsReflectable<T>() && !IsPmrAware<T>::value)
+            Clear(*obj, resource);
+        return obj;
+    }
+
+    template<class T>
+    static PmrPtr<T> Clone(const T& source, std::pmr::memory_resource* resource)
+    {
+        if constexpr(Reflection::IsReflectable<T>() && !IsPmrAware<T>::value)
+        {
+            PmrPtr<T> obj = New<T>(resource);
+            Copy(*obj, source, resource);
+            return obj;
+        }
+        else
+        {
+            void* place = resource->allocate(sizeof(T), alignof(T));
+            try
+            {
+                Construct(static_cast<T*>(place), resource, source);
+            }
+            catch(...)
+            {
+                resource->deallocate(place, sizeof(T), alignof(T));
+                throw;
+            }
+            return PmrPtr<T>(static_cast<T*>(place), PmrDeleter<T>(resource));
+        }
+    }
+};
+
+template<class T>
+T* PmrDeleter<T>::New() const
+{
+    return PmrBuilder::New<T>(_resource).release();
+}
+
+//
+//  Copies source into target, allocating all strings, containers and
+//  pointees in the resource
+//
+template<class ReflectableClass>
+void PmrCopy(ReflectableClass& target, const ReflectableClass& source, std::pmr::memory_resource* resource)
+{
+    PmrBuilder::Copy(target, source, resource);
+}
+
+//
+//  Copy of the object allocated in the resource
+//
+template<class T>
+PmrPtr<T> PmrClone(const T& source, std::pmr::memory_resource* resource)
+{
+    return PmrBuilder::Clone(source, resource);
+}
+
+//
+//  Default constructed object allocated in the resource
+//
+template<class T>
+PmrPtr<T> PmrNew(std::pmr::memory_resource* resource)
+{
+    return PmrBuilder::New<T>(resource);
+}
+
+//
+//  Empties allocator aware fields and pointers and binds them to the
+//  resource, so BinaryDeserialize, Apply (see Diff.h) and others decode into
+//  the resource
+//
+template<class ReflectableClass>
+void PmrClear(ReflectableClass& obj, std::pmr::memory_resource* resource)
+{
+    PmrBuilder::Clear(obj, resource);
+}
+
+template<class ReflectableClass>
+bool PmrBinaryDeserialize(const void* data, size_t size, ReflectableClass& obj, std::pmr::memory_resource* resource)
+{
+    PmrClear(obj, resource);
+    return BinaryDeserialize(data, size, obj);
+}
+
+template<class BufferT, class ReflectableClass>
+bool PmrBinaryDeserialize(const BufferT& buffer, ReflectableClass& obj, std::pmr::memory_resource* resource)
+{
+    return PmrBinaryDeserialize(buffer.data(), buffer.size(), obj, resource);
+}
+
+};  //  namespace vklib
@@ -49,6 +49,10 @@
 // };
 //  We can print all fields of the classs, using the following code:
 //  Reflection::VisitFields(ReflectableClassInstance, FieldPrinterInstance);
+//  Operations can be restricted to a compile time subset of fields
+//  (FieldProjection), other fields generate no code:
+//  FIELD_PROJECTION(Key, IntField, StringField);
+//  Reflection::Equal<ReflectableClass::Key>(obj1, obj2);
 //  See Test/ReflectionTest.cpp for examples.
 //
 
@@ -57,145 +61,694 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
+#include <array>
+#include <functional>
+#include <string_view>
+#include <tuple>
 #include <utility>
 #include <type_traits>
-#include <boost/functional/hash.hpp>
+#include "Hashing.h"
+#include "Instrumentation.h"
+#include <boost/preprocessor/punctuation/comma_if.hpp>
 #include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/preprocessor/seq/for_each_i.hpp>
 #include <boost/preprocessor/variadic/to_seq.hpp>
 #include <boost/preprocessor/seq/to_tuple.hpp>
 
 namespace vklib
 {
 
+//
+//  Deleter of unique_ptr with New() creates the pointee itself, so decoders
+//  allocate it where the deleter frees it (see PmrDeleter in Pmr.h)
+//
+template<class Deleter, class = void>
+struct HasPointeeFactory : std::false_type {};
+
+template<class Deleter>
+struct HasPointeeFactory<Deleter, std::void_t<decltype(std::declval<const Deleter&>().New())>> : std::true_type {};
+
+//
+//  Compile time list of field ids. Operations over projection handle only
+//  its fields in the order of the list. Declared either by FIELD_PROJECTION
+//  inside of the class or by ids, e.g.
+//  FieldProjection<Reflection::FindFieldId<T>("id"), Reflection::FindFieldId<T>("name")>
+//
+template<uint32_t... fieldIds>
+struct FieldProjection
+{
+    typedef std::integer_sequence<uint32_t, fieldIds...> FieldIds;
+};
+
+template<class T>
+struct IsFieldProjection : std::false_type {};
+
+template<uint32_t... fieldIds>
+struct IsFieldProjection<FieldProjection<fieldIds...>> : std::true_type {};
+
 class Reflection
 {
 protected:
-    template<size_t offset>
+    template<class ReflectableClass>
+    using FieldIndexes = std::make_integer_sequence<uint32_t, ReflectableClass::ReflectableFields::COUNT_OF_FIELDS>;
+
+    //
+    //  Operations over all fields are fold expressions over index sequence of
+    //  the fields (see FieldIndexes), && folds stop on the first false result
+    //
     struct FieldsIterator
     {
         //
         //    Fields visiting
         //
-        template<class ReflectableClass, class VisitorClass>
-        typename std::enable_if_t<offset < ReflectableClass::ReflectableFields::COUNT_OF_FIELDS, bool>
-            static inline VisitFields(ReflectableClass& obj, VisitorClass& visitor)
+        template<class ReflectableClass, class VisitorClass, uint32_t... Index>
+        static inline bool VisitFields(ReflectableClass& obj, VisitorClass& visitor, std::integer_sequence<uint32_t, Index...>)
         {
-            if (!visitor.VisitField(GetFieldName<offset>(obj), GetFieldValue<offset>(obj)))
-                return false;
+            return (visitor.VisitField(GetFieldName<Index>(obj), GetFieldValue<Index>(obj)) && ...);
+        }
+
 
-            return FieldsIterator<offset + 1>::VisitFields(obj, visitor);
+        //
+        //    Equal (over field groups, see FieldGroups)
+        //
+        template<class ReflectableClass, uint32_t... Group>
+        static inline bool Equal(const ReflectableClass& obj1, const ReflectableClass& obj2, std::integer_sequence<uint32_t, Group...>)
+        {
+            typedef FieldGroups<ReflectableClass> Groups;
+            return (EqualGroup<Groups::bounds[Group], Groups::bounds[Group + 1]>(obj1, obj2) && ...);
         }
 
-        template<class ReflectableClass, class VisitorClass>
-        typename std::enable_if_t<offset >= ReflectableClass::ReflectableFields::COUNT_OF_FIELDS, bool>
-            static inline VisitFields(ReflectableClass& obj, VisitorClass& visitor)
+
+        //
+        //    Compare (over field groups, see FieldGroups)
+        //
+        template<class ReflectableClass, uint32_t... Group>
+        static inline int Compare(const ReflectableClass& obj1, const ReflectableClass& obj2, std::integer_sequence<uint32_t, Group...>)
         {
-            return true;
+            typedef FieldGroups<ReflectableClass> Groups;
+            int result = 0;
+            (void)(((result = CompareGroup<Groups::bounds[Group], Groups::bounds[Group + 1]>(obj1, obj2)) == 0) && ...);
+            return result;
         }
 
 
         //
-        //    Equal
+        //    Copy
         //
-        template<class ReflectableClass>
-        typename std::enable_if_t<offset < ReflectableClass::ReflectableFields::COUNT_OF_FIELDS, bool>
-            static inline Equal(const ReflectableClass& obj1, const ReflectableClass& obj2)
+        template<class ReflectableClass, uint32_t... Index>
+        static inline void Copy(ReflectableClass& target, const ReflectableClass& source, std::integer_sequence<uint32_t, Index...>)
         {
-            if (!(GetFieldValue<offset>(obj1) == GetFieldValue<offset>(obj2)))
-                return false;
+            ((GetFieldValue<Index>(target) = GetFieldValue<Index>(source)), ...);
+        }
 
-            return FieldsIterator<offset + 1>::Equal(obj1, obj2);
+
+        //
+        //    Move
+        //
+        template<class ReflectableClass, uint32_t... Index>
+        static inline void Move(ReflectableClass& target, ReflectableClass& source, std::integer_sequence<uint32_t, Index...>)
+        {
+            ((GetFieldValue<Index>(target) = std::move(GetFieldValue<Index>(source))), ...);
         }
 
-        template<class ReflectableClass>
-        typename std::enable_if_t<offset >= ReflectableClass::ReflectableFields::COUNT_OF_FIELDS, bool>
-            static inline Equal(const ReflectableClass& obj1, const ReflectableClass& obj2)
+
+        //
+        //    Hash
+        //
+        template<class HasherT, class ReflectableClass, uint32_t... Index>
+        static inline void Hash(HasherT& hasher, const ReflectableClass& obj, std::integer_sequence<uint32_t, Index...>)
         {
-            return true;
+            HashRun run;
+            (HashField(hasher, run, GetFieldValue<Index>(obj)), ...);
+            FlushHashRun(hasher, run);
         }
 
 
         //
-        //    Less
+        //    Equal and Compare of projection, field by field
         //
-        template<class ReflectableClass>
-        typename std::enable_if_t<offset < ReflectableClass::ReflectableFields::COUNT_OF_FIELDS, bool>
-            static inline Less(const ReflectableClass& obj1, const ReflectableClass& obj2)
+        template<class ReflectableClass, uint32_t... Index>
+        static inline bool EqualProjection(const ReflectableClass& obj1, const ReflectableClass& obj2, std::integer_sequence<uint32_t, Index...>)
         {
-            if (!(GetFieldValue<offset>(obj1) < GetFieldValue<offset>(obj2)))
-                return false;
+            return (EqualValue(GetFieldValue<Index>(obj1), GetFieldValue<Index>(obj2)) && ...);
+        }
 
-            return FieldsIterator<offset + 1>::Less(obj1, obj2);
+        template<class ReflectableClass, uint32_t... Index>
+        static inline int CompareProjection(const ReflectableClass& obj1, const ReflectableClass& obj2, std::integer_sequence<uint32_t, Index...>)
+        {
+            int result = 0;
+            (void)(((result = CompareValue(GetFieldValue<Index>(obj1), GetFieldValue<Index>(obj2))) == 0) && ...);
+            return result;
         }
+    }; // class FieldsIterator
 
-        template<class ReflectableClass>
-        typename std::enable_if_t<offset >= ReflectableClass::ReflectableFields::COUNT_OF_FIELDS, bool>
-            static inline Less(const ReflectableClass& obj1, const ReflectableClass& obj2)
+    template <typename... Ts> using void_t = void;
+
+    template <typename T, typename = void>
+    struct HasClassReflectableFields : std::false_type {};
+
+    template <typename T>
+    struct HasClassReflectableFields<T, void_t<typename T::ReflectableFields>> : std::true_type {};
+
+    //
+    //  Types, which values are equal if and only if their bytes are equal
+    //
+    template<class T>
+    struct IsBytewise : std::integral_constant<bool, (std::is_integral<T>::value || std::is_enum<T>::value
+        || std::is_pointer<T>::value) && std::has_unique_object_representations<T>::value> {};
+
+    template <typename T, typename = void>
+    struct IsRange : std::false_type {};
+
+    template <typename T>
+    struct IsRange<T, std::void_t<decltype(std::declval<const T&>().begin()), decltype(std::declval<const T&>().end())>>
+        : std::true_type {};
+
+    template <typename T, typename = void>
+    struct IsContiguousRange : std::false_type {};
+
+    template <typename T>
+    struct IsContiguousRange<T, std::void_t<decltype(std::declval<const T&>().data()), decltype(std::declval<const T&>().size())>>
+        : std::true_type {};
+
+    template <typename T, typename = void>
+    struct IsUnorderedRange : std::false_type {};
+
+    template <typename T>
+    struct IsUnorderedRange<T, std::void_t<typename T::hasher>> : std::true_type {};
+
+    template <typename T, typename = void>
+    struct IsTupleLike : std::false_type {};
+
+    template <typename T>
+    struct IsTupleLike<T, std::void_t<decltype(std::tuple_size<T>::value)>> : std::true_type {};
+
+    template <typename T, typename = void>
+    struct IsSmartPointer : std::false_type {};
+
+    template <typename T>
+    struct IsSmartPointer<T, std::void_t<typename T::element_type, decltype(std::declval<const T&>().get())>> : std::true_type {};
+
+    template <typename T, typename = void>
+    struct IsString : std::false_type {};
+
+    template <typename T>
+    struct IsString<T, std::void_t<typename T::traits_type>> : std::true_type {};
+
+    //
+    //  Hashing (see Hashing.h). Byte stream hashers get adjacent bytewise
+    //  fields (HashRun) and contiguous containers of them as single blocks.
+    //  Hash is consistent with Equal: floating point zeros are normalized,
+    //  unordered containers are hashed independently of order and smart
+    //  pointers are hashed by address.
+    //
+    struct HashRun
+    {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+    };
+
+    template<class HasherT>
+    static inline void FlushHashRun(HasherT& hasher, HashRun& run)
+    {
+        if constexpr(HasherT::BYTE_STREAM)
         {
-            return true;
+            if(run.begin != run.end)
+                hasher.Update(run.begin, run.end - run.begin);
+            run.begin = run.end = nullptr;
+        }
+    }
+
+    template<class HasherT, class T>
+    static inline void HashField(HasherT& hasher, HashRun& run, const T& value)
+    {
+        if constexpr(!HasherT::BYTE_STREAM)
+        {
+            if constexpr(IsReflectable<T>())
+                hasher.Combine(Hash<T, HasherT>(value));
+            else
+                hasher.Combine(value);
+        }
+        else if constexpr(IsBytewise<T>::value)
+        {
+            const char* data = reinterpret_cast<const char*>(&value);
+            if(run.end != data)
+            {
+                FlushHashRun(hasher, run);
+                run.begin = data;
+            }
+            run.end = data + sizeof(T);
+        }
+        else
+        {
+            FlushHashRun(hasher, run);
+            HashValue(hasher, value);
         }
+    }
 
+    template<class HasherT, class T, size_t... Index>
+    static inline void HashTuple(HasherT& hasher, const T& value, std::index_sequence<Index...>)
+    {
+        (HashValue(hasher, std::get<Index>(value)), ...);
+    }
 
-        //
-        //    Copy
-        //
-        template<class ReflectableClass>
-        typename std::enable_if_t<offset < ReflectableClass::ReflectableFields::COUNT_OF_FIELDS, void>
-            static inline Copy(ReflectableClass& target, const ReflectableClass& source)
+    template<class HasherT, class T>
+    static inline void HashValue(HasherT& hasher, const T& value)
+    {
+        if constexpr(IsBytewise<T>::value)
+            hasher.Update(&value, sizeof(T));
+        else if constexpr(std::is_floating_point<T>::value)
+        {
+            const double normalized = value == 0 ? 0.0 : static_cast<double>(value);
+            hasher.Update(&normalized, sizeof(normalized));
+        }
+        else if constexpr(IsReflectable<T>())
+            FieldsIterator::Hash(hasher, value, FieldIndexes<T>());
+        else if constexpr(IsRange<T>::value)
+        {
+            typedef std::decay_t<decltype(*value.begin())> ItemT;
+            if constexpr(IsUnorderedRange<T>::value)
+            {
+                uint64_t count = 0;
+                uint64_t sum = 0;
+                for(const auto& item : value)
+                {
+                    HasherT itemHasher;
+                    HashValue(itemHasher, item);
+                    sum += itemHasher.Result();
+                    ++count;
+                }
+                hasher.Update(&count, sizeof(count));
+                hasher.Update(&sum, sizeof(sum));
+            }
+            else if constexpr(IsContiguousRange<T>::value && IsBytewise<ItemT>::value)
+            {
+                const uint64_t count = value.size();
+                hasher.Update(&count, sizeof(count));
+                hasher.Update(value.data(), count * sizeof(ItemT));
+            }
+            else
+            {
+                uint64_t count = 0;
+                for(const auto& item : value)
+                {
+                    HashValue(hasher, item);
+                    ++count;
+                }
+                hasher.Update(&count, sizeof(count));
+            }
+        }
+        else if constexpr(IsTupleLike<T>::value)
+            HashTuple(hasher, value, std::make_index_sequence<std::tuple_size<T>::value>());
+        else if constexpr(IsSmartPointer<T>::value)
         {
-            GetFieldValue<offset>(target) = GetFieldValue<offset>(source);
-            FieldsIterator<offset + 1>::Copy(target, source);
+            const void* pointer = value.get();
+            hasher.Update(&pointer, sizeof(pointer));
         }
+        else if constexpr(std::is_invocable_r<size_t, std::hash<T>, const T&>::value)
+        {
+            const size_t hash = std::hash<T>()(value);
+            hasher.Update(&hash, sizeof(hash));
+        }
+        else
+        {
+            const size_t hash = boost::hash<T>()(value);
+            hasher.Update(&hash, sizeof(hash));
+        }
+    }
 
-        template<class ReflectableClass>
-        typename std::enable_if_t<offset >= ReflectableClass::ReflectableFields::COUNT_OF_FIELDS, void>
-            static inline Copy(ReflectableClass& target, const ReflectableClass& source)
+    //
+    //  Comparison. FieldGroups splits fields into groups: consecutive bytewise
+    //  fields make one group, any other field makes a group of its own. Groups
+    //  of bytewise fields, which are adjacent in memory, are checked for
+    //  equality with single memcmp call, and only differing groups are
+    //  compared field by field.
+    //
+    template<class ReflectableClass>
+    class FieldGroups
+    {
+        static constexpr uint32_t COUNT_OF_FIELDS = ReflectableClass::ReflectableFields::COUNT_OF_FIELDS;
+
+        template<uint32_t... Index>
+        static constexpr std::array<bool, COUNT_OF_FIELDS> GetBytewise(std::integer_sequence<uint32_t, Index...>)
         {
+            return {{ IsBytewise<std::decay_t<decltype(GetFieldValue<Index>(std::declval<ReflectableClass&>()))>>::value... }};
         }
 
+        static constexpr std::array<bool, COUNT_OF_FIELDS> bytewise = GetBytewise(FieldIndexes<ReflectableClass>());
 
-        //
-        //    Move
-        //
-        template<class ReflectableClass>
-        typename std::enable_if_t<offset < ReflectableClass::ReflectableFields::COUNT_OF_FIELDS, void>
-            static inline Move(ReflectableClass& target, ReflectableClass& source)
+        static constexpr bool IsGroupStart(uint32_t fieldId)
         {
-            GetFieldValue<offset>(target) = std::move(GetFieldValue<offset>(source));
-            FieldsIterator<offset + 1>::Move(target, source);
+            return fieldId == 0 || !bytewise[fieldId] || !bytewise[fieldId - 1];
         }
 
-        template<class ReflectableClass>
-        typename std::enable_if_t<offset >= ReflectableClass::ReflectableFields::COUNT_OF_FIELDS, void>
-            static inline Move(ReflectableClass& target, ReflectableClass& source)
+        static constexpr uint32_t GetCount()
         {
+            uint32_t count = 0;
+            for(uint32_t i = 0; i < COUNT_OF_FIELDS; ++i)
+                count += IsGroupStart(i) ? 1 : 0;
+            return count;
         }
 
+    public:
+        static constexpr uint32_t COUNT = GetCount();
 
-        //
-        //    Hash
-        //
-        template<class ReflectableClass>
-        typename std::enable_if_t<offset < ReflectableClass::ReflectableFields::COUNT_OF_FIELDS, void>
-            static inline Hash(size_t& seed, const ReflectableClass& obj)
+    private:
+        static constexpr std::array<uint32_t, COUNT + 1> GetBounds()
         {
-            boost::hash_combine(seed, GetFieldValue<offset>(obj));
+            std::array<uint32_t, COUNT + 1> bounds {};
+            uint32_t count = 0;
+            for(uint32_t i = 0; i < COUNT_OF_FIELDS; ++i)
+            {
+                if(IsGroupStart(i))
+                    bounds[count++] = i;
+            }
+            bounds[COUNT] = COUNT_OF_FIELDS;
+            return bounds;
         }
 
-        template<class ReflectableClass>
-        typename std::enable_if_t<offset >= ReflectableClass::ReflectableFields::COUNT_OF_FIELDS, void>
-            static inline Hash(size_t& seed, const ReflectableClass& obj)
+    public:
+        static constexpr std::array<uint32_t, COUNT + 1> bounds = GetBounds();
+
+        static constexpr bool IsBytewiseGroup(uint32_t begin, uint32_t end)
         {
+            return end - begin > 1 && bytewise[begin];
         }
-    }; // class FieldsIterator
+    };
 
-    template <typename... Ts> using void_t = void;
+    template<class ReflectableClass>
+    using FieldGroupIndexes = std::make_integer_sequence<uint32_t, FieldGroups<ReflectableClass>::COUNT>;
+
+    template<uint32_t begin, class ReflectableClass, uint32_t... Offset>
+    static inline bool IsContiguous(const ReflectableClass& obj, std::integer_sequence<uint32_t, Offset...>)
+    {
+        return ((reinterpret_cast<const char*>(&GetFieldValue<begin + Offset>(obj)) + sizeof(GetFieldValue<begin + Offset>(obj))
+            == reinterpret_cast<const char*>(&GetFieldValue<begin + Offset + 1>(obj))) && ...);
+    }
+
+    //
+    //  Returns true if group of bytewise fields [begin, end) is adjacent in
+    //  memory and has the same bytes in both objects
+    //
+    template<uint32_t begin, uint32_t end, class ReflectableClass>
+    static inline bool IsGroupBytewiseEqual(const ReflectableClass& obj1, const ReflectableClass& obj2)
+    {
+        const char* data1 = reinterpret_cast<const char*>(&GetFieldValue<begin>(obj1));
+        const char* data2 = reinterpret_cast<const char*>(&GetFieldValue<begin>(obj2));
+        const char* end1 = reinterpret_cast<const char*>(&GetFieldValue<end - 1>(obj1)) + sizeof(GetFieldValue<end - 1>(obj1));
+        return IsContiguous<begin>(obj1, std::make_integer_sequence<uint32_t, end - begin - 1>())
+            && memcmp(data1, data2, end1 - data1) == 0;
+    }
+
+    template<uint32_t begin, uint32_t end, class ReflectableClass>
+    static inline bool EqualGroup(const ReflectableClass& obj1, const ReflectableClass& obj2)
+    {
+        if constexpr(FieldGroups<ReflectableClass>::IsBytewiseGroup(begin, end))
+        {
+            if(IsContiguous<begin>(obj1, std::make_integer_sequence<uint32_t, end - begin - 1>()))
+                return IsGroupBytewiseEqual<begin, end>(obj1, obj2);
+        }
+        return EqualFields<begin>(obj1, obj2, std::make_integer_sequence<uint32_t, end - begin>());
+    }
+
+    template<uint32_t begin, class ReflectableClass, uint32_t... Offset>
+    static inline bool EqualFields(const ReflectableClass& obj1, const ReflectableClass& obj2, std::integer_sequence<uint32_t, Offset...>)
+    {
+        return (EqualValue(GetFieldValue<begin + Offset>(obj1), GetFieldValue<begin + Offset>(obj2)) && ...);
+    }
+
+    template<uint32_t begin, uint32_t end, class ReflectableClass>
+    static inline int CompareGroup(const ReflectableClass& obj1, const ReflectableClass& obj2)
+    {
+        if constexpr(FieldGroups<ReflectableClass>::IsBytewiseGroup(begin, end))
+        {
+            if(IsGroupBytewiseEqual<begin, end>(obj1, obj2))
+                return 0;
+        }
+        return CompareFields<begin>(obj1, obj2, std::make_integer_sequence<uint32_t, end - begin>());
+    }
+
+    template<uint32_t begin, class ReflectableClass, uint32_t... Offset>
+    static inline int CompareFields(const ReflectableClass& obj1, const ReflectableClass& obj2, std::integer_sequence<uint32_t, Offset...>)
+    {
+        int result = 0;
+        (void)(((result = CompareValue(GetFieldValue<begin + Offset>(obj1), GetFieldValue<begin + Offset>(obj2))) == 0) && ...);
+        return result;
+    }
+
+    template<class T, size_t... Index>
+    static inline bool EqualTuple(const T& value1, const T& value2, std::index_sequence<Index...>)
+    {
+        return (EqualValue(std::get<Index>(value1), std::get<Index>(value2)) && ...);
+    }
+
+    template<class T>
+    static inline bool EqualValue(const T& value1, const T& value2)
+    {
+        if constexpr(IsReflectable<T>())
+            return Equal(value1, value2);
+        else if constexpr(IsRange<T>::value && !IsUnorderedRange<T>::value && !IsString<T>::value)
+        {
+            typedef std::decay_t<decltype(*value1.begin())> ItemT;
+            if constexpr(IsContiguousRange<T>::value && IsBytewise<ItemT>::value)
+            {
+                return value1.size() == value2.size()
+                    && (value1.size() == 0 || memcmp(value1.data(), value2.data(), value1.size() * sizeof(ItemT)) == 0);
+            }
+            else
+            {
+                auto item1 = value1.begin();
+                auto item2 = value2.begin();
+                for(; item1 != value1.end() && item2 != value2.end(); ++item1, ++item2)
+                {
+                    if(!EqualValue<ItemT>(*item1, *item2))
+                        return false;
+                }
+                return item1 == value1.end() && item2 == value2.end();
+            }
+        }
+        else if constexpr(IsTupleLike<T>::value && !IsRange<T>::value)
+            return EqualTuple(value1, value2, std::make_index_sequence<std::tuple_size<T>::value>());
+        else
+            return value1 == value2;
+    }
+
+    template<class T, size_t... Index>
+    static inline int CompareTuple(const T& value1, const T& value2, std::index_sequence<Index...>)
+    {
+        int result = 0;
+        (void)(((result = CompareValue(std::get<Index>(value1), std::get<Index>(value2))) == 0) && ...);
+        return result;
+    }
+
+    template<class T>
+    static inline int CompareValue(const T& value1, const T& value2)
+    {
+        if constexpr(IsReflectable<T>())
+            return Compare(value1, value2);
+        else if constexpr(std::is_pointer<T>::value)
+            return std::less<T>()(value2, value1) - std::less<T>()(value1, value2);
+        else if constexpr(std::is_arithmetic<T>::value || std::is_enum<T>::value)
+            return (value2 < value1) - (value1 < value2);
+        else if constexpr(IsString<T>::value)
+        {
+            const int result = value1.compare(value2);
+            return (result > 0) - (result < 0);
+        }
+        else if constexpr(IsRange<T>::value)
+        {
+            static_assert(!IsUnorderedRange<T>::value, "Unordered containers can't be ordered");
+            typedef std::decay_t<decltype(*value1.begin())> ItemT;
+            auto item1 = value1.begin();
+            auto item2 = value2.begin();
+            for(; item1 != value1.end() && item2 != value2.end(); ++item1, ++item2)
+            {
+                if(const int result = CompareValue<ItemT>(*item1, *item2))
+                    return result;
+            }
+            return (item2 == value2.end()) - (item1 == value1.end());
+        }
+        else if constexpr(IsTupleLike<T>::value)
+            return CompareTuple(value1, value2, std::make_index_sequence<std::tuple_size<T>::value>());
+        else if constexpr(IsSmartPointer<T>::value)
+            return CompareValue(value1.get(), value2.get());
+        else
+            return (value2 < value1) - (value1 < value2);
+    }
+
+    template<class T, uint32_t fieldId>
+    struct FieldTypeOf
+    {
+        typedef std::decay_t<decltype(T::template ReflectableFieldDefinition<fieldId, T>::GetFieldValue(std::declval<T&>()))> type;
+    };
 
     template <typename T, typename = void>
-    struct HasClassReflectableFields : std::false_type {};
+    struct HasClassSerializableFields : std::false_type {};
 
     template <typename T>
-    struct HasClassReflectableFields<T, void_t<typename T::ReflectableFields>> : std::true_type {};
+    struct HasClassSerializableFields<T, void_t<typename T::SerializableFields>> : std::true_type {};
+
+    //
+    //  Field lookup by name. FieldNameIndex is a minimal perfect hash of the
+    //  field names built at compile time with "hash and displace" method:
+    //  name hash selects a bucket, and displacement of the bucket is chosen
+    //  so that all names of the bucket get distinct slots. Lookup takes one
+    //  pass over the name to hash it and one comparison to verify it.
+    //
+    static constexpr uint64_t HashFieldName(std::string_view name)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for(char c : name)
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static constexpr uint32_t GetFieldNameSlot(uint64_t hash, uint32_t displacement, uint32_t count)
+    {
+        hash ^= displacement * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+        return static_cast<uint32_t>(hash % count);
+    }
+
+    template<class ReflectableClass>
+    class FieldNameIndex
+    {
+        static constexpr uint32_t COUNT_OF_FIELDS = ReflectableClass::ReflectableFields::COUNT_OF_FIELDS;
+
+        template<uint32_t... Index>
+        static constexpr std::array<std::string_view, COUNT_OF_FIELDS> GetNames(std::integer_sequence<uint32_t, Index...>)
+        {
+            return {{ std::string_view(GetFieldName<ReflectableClass, Index>())... }};
+        }
+
+        struct Table
+        {
+            uint32_t displacements[COUNT_OF_FIELDS] {};
+            uint32_t fieldIds[COUNT_OF_FIELDS] {};
+            bool valid = true;
+        };
+
+        static constexpr Table Build()
+        {
+            Table table;
+            uint32_t buckets[COUNT_OF_FIELDS] {};
+            uint32_t bucketSizes[COUNT_OF_FIELDS] {};
+            bool usedSlots[COUNT_OF_FIELDS] {};
+            for(uint32_t i = 0; i < COUNT_OF_FIELDS; ++i)
+            {
+                buckets[i] = GetFieldNameSlot(HashFieldName(names[i]), 0, COUNT_OF_FIELDS);
+                ++bucketSizes[buckets[i]];
+            }
+
+            //  Place the largest buckets first, while most of the slots are free
+            for(uint32_t size = COUNT_OF_FIELDS; size > 0; --size)
+            {
+                for(uint32_t bucket = 0; bucket < COUNT_OF_FIELDS; ++bucket)
+                {
+                    if(bucketSizes[bucket] != size)
+                        continue;
+
+                    bool placed = false;
+                    for(uint32_t displacement = 1; !placed && displacement < 1000000; ++displacement)
+                    {
+                        uint32_t slots[COUNT_OF_FIELDS] {};
+                        uint32_t count = 0;
+                        placed = true;
+                        for(uint32_t i = 0; placed && i < COUNT_OF_FIELDS; ++i)
+                        {
+                            if(buckets[i] != bucket)
+                                continue;
+
+                            const uint32_t slot = GetFieldNameSlot(HashFieldName(names[i]), displacement, COUNT_OF_FIELDS);
+                            for(uint32_t j = 0; j < count; ++j)
+                                placed = placed && slots[j] != slot;
+                            placed = placed && !usedSlots[slot];
+                            slots[count++] = slot;
+                        }
+
+                        if(!placed)
+                            continue;
+
+                        table.displacements[bucket] = displacement;
+                        count = 0;
+                        for(uint32_t i = 0; i < COUNT_OF_FIELDS; ++i)
+                        {
+                            if(buckets[i] != bucket)
+                                continue;
+
+                            usedSlots[slots[count]] = true;
+                            table.fieldIds[slots[count++]] = i;
+                        }
+                    }
+                    table.valid = table.valid && placed;
+                }
+            }
+            return table;
+        }
+
+        static constexpr std::array<std::string_view, COUNT_OF_FIELDS> names =
+            GetNames(std::make_integer_sequence<uint32_t, COUNT_OF_FIELDS>());
+
+        static constexpr Table table = Build();
+
+        static_assert(table.valid, "Failed to build perfect hash of field names");
+
+    public:
+        static constexpr uint32_t Find(std::string_view name)
+        {
+            const uint64_t hash = HashFieldName(name);
+            const uint32_t bucket = GetFieldNameSlot(hash, 0, COUNT_OF_FIELDS);
+            const uint32_t fieldId = table.fieldIds[GetFieldNameSlot(hash, table.displacements[bucket], COUNT_OF_FIELDS)];
+            return names[fieldId] == name ? fieldId : COUNT_OF_FIELDS;
+        }
+    };
+
+    template<uint32_t fieldId, class ReflectableClass, class VisitorClass>
+    static bool VisitFieldAt(ReflectableClass& obj, VisitorClass& visitor)
+    {
+        return visitor.VisitField(GetFieldName<fieldId>(obj), GetFieldValue<fieldId>(obj));
+    }
+
+    template<class ReflectableClass, class VisitorClass, uint32_t... Index>
+    static bool VisitFieldById(ReflectableClass& obj, uint32_t fieldId, VisitorClass& visitor,
+        std::integer_sequence<uint32_t, Index...>)
+    {
+        typedef bool (*VisitFunction)(ReflectableClass&, VisitorClass&);
+        static constexpr VisitFunction functions[] = { &VisitFieldAt<Index, ReflectableClass, VisitorClass>... };
+        return functions[fieldId](obj, visitor);
+    }
+
+    template<class FieldT>
+    class FieldAssignVisitor
+    {
+        FieldT&& _value;
+
+    public:
+        bool assigned = false;
+
+        FieldAssignVisitor(FieldT&& value) : _value(std::forward<FieldT>(value)) {}
+
+        //
+        //  Implicit conversion is required, since assignment alone accepts
+        //  e.g. int for std::string as a single char
+        //
+        template<class T>
+        bool VisitField(const char* /*fieldName*/, T& value)
+        {
+            if constexpr(std::is_convertible<FieldT&&, T>::value && std::is_assignable<T&, FieldT&&>::value)
+            {
+                value = std::forward<FieldT>(_value);
+                assigned = true;
+            }
+            return assigned;
+        }
+    };
 
 public:
 
@@ -211,12 +764,34 @@ public:
         return IsReflectable<ReflectableClass>();
     }
 
+    //
+    //  Serializable classes are reflectable classes declared with
+    //  REFLECTABLE_SERIALIZABLE_FIELDS (see Serialization.h)
+    //
+    template<class ReflectableClass>
+    static constexpr bool IsSerializable()
+    {
+        return IsReflectable<ReflectableClass>() && HasClassSerializableFields<ReflectableClass>::value;
+    }
+
+    template<class ReflectableClass>
+    static constexpr bool IsSerializable(const ReflectableClass& obj)
+    {
+        return IsSerializable<ReflectableClass>();
+    }
+
     template<const int fieldId, class T>
     static inline auto& GetFieldValue(T& obj)
     {
         return T::template ReflectableFieldDefinition<fieldId, T>::GetFieldValue(obj);
     }
 
+    //
+    //  Declared type of the field, e.g. Reflection::FieldType<T, Reflection::FindFieldId<T>("name")>
+    //
+    template<class T, const uint32_t fieldId>
+    using FieldType = typename FieldTypeOf<T, fieldId>::type;
+
     template<class T, const uint32_t fieldId>
     static inline constexpr const char* const GetFieldName()
     {
@@ -259,6 +834,49 @@ public:
         GetFieldValue<fieldId>(obj) = std::forward<FieldT>(fieldValue);
     }
 
+    //
+    //  Returns id of the field with the given name or GetFieldCount<T>() if
+    //  there is no such field. Lookup time doesn't depend on count of fields.
+    //
+    template<class T>
+    static constexpr uint32_t FindFieldId(std::string_view name)
+    {
+        return FieldNameIndex<std::remove_const_t<T>>::Find(name);
+    }
+
+    //
+    //  Calls visitor.VisitField(fieldName, value) for the field with runtime
+    //  id. Returns false if there is no such field, otherwise result of
+    //  VisitField.
+    //
+    template<class ReflectableClass, class VisitorClass>
+    static bool VisitFieldById(ReflectableClass& obj, uint32_t fieldId, VisitorClass& visitor)
+    {
+        if(fieldId >= GetFieldCount<ReflectableClass>())
+            return false;
+
+        return VisitFieldById(obj, fieldId, visitor,
+            std::make_integer_sequence<uint32_t, GetFieldCount<ReflectableClass>()>());
+    }
+
+    template<class ReflectableClass, class VisitorClass>
+    static bool VisitFieldByName(ReflectableClass& obj, std::string_view name, VisitorClass& visitor)
+    {
+        return VisitFieldById(obj, FindFieldId<ReflectableClass>(name), visitor);
+    }
+
+    //
+    //  Assigns value to the field with the given name. Returns false if there
+    //  is no such field or the value can't be assigned to it.
+    //
+    template<class ReflectableClass, class FieldT>
+    static bool SetFieldByName(ReflectableClass& obj, std::string_view name, FieldT&& fieldValue)
+    {
+        FieldAssignVisitor<FieldT> visitor(std::forward<FieldT>(fieldValue));
+        VisitFieldByName(obj, name, visitor);
+        return visitor.assigned;
+    }
+
     //
     //  VisitFields iterate through all reflectable fields in the class and
     //  calls the function, with the following signature:
@@ -267,7 +885,8 @@ public:
     template<class ReflectableClass, class VisitorClass>
     static bool VisitFields(ReflectableClass& obj, VisitorClass& visitor)
     {
-        return FieldsIterator<0>::VisitFields(obj, visitor);
+        VKLIB_INSTRUMENT(ReflectableClass, VisitFields);
+        return FieldsIterator::VisitFields(obj, visitor, FieldIndexes<ReflectableClass>());
     }
 
     template<class ReflectableClass>
@@ -279,7 +898,7 @@ public:
         if (obj1 == nullptr || obj2 == nullptr)
             return false;
 
-        return FieldsIterator<0>::Equal(*obj1, *obj2);
+        return Equal(*obj1, *obj2);
     }
 
     template<class ReflectableClass>
@@ -288,34 +907,122 @@ public:
         if (&obj1 == &obj2)
             return true;
 
-        return FieldsIterator<0>::Equal(obj1, obj2);
+        return FieldsIterator::Equal(obj1, obj2, FieldGroupIndexes<ReflectableClass>());
+    }
+
+    //
+    //  Compares two values of any field type the same way Equal compares
+    //  fields: reflectable classes field by field, containers element by
+    //  element
+    //
+    template<class T>
+    static bool EqualValues(const T& value1, const T& value2)
+    {
+        return EqualValue(value1, value2);
+    }
+
+    //
+    //  Three-way lexicographical comparison of the fields. Returns negative
+    //  value if obj1 is less than obj2, 0 if they are equivalent and positive
+    //  value otherwise. Each field is compared at most once.
+    //
+    template<class ReflectableClass>
+    static int Compare(const ReflectableClass& obj1, const ReflectableClass& obj2)
+    {
+        if (&obj1 == &obj2)
+            return 0;
+
+        return FieldsIterator::Compare(obj1, obj2, FieldGroupIndexes<ReflectableClass>());
     }
 
     template<class ReflectableClass>
     static bool Less(const ReflectableClass& obj1, const ReflectableClass& obj2)
     {
-        return FieldsIterator<0>::Less(obj1, obj2);
+        return Compare(obj1, obj2) < 0;
     }
 
-    template<class ReflectableClass>
+    //
+    //  Feeds all fields of the object into hasher (see Hashing.h)
+    //
+    template<class ReflectableClass, class HasherT>
+    static void Hash(const ReflectableClass& obj, HasherT& hasher)
+    {
+        FieldsIterator::Hash(hasher, obj, FieldIndexes<ReflectableClass>());
+    }
+
+    template<class ReflectableClass, class HasherT = WyHasher>
     static size_t Hash(const ReflectableClass& obj)
     {
-        size_t seed = 0;
-        FieldsIterator<0>::Hash(seed, obj);
-        return seed;
+        HasherT hasher;
+        Hash(obj, hasher);
+        return hasher.Result();
     }
 
     template<class ReflectableClass>
     static void Copy(ReflectableClass& target, const ReflectableClass& source)
     {
-        FieldsIterator<0>::Copy(target, source);
+        FieldsIterator::Copy(target, source, FieldIndexes<ReflectableClass>());
+    }
+
+    //
+    //  Operations over projection (see FieldProjection), e.g.
+    //  Reflection::Hash<Record::Key>(record)
+    //
+    template<class ProjectionT, class ReflectableClass, class VisitorClass>
+    static std::enable_if_t<IsFieldProjection<ProjectionT>::value, bool> VisitFields(ReflectableClass& obj, VisitorClass& visitor)
+    {
+        return FieldsIterator::VisitFields(obj, visitor, typename ProjectionT::FieldIds());
+    }
+
+    template<class ProjectionT, class ReflectableClass>
+    static std::enable_if_t<IsFieldProjection<ProjectionT>::value, bool> Equal(const ReflectableClass& obj1, const ReflectableClass& obj2)
+    {
+        if (&obj1 == &obj2)
+            return true;
+
+        return FieldsIterator::EqualProjection(obj1, obj2, typename ProjectionT::FieldIds());
+    }
+
+    template<class ProjectionT, class ReflectableClass>
+    static std::enable_if_t<IsFieldProjection<ProjectionT>::value, int> Compare(const ReflectableClass& obj1, const ReflectableClass& obj2)
+    {
+        if (&obj1 == &obj2)
+            return 0;
+
+        return FieldsIterator::CompareProjection(obj1, obj2, typename ProjectionT::FieldIds());
+    }
+
+    template<class ProjectionT, class ReflectableClass>
+    static std::enable_if_t<IsFieldProjection<ProjectionT>::value, bool> Less(const ReflectableClass& obj1, const ReflectableClass& obj2)
+    {
+        return Compare<ProjectionT>(obj1, obj2) < 0;
+    }
+
+    template<class ProjectionT, class ReflectableClass, class HasherT>
+    static std::enable_if_t<IsFieldProjection<ProjectionT>::value> Hash(const ReflectableClass& obj, HasherT& hasher)
+    {
+        FieldsIterator::Hash(hasher, obj, typename ProjectionT::FieldIds());
+    }
+
+    template<class ProjectionT, class HasherT = WyHasher, class ReflectableClass>
+    static std::enable_if_t<IsFieldProjection<ProjectionT>::value, size_t> Hash(const ReflectableClass& obj)
+    {
+        HasherT hasher;
+        Hash<ProjectionT>(obj, hasher);
+        return hasher.Result();
+    }
+
+    template<class ProjectionT, class ReflectableClass>
+    static std::enable_if_t<IsFieldProjection<ProjectionT>::value> Copy(ReflectableClass& target, const ReflectableClass& source)
+    {
+        FieldsIterator::Copy(target, source, typename ProjectionT::FieldIds());
     }
 
 
     template<class ReflectableClass>
     static void Move(ReflectableClass& target, ReflectableClass&& source)
     {
-        FieldsIterator<0>::Move(target, source);
+        FieldsIterator::Move(target, source, FieldIndexes<ReflectableClass>());
     }
 };  //  class Reflection
 
@@ -338,17 +1045,95 @@ template<class ReflectableClass>
 typename std::enable_if_t<Reflection::IsReflectable<ReflectableClass>(), bool>
     operator<(const ReflectableClass& obj1, const ReflectableClass& obj2)
 {
-    return !Reflection::Less(obj1, obj2);
+    return Reflection::Less(obj1, obj2);
+}
+
+template<class ReflectableClass>
+typename std::enable_if_t<Reflection::IsReflectable<ReflectableClass>(), bool>
+    operator<=(const ReflectableClass& obj1, const ReflectableClass& obj2)
+{
+    return Reflection::Compare(obj1, obj2) <= 0;
+}
+
+template<class ReflectableClass>
+typename std::enable_if_t<Reflection::IsReflectable<ReflectableClass>(), bool>
+    operator>(const ReflectableClass& obj1, const ReflectableClass& obj2)
+{
+    return Reflection::Compare(obj1, obj2) > 0;
 }
 
 template<class ReflectableClass>
+typename std::enable_if_t<Reflection::IsReflectable<ReflectableClass>(), bool>
+    operator>=(const ReflectableClass& obj1, const ReflectableClass& obj2)
+{
+    return Reflection::Compare(obj1, obj2) >= 0;
+}
+
+template<class ReflectableClass, class HasherT = WyHasher>
 struct Hash : std::enable_if<Reflection::IsReflectable<ReflectableClass>()>
 {
     typedef ReflectableClass argument_type;
     typedef std::size_t result_type;
     result_type operator()(argument_type const& obj) const
     {
-        return Reflection::Hash(obj);
+        return Reflection::Hash<ReflectableClass, HasherT>(obj);
+    }
+};
+
+//
+//  Comparators for standard containers and algorithms, e.g.
+//  std::map<T, V, vklib::Less<T>>, as operators above are not found by
+//  argument dependent lookup for classes declared outside of vklib namespace
+//
+template<class ReflectableClass>
+struct Less : std::enable_if<Reflection::IsReflectable<ReflectableClass>()>
+{
+    bool operator()(const ReflectableClass& obj1, const ReflectableClass& obj2) const
+    {
+        return Reflection::Less(obj1, obj2);
+    }
+};
+
+template<class ReflectableClass>
+struct EqualTo : std::enable_if<Reflection::IsReflectable<ReflectableClass>()>
+{
+    bool operator()(const ReflectableClass& obj1, const ReflectableClass& obj2) const
+    {
+        return Reflection::Equal(obj1, obj2);
+    }
+};
+
+//
+//  Functors over projection, e.g. for containers keyed by some fields:
+//  std::unordered_set<T, ProjectionHash<T::Key>, ProjectionEqualTo<T::Key>>
+//
+template<class ProjectionT, class HasherT = WyHasher>
+struct ProjectionHash
+{
+    template<class ReflectableClass>
+    size_t operator()(const ReflectableClass& obj) const
+    {
+        return Reflection::Hash<ProjectionT, HasherT>(obj);
+    }
+};
+
+template<class ProjectionT>
+struct ProjectionEqualTo
+{
+    template<class ReflectableClass>
+    bool operator()(const ReflectableClass& obj1, const ReflectableClass& obj2) const
+    {
+        return Reflection::Equal<ProjectionT>(obj1, obj2);
+    }
+};
+
+template<class ProjectionT>
+struct ProjectionLess
+{
+    template<class ReflectableClass>
+    bool operator()(const ReflectableClass& obj1, const ReflectableClass& obj2) const
+    {
+        return Reflection::Less<ProjectionT>(obj1, obj2);
     }
 };
 
@@ -421,6 +1206,30 @@ public:
 
 
 #define REFLECTABLE_FIELDS(...)        REFLECTABLE_FIELDS_FROM_SEQ(BOOST_PP_VARIADIC_TO_SEQ(__VA_ARGS__))
+
+//
+//  Marks the class as a part of the binary wire format. Nested reflectable
+//  classes have to be serializable too, so adding a class to the format is
+//  always an explicit decision.
+//
+#define SERIALIZABLE_FIELDS(...)                                                                \
+    class SerializableFields                                                                    \
+    {                                                                                           \
+    };                                                                                          \
+
 #define REFLECTABLE_SERIALIZABLE_FIELDS(...)        REFLECTABLE_FIELDS(__VA_ARGS__)  \
                                                     SERIALIZABLE_FIELDS(__VA_ARGS__)
+
+//
+//  Declares public FieldProjection of the given fields, should follow
+//  REFLECTABLE_FIELDS and leaves the class in private section like it:
+//  FIELD_PROJECTION(Key, id, name);
+//
+#define REFLECTABLE_GENERATE_PROJECTION_FIELD_ID(r, data, i, elem)    BOOST_PP_COMMA_IF(i) REFLECTABLE_FULL_FIELD_ID(elem)
+
+#define FIELD_PROJECTION(name, ...)                                                             \
+    public:                                                                                     \
+    typedef vklib::FieldProjection<BOOST_PP_SEQ_FOR_EACH_I(REFLECTABLE_GENERATE_PROJECTION_FIELD_ID, _, \
+        BOOST_PP_VARIADIC_TO_SEQ(__VA_ARGS__))> name;                                           \
+    private:
 }; //   namespace vklib
@@ -0,0 +1,663 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains compact binary serialization of reflectable classes
+//  declared with REFLECTABLE_SERIALIZABLE_FIELDS (see Reflection.h).
+//  The format is positional and has no field names or type tags:
+//  - arithmetic types and enums are written as is (host byte order);
+//  - strings and dynamic containers are prefixed by LEB128 element count;
+//  - pointers are prefixed by presence byte;
+//  - std::array, pairs, tuples and reflectable classes are written as a
+//    sequence of their elements.
+//  Serialization appends to a caller-supplied buffer (any contiguous container
+//  of bytes with size() and insert(), e.g. std::string or std::vector<char>),
+//  so reusing the buffer between calls doesn't allocate in steady state.
+//  Deserialization reuses strings, containers and pointees of the target
+//  object whenever possible.
+//  E.g.:
+//  std::string buffer;
+//  BinarySerialize(buffer, obj);
+//  bool ok = BinaryDeserialize(buffer, otherObj);
+//
+
+#pragma once
+
+#include "Reflection.h"
+#include <string.h>
+#include <array>
+#include <deque>
+#include <forward_list>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace vklib
+{
+
+template<class T>
+struct IsBinaryTrivial : std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_enum<T>::value> {};
+
+//
+//  DerivedT, if any, can override Visit for some types, nested values of
+//  containers, pointers and classes are visited through it
+//
+template<class BufferT, class DerivedT = void>
+class BinarySerializer
+{
+protected:
+    static_assert(sizeof(typename BufferT::value_type) == 1, "Buffer should be a container of bytes");
+
+    typedef typename BufferT::value_type ByteT;
+    typedef std::conditional_t<std::is_void<DerivedT>::value, BinarySerializer, DerivedT> SelfT;
+
+    BufferT& _buffer;
+
+    SelfT& Self() { return static_cast<SelfT&>(*this); }
+
+    void Write(const void* data, size_t size)
+    {
+        const ByteT* bytes = static_cast<const ByteT*>(data);
+        _buffer.insert(_buffer.end(), bytes, bytes + size);
+    }
+
+    void WriteSize(uint64_t size)
+    {
+        uint8_t bytes[10];
+        size_t count = 0;
+        while(size >= 0x80)
+        {
+            bytes[count++] = static_cast<uint8_t>(size | 0x80);
+            size >>= 7;
+        }
+        bytes[count++] = static_cast<uint8_t>(size);
+        Write(bytes, count);
+    }
+
+    template<class T>
+    void VisitItems(const T& value)
+    {
+        for(const auto& item : value)
+            Self().Visit(item);
+    }
+
+    template<class T>
+    void VisitList(const T& value)
+    {
+        WriteSize(value.size());
+        VisitItems(value);
+    }
+
+    template<class T>
+    void VisitPtr(const T& value)
+    {
+        const uint8_t present = value ? 1 : 0;
+        Write(&present, 1);
+        if(value)
+            Self().Visit(*value);
+    }
+
+    template<class T, size_t... Index>
+    void VisitTuple(const T& value, std::index_sequence<Index...>)
+    {
+        (void)value;
+        int dummy[] = { 0, (Self().Visit(std::get<Index>(value)), 0)... };
+        (void)dummy;
+    }
+
+public:
+    BinarySerializer(BufferT& buffer) : _buffer(buffer) {}
+
+    //
+    //  Strings
+    //
+    void Visit(const char* value)
+    {
+        const size_t size = strlen(value);
+        WriteSize(size);
+        Write(value, size);
+    }
+
+    template<class CharT, class Traits, class Allocator>
+    void Visit(const std::basic_string<CharT, Traits, Allocator>& value)
+    {
+        WriteSize(value.size());
+        Write(value.data(), value.size() * sizeof(CharT));
+    }
+
+    //
+    //  Pointers (including smart)
+    //
+    template<typename T>
+    void Visit(const T* value) { VisitPtr(value); }
+
+    template<class T, class Deleter>
+    void Visit(const std::unique_ptr<T, Deleter>& value) { VisitPtr(value); }
+
+    template<class T>
+    void Visit(const std::shared_ptr<T>& value) { VisitPtr(value); }
+
+    template<class T>
+    void Visit(const std::weak_ptr<T>& value) { VisitPtr(value.lock()); }
+
+    //
+    //  Pairs and tuples
+    //
+    template<typename T1, typename T2>
+    void Visit(const std::pair<T1, T2>& value)
+    {
+        Self().Visit(value.first);
+        Self().Visit(value.second);
+    }
+
+    template<typename... TupleTypes>
+    void Visit(const std::tuple<TupleTypes...>& value)
+    {
+        VisitTuple(value, std::index_sequence_for<TupleTypes...>());
+    }
+
+    //
+    //  Sequence containers. Arrays of arithmetic types are written at once.
+    //
+    template<class T, std::size_t N>
+    void Visit(const std::array<T, N>& value)
+    {
+        if constexpr(IsBinaryTrivial<T>::value)
+            Write(value.data(), N * sizeof(T));
+        else
+            VisitItems(value);
+    }
+
+    template<class T, class Allocator>
+    void Visit(const std::vector<T, Allocator>& value)
+    {
+        WriteSize(value.size());
+        if constexpr(IsBinaryTrivial<T>::value)
+            Write(value.data(), value.size() * sizeof(T));
+        else
+            VisitItems(value);
+    }
+
+    template<class Allocator>
+    void Visit(const std::vector<bool, Allocator>& value) { VisitList(value); }
+
+    template<class T, class Allocator>
+    void Visit(const std::deque<T, Allocator>& value) { VisitList(value); }
+
+    template<class T, class Allocator>
+    void Visit(const std::forward_list<T, Allocator>& value)
+    {
+        WriteSize(std::distance(value.begin(), value.end()));
+        VisitItems(value);
+    }
+
+    template<class T, class Allocator>
+    void Visit(const std::list<T, Allocator>& value) { VisitList(value); }
+
+    //
+    //  Associative containers
+    //
+    template<class Key, class Compare, class Allocator>
+    void Visit(const std::set<Key, Compare, Allocator>& value) { VisitList(value); }
+
+    template<class Key, class T, class Compare, class Allocator>
+    void Visit(const std::map<Key, T, Compare, Allocator>& value) { VisitList(value); }
+
+    template<class Key, class Compare, class Allocator>
+    void Visit(const std::multiset<Key, Compare, Allocator>& value) { VisitList(value); }
+
+    template<class Key, class T, class Compare, class Allocator>
+    void Visit(const std::multimap<Key, T, Compare, Allocator>& value) { VisitList(value); }
+
+    //
+    //  Unordered associative containers
+    //
+    template<class Key, class Hash, class KeyEqual, class Allocator>
+    void Visit(const std::unordered_set<Key, Hash, KeyEqual, Allocator>& value) { VisitList(value); }
+
+    template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+    void Visit(const std::unordered_map<Key, T, Hash, KeyEqual, Allocator>& value) { VisitList(value); }
+
+    template<class Key, class Hash, class KeyEqual, class Allocator>
+    void Visit(const std::unordered_multiset<Key, Hash, KeyEqual, Allocator>& value) { VisitList(value); }
+
+    template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+    void Visit(const std::unordered_multimap<Key, T, Hash, KeyEqual, Allocator>& value) { VisitList(value); }
+
+    //
+    //  Specification for reflectable class
+    //
+    template<class T>
+    typename std::enable_if_t<Reflection::IsReflectable<T>(), void> Visit(const T& value)
+    {
+        static_assert(Reflection::IsSerializable<T>(), "Class should be declared with REFLECTABLE_SERIALIZABLE_FIELDS");
+        Reflection::VisitFields(value, *this);
+    }
+
+    template<class T>
+    bool VisitField(const char* /*fieldName*/, const T& value)
+    {
+        Self().Visit(value);
+        return true;
+    }
+
+    //
+    //  Arithmetic types and enums
+    //
+    template<class T>
+    typename std::enable_if_t<IsBinaryTrivial<T>::value, void> Visit(const T& value)
+    {
+        Write(&value, sizeof(T));
+    }
+
+    template<class T>
+    typename std::enable_if_t<!Reflection::IsReflectable<T>() && !IsBinaryTrivial<T>::value, void> Visit(const T& value)
+    {
+        static_assert(IsBinaryTrivial<T>::value, "Type isn't supported by binary serialization");
+    }
+};
+
+//
+//  DerivedT, if any, can override Visit for some types, nested values of
+//  containers, pointers and classes are visited through it
+//
+template<class DerivedT = void>
+class BinaryDeserializer
+{
+protected:
+    typedef std::conditional_t<std::is_void<DerivedT>::value, BinaryDeserializer, DerivedT> SelfT;
+
+    const uint8_t* _position;
+    const uint8_t* _end;
+
+    SelfT& Self() { return static_cast<SelfT&>(*this); }
+
+    bool Read(void* data, size_t size)
+    {
+        if(Remaining() < size)
+            return false;
+
+        //  data of empty containers can be null
+        if(size)
+            memcpy(data, _position, size);
+        _position += size;
+        return true;
+    }
+
+    bool ReadSize(uint64_t& size)
+    {
+        size = 0;
+        for(uint32_t shift = 0; shift < 64 && _position != _end; shift += 7)
+        {
+            const uint8_t byte = *_position++;
+            size |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if(!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    //
+    //  Count of items isn't trusted: every item takes at least one byte, so
+    //  larger count is rejected before containers are resized
+    //
+    bool ReadCount(uint64_t& size)
+    {
+        return ReadSize(size) && size <= Remaining();
+    }
+
+    template<class T>
+    bool VisitItems(T& value)
+    {
+        for(auto& item : value)
+        {
+            if(!Self().Visit(item))
+                return false;
+        }
+        return true;
+    }
+
+    //
+    //  Resizable sequence containers are decoded in place, so the nested
+    //  strings and containers of the existing elements are reused
+    //
+    template<class T>
+    bool VisitList(T& value)
+    {
+        uint64_t size = 0;
+        if(!ReadCount(size))
+            return false;
+
+        value.resize(size);
+        return VisitItems(value);
+    }
+
+    //
+    //  Uses-allocator construction of a temporary item, so items of containers
+    //  with std::pmr allocators are decoded in their memory resource
+    //
+    template<class T, class Allocator>
+    static auto GetItemArguments(const Allocator& allocator)
+    {
+        if constexpr(!std::uses_allocator<T, Allocator>::value)
+            return std::tuple<>();
+        else if constexpr(std::is_constructible<T, std::allocator_arg_t, const Allocator&>::value)
+            return std::tuple<std::allocator_arg_t, const Allocator&>(std::allocator_arg, allocator);
+        else
+            return std::tuple<const Allocator&>(allocator);
+    }
+
+    template<class T, class Allocator>
+    static T MakeItem(const Allocator& allocator)
+    {
+        return std::make_from_tuple<T>(GetItemArguments<T>(allocator));
+    }
+
+    template<class First, class Second, class Allocator>
+    static std::pair<First, Second> MakePair(const Allocator& allocator)
+    {
+        return std::pair<First, Second>(std::piecewise_construct,
+            GetItemArguments<First>(allocator), GetItemArguments<Second>(allocator));
+    }
+
+    template<class T>
+    bool VisitSet(T& value)
+    {
+        uint64_t size = 0;
+        if(!ReadCount(size))
+            return false;
+
+        value.clear();
+        for(uint64_t i = 0; i < size; ++i)
+        {
+            typename T::value_type item = MakeItem<typename T::value_type>(value.get_allocator());
+            if(!Self().Visit(item))
+                return false;
+
+            value.insert(value.end(), std::move(item));
+        }
+        return true;
+    }
+
+    template<class T>
+    bool VisitMap(T& value)
+    {
+        uint64_t size = 0;
+        if(!ReadCount(size))
+            return false;
+
+        value.clear();
+        for(uint64_t i = 0; i < size; ++i)
+        {
+            std::pair<typename T::key_type, typename T::mapped_type> item
+                = MakePair<typename T::key_type, typename T::mapped_type>(value.get_allocator());
+            if(!Self().Visit(item))
+                return false;
+
+            value.insert(value.end(), std::move(item));
+        }
+        return true;
+    }
+
+    template<class T, size_t... Index>
+    bool VisitTuple(T& value, std::index_sequence<Index...>)
+    {
+        (void)value;
+        bool result = true;
+        int dummy[] = { 0, (result = result && Self().Visit(std::get<Index>(value)), 0)... };
+        (void)dummy;
+        return result;
+    }
+
+public:
+    BinaryDeserializer(const void* data, size_t size)
+        : _position(static_cast<const uint8_t*>(data)), _end(_position + size) {}
+
+    size_t Remaining() const { return _end - _position; }
+
+    //
+    //  Strings
+    //
+    template<class CharT, class Traits, class Allocator>
+    bool Visit(std::basic_string<CharT, Traits, Allocator>& value)
+    {
+        uint64_t size = 0;
+        if(!ReadSize(size) || Remaining() / sizeof(CharT) < size)
+            return false;
+
+        value.resize(size);
+        return Read(&value[0], size * sizeof(CharT));
+    }
+
+    //
+    //  Smart pointers. Existing pointee of unique_ptr is reused. Deleter with
+    //  New() creates the pointee itself (see PmrDeleter in Pmr.h).
+    //
+    template<class T, class Deleter>
+    bool Visit(std::unique_ptr<T, Deleter>& value)
+    {
+        uint8_t present = 0;
+        if(!Read(&present, 1))
+            return false;
+
+        if(!present)
+        {
+            value.reset();
+            return true;
+        }
+
+        if(!value)
+        {
+            if constexpr(HasPointeeFactory<Deleter>::value)
+                value.reset(value.get_deleter().New());
+            else
+                value.reset(new T());
+        }
+        return Self().Visit(*value);
+    }
+
+    template<class T>
+    bool Visit(std::shared_ptr<T>& value)
+    {
+        uint8_t present = 0;
+        if(!Read(&present, 1))
+            return false;
+
+        if(!present)
+        {
+            value.reset();
+            return true;
+        }
+
+        //  Pointee can be shared with other objects, so never decode in place
+        value = std::make_shared<T>();
+        return Self().Visit(*value);
+    }
+
+    //
+    //  Pairs and tuples
+    //
+    template<typename T1, typename T2>
+    bool Visit(std::pair<T1, T2>& value)
+    {
+        return Self().Visit(value.first) && Self().Visit(value.second);
+    }
+
+    template<typename... TupleTypes>
+    bool Visit(std::tuple<TupleTypes...>& value)
+    {
+        return VisitTuple(value, std::index_sequence_for<TupleTypes...>());
+    }
+
+    //
+    //  Sequence containers
+    //
+    template<class T, std::size_t N>
+    bool Visit(std::array<T, N>& value)
+    {
+        if constexpr(IsBinaryTrivial<T>::value)
+            return Read(value.data(), N * sizeof(T));
+        else
+            return VisitItems(value);
+    }
+
+    template<class T, class Allocator>
+    bool Visit(std::vector<T, Allocator>& value)
+    {
+        if constexpr(!IsBinaryTrivial<T>::value)
+            return VisitList(value);
+        else
+        {
+            uint64_t size = 0;
+            if(!ReadSize(size) || Remaining() / sizeof(T) < size)
+                return false;
+
+            value.resize(size);
+            return Read(value.data(), size * sizeof(T));
+        }
+    }
+
+    template<class Allocator>
+    bool Visit(std::vector<bool, Allocator>& value)
+    {
+        uint64_t size = 0;
+        if(!ReadCount(size))
+            return false;
+
+        value.resize(size);
+        for(auto&& item : value)
+        {
+            bool bit = false;
+            if(!Visit(bit))
+                return false;
+
+            item = bit;
+        }
+        return true;
+    }
+
+    template<class T, class Allocator>
+    bool Visit(std::deque<T, Allocator>& value) { return VisitList(value); }
+
+    template<class T, class Allocator>
+    bool Visit(std::forward_list<T, Allocator>& value) { return VisitList(value); }
+
+    template<class T, class Allocator>
+    bool Visit(std::list<T, Allocator>& value) { return VisitList(value); }
+
+    //
+    //  Associative containers
+    //
+    template<class Key, class Compare, class Allocator>
+    bool Visit(std::set<Key, Compare, Allocator>& value) { return VisitSet(value); }
+
+    template<class Key, class T, class Compare, class Allocator>
+    bool Visit(std::map<Key, T, Compare, Allocator>& value) { return VisitMap(value); }
+
+    template<class Key, class Compare, class Allocator>
+    bool Visit(std::multiset<Key, Compare, Allocator>& value) { return VisitSet(value); }
+
+    template<class Key, class T, class Compare, class Allocator>
+    bool Visit(std::multimap<Key, T, Compare, Allocator>& value) { return VisitMap(value); }
+
+    //
+    //  Unordered associative containers
+    //
+    template<class Key, class Hash, class KeyEqual, class Allocator>
+    bool Visit(std::unordered_set<Key, Hash, KeyEqual, Allocator>& value) { return VisitSet(value); }
+
+    template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+    bool Visit(std::unordered_map<Key, T, Hash, KeyEqual, Allocator>& value) { return VisitMap(value); }
+
+    template<class Key, class Hash, class KeyEqual, class Allocator>
+    bool Visit(std::unordered_multiset<Key, Hash, KeyEqual, Allocator>& value) { return VisitSet(value); }
+
+    template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+    bool Visit(std::unordered_multimap<Key, T, Hash, KeyEqual, Allocator>& value) { return VisitMap(value); }
+
+    //
+    //  Specification for reflectable class
+    //
+    template<class T>
+    typename std::enable_if_t<Reflection::IsReflectable<T>(), bool> Visit(T& value)
+    {
+        static_assert(Reflection::IsSerializable<T>(), "Class should be declared with REFLECTABLE_SERIALIZABLE_FIELDS");
+        return Reflection::VisitFields(value, *this);
+    }
+
+    template<class T>
+    bool VisitField(const char* /*fieldName*/, T& value)
+    {
+        return Self().Visit(value);
+    }
+
+    //
+    //  Arithmetic types and enums
+    //
+    template<class T>
+    typename std::enable_if_t<IsBinaryTrivial<T>::value, bool> Visit(T& value)
+    {
+        return Read(&value, sizeof(T));
+    }
+
+    template<class T>
+    typename std::enable_if_t<!Reflection::IsReflectable<T>() && !IsBinaryTrivial<T>::value, bool> Visit(T& value)
+    {
+        static_assert(IsBinaryTrivial<T>::value, "Type isn't supported by binary deserialization");
+        return false;
+    }
+};
+
+template<typename BufferT, typename ObjectT>
+void BinarySerialize(BufferT& buffer, const ObjectT& obj)
+{
+    BinarySerializer<BufferT> serializer(buffer);
+    serializer.Visit(obj);
+}
+
+//
+//  Returns false if data is truncated, corrupted or has trailing bytes.
+//  In case of failure object can be partially updated.
+//
+template<typename ObjectT>
+bool BinaryDeserialize(const void* data, size_t size, ObjectT& obj)
+{
+    BinaryDeserializer<> deserializer(data, size);
+    return deserializer.Visit(obj) && deserializer.Remaining() == 0;
+}
+
+template<typename BufferT, typename ObjectT>
+bool BinaryDeserialize(const BufferT& buffer, ObjectT& obj)
+{
+    return BinaryDeserialize(buffer.data(), buffer.size(), obj);
+}
+
+};  //  namespace vklib
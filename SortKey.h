@@ -0,0 +1,489 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains order preserving sort keys of reflectable classes and
+//  radix sort built on them. Sort key is a byte string, which memcmp order is
+//  the same as the order of Reflection::Compare:
+//  - integers and enums are written in big endian byte order, signed ones
+//    with flipped sign bit;
+//  - floating point numbers are written as integers with flipped sign bit for
+//    positive numbers and all bits flipped for negative ones;
+//  - strings are written with 0x00 escaped as 0x00 0xFF and terminated by
+//    0x00 0x00;
+//  - other containers are written as a sequence of elements, each prefixed by
+//    0x01, and terminated by 0x00;
+//  - pairs, tuples and reflectable classes are written as a sequence of their
+//    elements.
+//  By default keys include all fields in declaration order, optional list of
+//  field ids selects the fields and their order, e.g.:
+//  RadixSort(records);
+//  RadixSort<Reflection::FindFieldId<Record>("day"), Reflection::FindFieldId<Record>("id")>(records);
+//
+
+#pragma once
+
+#include "Reflection.h"
+#include <string.h>
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <forward_list>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace vklib
+{
+
+template<class BufferT>
+class SortKeyWriter
+{
+protected:
+    static_assert(sizeof(typename BufferT::value_type) == 1, "Buffer should be a container of bytes");
+
+    typedef typename BufferT::value_type ByteT;
+
+    BufferT& _buffer;
+
+    void WriteByte(uint8_t byte)
+    {
+        _buffer.push_back(static_cast<ByteT>(byte));
+    }
+
+    template<class T>
+    void WriteBigEndian(T value)
+    {
+        static_assert(std::is_unsigned<T>::value, "Unsigned type is expected");
+        ByteT bytes[sizeof(T)];
+        for(size_t i = 0; i < sizeof(T); ++i)
+            bytes[i] = static_cast<ByteT>(value >> (8 * (sizeof(T) - 1 - i)));
+        _buffer.insert(_buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    void WriteString(const char* data, size_t size)
+    {
+        for(const char* end = data + size; data != end;)
+        {
+            const char* zero = static_cast<const char*>(memchr(data, 0, end - data));
+            const char* runEnd = zero ? zero : end;
+            _buffer.insert(_buffer.end(), reinterpret_cast<const ByteT*>(data), reinterpret_cast<const ByteT*>(runEnd));
+            data = runEnd;
+            if(zero)
+            {
+                WriteByte(0x00);
+                WriteByte(0xFF);
+                ++data;
+            }
+        }
+        WriteByte(0x00);
+        WriteByte(0x00);
+    }
+
+    template<class T>
+    void VisitItems(const T& value)
+    {
+        for(const auto& item : value)
+        {
+            WriteByte(0x01);
+            Visit(item);
+        }
+        WriteByte(0x00);
+    }
+
+    template<class T, size_t... Index>
+    void VisitTuple(const T& value, std::index_sequence<Index...>)
+    {
+        (Visit(std::get<Index>(value)), ...);
+    }
+
+public:
+    SortKeyWriter(BufferT& buffer) : _buffer(buffer) {}
+
+    //
+    //  Integers, enums and pointers
+    //
+    template<class T>
+    typename std::enable_if_t<std::is_integral<T>::value || std::is_enum<T>::value, void> Visit(const T value)
+    {
+        typedef std::conditional_t<std::is_enum<T>::value, std::underlying_type<T>, std::common_type<T>> IntegerT;
+        typedef std::make_unsigned_t<std::conditional_t<std::is_same<typename IntegerT::type, bool>::value,
+            uint8_t, typename IntegerT::type>> UnsignedT;
+        UnsignedT bits = static_cast<UnsignedT>(value);
+        if(std::is_signed<typename IntegerT::type>::value)
+            bits ^= UnsignedT(1) << (8 * sizeof(UnsignedT) - 1);
+        WriteBigEndian(bits);
+    }
+
+    template<typename T>
+    void Visit(const T* value)
+    {
+        WriteBigEndian(reinterpret_cast<uintptr_t>(value));
+    }
+
+    //
+    //  Floating point numbers. Negative zero is written as positive one.
+    //
+    void Visit(const float value) { VisitFloat<uint32_t>(value); }
+    void Visit(const double value) { VisitFloat<uint64_t>(value); }
+
+    template<class UnsignedT, class T>
+    void VisitFloat(const T value)
+    {
+        static_assert(sizeof(UnsignedT) == sizeof(T), "Unexpected size of floating point type");
+        const T normalized = value == 0 ? T(0) : value;
+        UnsignedT bits;
+        memcpy(&bits, &normalized, sizeof(bits));
+        const UnsignedT sign = UnsignedT(1) << (8 * sizeof(UnsignedT) - 1);
+        WriteBigEndian((bits & sign) ? UnsignedT(~bits) : UnsignedT(bits ^ sign));
+    }
+
+    //
+    //  Strings
+    //
+    template<class Traits, class Allocator>
+    void Visit(const std::basic_string<char, Traits, Allocator>& value) { WriteString(value.data(), value.size()); }
+
+    template<class Traits>
+    void Visit(const std::basic_string_view<char, Traits> value) { WriteString(value.data(), value.size()); }
+
+    //
+    //  Smart pointers are ordered by address as in Reflection::Compare
+    //
+    template<class T, class Deleter>
+    void Visit(const std::unique_ptr<T, Deleter>& value) { Visit(value.get()); }
+
+    template<class T>
+    void Visit(const std::shared_ptr<T>& value) { Visit(value.get()); }
+
+    //
+    //  Pairs and tuples
+    //
+    template<typename T1, typename T2>
+    void Visit(const std::pair<T1, T2>& value)
+    {
+        Visit(value.first);
+        Visit(value.second);
+    }
+
+    template<typename... TupleTypes>
+    void Visit(const std::tuple<TupleTypes...>& value)
+    {
+        VisitTuple(value, std::index_sequence_for<TupleTypes...>());
+    }
+
+    //
+    //  Ordered containers
+    //
+    template<class T, std::size_t N>
+    void Visit(const std::array<T, N>& value) { VisitItems(value); }
+
+    template<class T, class Allocator>
+    void Visit(const std::vector<T, Allocator>& value) { VisitItems(value); }
+
+    template<class T, class Allocator>
+    void Visit(const std::deque<T, Allocator>& value) { VisitItems(value); }
+
+    template<class T, class Allocator>
+    void Visit(const std::forward_list<T, Allocator>& value) { VisitItems(value); }
+
+    template<class T, class Allocator>
+    void Visit(const std::list<T, Allocator>& value) { VisitItems(value); }
+
+    template<class Key, class Compare, class Allocator>
+    void Visit(const std::set<Key, Compare, Allocator>& value) { VisitItems(value); }
+
+    template<class Key, class T, class Compare, class Allocator>
+    void Visit(const std::map<Key, T, Compare, Allocator>& value) { VisitItems(value); }
+
+    template<class Key, class Compare, class Allocator>
+    void Visit(const std::multiset<Key, Compare, Allocator>& value) { VisitItems(value); }
+
+    template<class Key, class T, class Compare, class Allocator>
+    void Visit(const std::multimap<Key, T, Compare, Allocator>& value) { VisitItems(value); }
+
+    //
+    //  Specification for reflectable class
+    //
+    template<class T>
+    typename std::enable_if_t<Reflection::IsReflectable<T>(), void> Visit(const T& value)
+    {
+        Reflection::VisitFields(value, *this);
+    }
+
+    template<class T>
+    bool VisitField(const char* /*fieldName*/, const T& value)
+    {
+        Visit(value);
+        return true;
+    }
+};
+
+//
+//  Appends sort key of the object to the buffer (any container of bytes with
+//  push_back() and insert(), e.g. std::string). Keys of different objects
+//  compare with memcmp (shorter key is less if it's a prefix of longer one) as
+//  objects compare with Reflection::Compare over selected fields.
+//
+template<uint32_t... FieldIds, class BufferT, class ObjectT>
+void AppendSortKey(BufferT& buffer, const ObjectT& obj)
+{
+    SortKeyWriter<BufferT> writer(buffer);
+    if constexpr(sizeof...(FieldIds) == 0)
+        writer.Visit(obj);
+    else
+        (writer.Visit(Reflection::GetFieldValue<FieldIds>(obj)), ...);
+}
+
+template<uint32_t... FieldIds, class ObjectT>
+std::string GetSortKey(const ObjectT& obj)
+{
+    std::string key;
+    AppendSortKey<FieldIds...>(key, obj);
+    return key;
+}
+
+//
+//  Stable MSD radix sort of key references. Partitions larger than
+//  PARALLEL_THRESHOLD are sorted by the pool of threads, small ones are
+//  finished by insertion sort.
+//
+class SortKeyRadixSorter
+{
+public:
+    struct KeyRef
+    {
+        const uint8_t* data;
+        uint32_t size;
+        uint32_t index;
+    };
+
+protected:
+    static constexpr size_t INSERTION_THRESHOLD = 32;
+    static constexpr size_t PARALLEL_THRESHOLD = 1 << 14;
+
+    struct Task
+    {
+        size_t begin;
+        size_t end;
+        uint32_t depth;
+    };
+
+    KeyRef* _keys;
+    std::vector<KeyRef> _temp;
+    unsigned _threadCount;
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::vector<Task> _tasks;
+    size_t _pendingCount = 0;
+
+    static inline bool Less(const KeyRef& key1, const KeyRef& key2, uint32_t depth)
+    {
+        const uint32_t size = std::min(key1.size, key2.size);
+        const int result = size > depth ? memcmp(key1.data + depth, key2.data + depth, size - depth) : 0;
+        return result < 0 || (result == 0 && key1.size < key2.size);
+    }
+
+    void InsertionSort(size_t begin, size_t end, uint32_t depth)
+    {
+        for(size_t i = begin + 1; i < end; ++i)
+        {
+            const KeyRef key = _keys[i];
+            size_t j = i;
+            for(; j > begin && Less(key, _keys[j - 1], depth); --j)
+                _keys[j] = _keys[j - 1];
+            _keys[j] = key;
+        }
+    }
+
+    void Push(size_t begin, size_t end, uint32_t depth)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.push_back({ begin, end, depth });
+            ++_pendingCount;
+        }
+        _condition.notify_one();
+    }
+
+    //
+    //  Bucket 0 holds keys, which end at depth, so they precede all longer ones
+    //
+    static inline uint32_t GetBucket(const KeyRef& key, uint32_t depth)
+    {
+        return depth < key.size ? key.data[depth] + 1u : 0u;
+    }
+
+    void Sort(size_t begin, size_t end, uint32_t depth)
+    {
+        std::array<size_t, 257> counts;
+        for(;; ++depth)
+        {
+            if(end - begin <= INSERTION_THRESHOLD)
+            {
+                InsertionSort(begin, end, depth);
+                return;
+            }
+
+            counts.fill(0);
+            for(size_t i = begin; i < end; ++i)
+                ++counts[GetBucket(_keys[i], depth)];
+
+            //  Common prefix doesn't need a scatter pass
+            const uint32_t first = GetBucket(_keys[begin], depth);
+            if(counts[first] == end - begin)
+            {
+                if(first == 0)
+                    return;
+                continue;
+            }
+            break;
+        }
+
+        std::array<size_t, 257> offsets;
+        size_t offset = begin;
+        for(size_t bucket = 0; bucket < counts.size(); ++bucket)
+        {
+            offsets[bucket] = offset;
+            offset += counts[bucket];
+        }
+
+        for(size_t i = begin; i < end; ++i)
+            _temp[offsets[GetBucket(_keys[i], depth)]++] = _keys[i];
+        memcpy(_keys + begin, _temp.data() + begin, (end - begin) * sizeof(KeyRef));
+
+        size_t bucketBegin = begin + counts[0];
+        for(size_t bucket = 1; bucket < counts.size(); ++bucket)
+        {
+            const size_t bucketEnd = bucketBegin + counts[bucket];
+            if(counts[bucket] > PARALLEL_THRESHOLD && _threadCount > 1)
+                Push(bucketBegin, bucketEnd, depth + 1);
+            else if(counts[bucket] > 1)
+                Sort(bucketBegin, bucketEnd, depth + 1);
+            bucketBegin = bucketEnd;
+        }
+    }
+
+    void RunWorker()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for(;;)
+        {
+            _condition.wait(lock, [this]() { return !_tasks.empty() || _pendingCount == 0; });
+            if(_tasks.empty())
+                return;
+
+            const Task task = _tasks.back();
+            _tasks.pop_back();
+            lock.unlock();
+            Sort(task.begin, task.end, task.depth);
+            lock.lock();
+            if(--_pendingCount == 0)
+                _condition.notify_all();
+        }
+    }
+
+public:
+    SortKeyRadixSorter(KeyRef* keys, size_t count, unsigned threadCount)
+        : _keys(keys), _temp(count), _threadCount(std::max(threadCount, 1u))
+    {
+    }
+
+    void Sort()
+    {
+        Push(0, _temp.size(), 0);
+        std::vector<std::thread> threads;
+        for(unsigned i = 1; i < _threadCount; ++i)
+            threads.emplace_back([this]() { RunWorker(); });
+        RunWorker();
+        for(std::thread& thread : threads)
+            thread.join();
+    }
+};
+
+//
+//  Stable sort of reflectable records by their sort keys (see AppendSortKey).
+//  Keys are built and sorted by threadCount threads, then records are moved
+//  to their places.
+//
+template<uint32_t... FieldIds, class T, class Allocator>
+void RadixSort(std::vector<T, Allocator>& records, unsigned threadCount = std::thread::hardware_concurrency())
+{
+    typedef SortKeyRadixSorter::KeyRef KeyRef;
+
+    const size_t count = records.size();
+    threadCount = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threadCount, count / 1024)));
+
+    std::vector<KeyRef> keys(count);
+    std::vector<std::string> buffers(threadCount);
+    std::vector<std::vector<size_t>> offsets(threadCount);
+
+    const auto buildKeys = [&](unsigned thread)
+    {
+        const size_t begin = count * thread / threadCount;
+        const size_t end = count * (thread + 1) / threadCount;
+        std::string& buffer = buffers[thread];
+        std::vector<size_t>& bufferOffsets = offsets[thread];
+        bufferOffsets.reserve(end - begin + 1);
+        for(size_t i = begin; i < end; ++i)
+        {
+            bufferOffsets.push_back(buffer.size());
+            AppendSortKey<FieldIds...>(buffer, records[i]);
+        }
+        bufferOffsets.push_back(buffer.size());
+
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer.data());
+        for(size_t i = begin; i < end; ++i)
+        {
+            const size_t offset = bufferOffsets[i - begin];
+            keys[i] = { data + offset, static_cast<uint32_t>(bufferOffsets[i - begin + 1] - offset), static_cast<uint32_t>(i) };
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned thread = 1; thread < threadCount; ++thread)
+        threads.emplace_back(buildKeys, thread);
+    buildKeys(0);
+    for(std::thread& thread : threads)
+        thread.join();
+
+    SortKeyRadixSorter(keys.data(), count, threadCount).Sort();
+
+    std::vector<T, Allocator> sorted(records.get_allocator());
+    sorted.reserve(count);
+    for(const KeyRef& key : keys)
+        sorted.push_back(std::move(records[key.index]));
+    records.swap(sorted);
+}
+
+};  //  namespace vklib
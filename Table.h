@@ -0,0 +1,436 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains ReflectableTable, an in-memory table of reflectable
+//  objects with secondary indexes on their fields:
+//  - HashIndex<fieldId> answers equality lookups, its updates are linear in
+//    count of the rows with the same value;
+//  - OrderedIndex<fieldId> answers equality and range lookups, its updates
+//    are logarithmic, so it suits fields with few distinct values better.
+//  Rows are addressed by RowId, which stays valid until the row is erased.
+//  Rows are read only, changes go through SetFieldValue or Update, which
+//  update only the indexes on the changed fields.
+//  E.g.:
+//  constexpr uint32_t NAME = Reflection::FindFieldId<User>("name");
+//  constexpr uint32_t AGE = Reflection::FindFieldId<User>("age");
+//  ReflectableTable<User, HashIndex<NAME>, OrderedIndex<AGE>> users;
+//  RowId row = users.Insert(user);
+//  users.SetFieldValue<AGE>(row, 42);
+//  std::vector<RowId> adults = users.FindRange<AGE>(18, 200);
+//
+
+#pragma once
+
+#include "Reflection.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <set>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vklib
+{
+
+typedef size_t RowId;
+
+//
+//  Hash and comparison of index keys, reflectable keys use Reflection
+//
+template<class T>
+using IndexKeyHash = std::conditional_t<Reflection::IsReflectable<T>(), Hash<T>, std::hash<T>>;
+
+template<class T>
+using IndexKeyEqualTo = std::conditional_t<Reflection::IsReflectable<T>(), EqualTo<T>, std::equal_to<T>>;
+
+template<class T>
+using IndexKeyLess = std::conditional_t<Reflection::IsReflectable<T>(), Less<T>, std::less<T>>;
+
+//
+//  Erases the row from multimap index
+//
+template<class MultimapT, class KeyT>
+void EraseIndexEntry(MultimapT& index, const KeyT& key, RowId row)
+{
+    const auto range = index.equal_range(key);
+    for(auto it = range.first; it != range.second; ++it)
+    {
+        if(it->second == row)
+        {
+            index.erase(it);
+            return;
+        }
+    }
+}
+
+template<uint32_t fieldId>
+struct HashIndex
+{
+    static constexpr uint32_t FIELD_ID = fieldId;
+    static constexpr bool ORDERED = false;
+
+    template<class KeyT>
+    class Storage
+    {
+    protected:
+        std::unordered_multimap<KeyT, RowId, IndexKeyHash<KeyT>, IndexKeyEqualTo<KeyT>> _index;
+
+    public:
+        void Insert(const KeyT& key, RowId row) { _index.emplace(key, row); }
+        void Erase(const KeyT& key, RowId row) { EraseIndexEntry(_index, key, row); }
+        void Clear() { _index.clear(); }
+
+        template<class FunctionT>
+        void ForEachEqual(const KeyT& key, FunctionT&& function) const
+        {
+            const auto range = _index.equal_range(key);
+            for(auto it = range.first; it != range.second; ++it)
+                function(it->second);
+        }
+    };
+};
+
+//
+//  Keys with equal values are ordered by row, so erase and update don't
+//  depend on count of the rows with the same value
+//
+template<uint32_t fieldId>
+struct OrderedIndex
+{
+    static constexpr uint32_t FIELD_ID = fieldId;
+    static constexpr bool ORDERED = true;
+
+    template<class KeyT>
+    class Storage
+    {
+    protected:
+        struct Entry
+        {
+            KeyT key;
+            RowId row;
+        };
+
+        //  Lookup key without copying the value
+        struct Bound
+        {
+            const KeyT& key;
+            RowId row;
+        };
+
+        struct EntryLess
+        {
+            typedef void is_transparent;
+
+            template<class T1, class T2>
+            bool operator()(const T1& entry1, const T2& entry2) const
+            {
+                const IndexKeyLess<KeyT> less;
+                if(less(entry1.key, entry2.key))
+                    return true;
+                if(less(entry2.key, entry1.key))
+                    return false;
+                return entry1.row < entry2.row;
+            }
+        };
+
+        std::set<Entry, EntryLess> _index;
+
+    public:
+        void Insert(const KeyT& key, RowId row) { _index.insert(Entry { key, row }); }
+        void Erase(const KeyT& key, RowId row)
+        {
+            const auto it = _index.find(Bound { key, row });
+            if(it != _index.end())
+                _index.erase(it);
+        }
+
+        void Clear() { _index.clear(); }
+
+        template<class FunctionT>
+        void ForEachEqual(const KeyT& key, FunctionT&& function) const
+        {
+            for(auto it = _index.lower_bound(Bound { key, 0 }); it != _index.end() && !IndexKeyLess<KeyT>()(key, it->key); ++it)
+                function(it->row);
+        }
+
+        //
+        //  Rows with keys in [begin, end) in order of the keys
+        //
+        template<class FunctionT>
+        void ForEachInRange(const KeyT& begin, const KeyT& end, FunctionT&& function) const
+        {
+            const auto last = _index.lower_bound(Bound { end, 0 });
+            for(auto it = _index.lower_bound(Bound { begin, 0 }); it != last; ++it)
+                function(it->row);
+        }
+    };
+};
+
+template<class ReflectableClass, class... IndexesT>
+class ReflectableTable
+{
+public:
+    static constexpr uint32_t COUNT_OF_INDEXES = sizeof...(IndexesT);
+    static constexpr RowId NOT_FOUND = RowId(-1);
+
+    template<uint32_t fieldId>
+    using KeyType = Reflection::FieldType<ReflectableClass, fieldId>;
+
+protected:
+    typedef std::make_integer_sequence<uint32_t, COUNT_OF_INDEXES> IndexIndexes;
+
+    template<class IndexT>
+    using IndexStorage = typename IndexT::template Storage<KeyType<IndexT::FIELD_ID>>;
+
+    //  Trailing values keep the arrays nonempty for tables without indexes
+    static constexpr uint32_t INDEX_FIELD_IDS[] = { IndexesT::FIELD_ID..., 0 };
+    static constexpr bool INDEX_ORDERED[] = { IndexesT::ORDERED..., false };
+
+    //
+    //  Position of the index on the field, hash one is preferred unless the
+    //  ordered one is required. COUNT_OF_INDEXES if there is none.
+    //
+    static constexpr uint32_t FindIndex(uint32_t fieldId, bool ordered)
+    {
+        uint32_t found = COUNT_OF_INDEXES;
+        for(uint32_t i = 0; i < COUNT_OF_INDEXES; ++i)
+        {
+            if(INDEX_FIELD_IDS[i] != fieldId || (ordered && !INDEX_ORDERED[i]))
+                continue;
+            if(found == COUNT_OF_INDEXES || (INDEX_ORDERED[found] && !INDEX_ORDERED[i]))
+                found = i;
+        }
+        return found;
+    }
+
+    std::vector<ReflectableClass> _rows;
+    std::vector<bool> _used;
+    std::vector<RowId> _free;
+    size_t _size = 0;
+    std::tuple<IndexStorage<IndexesT>...> _indexes;
+
+    template<uint32_t... Index>
+    void InsertIndexes(RowId row, std::integer_sequence<uint32_t, Index...>)
+    {
+        (std::get<Index>(_indexes).Insert(Reflection::GetFieldValue<INDEX_FIELD_IDS[Index]>(_rows[row]), row), ...);
+    }
+
+    template<uint32_t... Index>
+    void EraseIndexes(RowId row, std::integer_sequence<uint32_t, Index...>)
+    {
+        (std::get<Index>(_indexes).Erase(Reflection::GetFieldValue<INDEX_FIELD_IDS[Index]>(_rows[row]), row), ...);
+    }
+
+    template<uint32_t fieldId, uint32_t... Index>
+    void EraseFieldIndexes(RowId row, std::integer_sequence<uint32_t, Index...>)
+    {
+        ((INDEX_FIELD_IDS[Index] == fieldId
+            ? std::get<Index>(_indexes).Erase(Reflection::GetFieldValue<INDEX_FIELD_IDS[Index]>(_rows[row]), row)
+            : void()), ...);
+    }
+
+    template<uint32_t fieldId, uint32_t... Index>
+    void InsertFieldIndexes(RowId row, std::integer_sequence<uint32_t, Index...>)
+    {
+        ((INDEX_FIELD_IDS[Index] == fieldId
+            ? std::get<Index>(_indexes).Insert(Reflection::GetFieldValue<INDEX_FIELD_IDS[Index]>(_rows[row]), row)
+            : void()), ...);
+    }
+
+    template<uint32_t... Index>
+    void ClearIndexes(std::integer_sequence<uint32_t, Index...>)
+    {
+        (std::get<Index>(_indexes).Clear(), ...);
+    }
+
+    //
+    //  Reindexes the row for the indexes, which fields differ in obj
+    //
+    template<uint32_t... Index>
+    void Update(RowId row, const ReflectableClass& obj, std::integer_sequence<uint32_t, Index...>)
+    {
+        bool changed[] = { !IndexKeyEqualTo<KeyType<INDEX_FIELD_IDS[Index]>>()(
+            Reflection::GetFieldValue<INDEX_FIELD_IDS[Index]>(_rows[row]),
+            Reflection::GetFieldValue<INDEX_FIELD_IDS[Index]>(obj))..., false };
+        ((changed[Index] ? std::get<Index>(_indexes).Erase(Reflection::GetFieldValue<INDEX_FIELD_IDS[Index]>(_rows[row]), row)
+            : void()), ...);
+        _rows[row] = obj;
+        ((changed[Index] ? std::get<Index>(_indexes).Insert(Reflection::GetFieldValue<INDEX_FIELD_IDS[Index]>(_rows[row]), row)
+            : void()), ...);
+    }
+
+    template<class T>
+    RowId InsertRow(T&& obj)
+    {
+        RowId row;
+        if(_free.empty())
+        {
+            row = _rows.size();
+            _rows.push_back(std::forward<T>(obj));
+            _used.push_back(true);
+        }
+        else
+        {
+            row = _free.back();
+            _free.pop_back();
+            _rows[row] = std::forward<T>(obj);
+            _used[row] = true;
+        }
+        InsertIndexes(row, IndexIndexes());
+        ++_size;
+        return row;
+    }
+
+public:
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    RowId Insert(const ReflectableClass& obj) { return InsertRow(obj); }
+    RowId Insert(ReflectableClass&& obj) { return InsertRow(std::move(obj)); }
+
+    bool Contains(RowId row) const { return row < _rows.size() && _used[row]; }
+
+    const ReflectableClass& Get(RowId row) const { return _rows[row]; }
+
+    bool Erase(RowId row)
+    {
+        if(!Contains(row))
+            return false;
+
+        EraseIndexes(row, IndexIndexes());
+        _rows[row] = ReflectableClass();
+        _used[row] = false;
+        _free.push_back(row);
+        --_size;
+        return true;
+    }
+
+    void Clear()
+    {
+        _rows.clear();
+        _used.clear();
+        _free.clear();
+        ClearIndexes(IndexIndexes());
+        _size = 0;
+    }
+
+    //
+    //  Sets the field of the row, only the indexes on this field are updated.
+    //  Returns false if there is no such row.
+    //
+    template<uint32_t fieldId, class FieldT>
+    bool SetFieldValue(RowId row, FieldT&& value)
+    {
+        if(!Contains(row))
+            return false;
+
+        EraseFieldIndexes<fieldId>(row, IndexIndexes());
+        Reflection::SetFieldValue<fieldId>(_rows[row], std::forward<FieldT>(value));
+        InsertFieldIndexes<fieldId>(row, IndexIndexes());
+        return true;
+    }
+
+    //
+    //  Replaces the row, only the indexes on changed fields are updated.
+    //  Returns false if there is no such row.
+    //
+    bool Update(RowId row, const ReflectableClass& obj)
+    {
+        if(!Contains(row))
+            return false;
+
+        Update(row, obj, IndexIndexes());
+        return true;
+    }
+
+    //
+    //  Calls function(row) for each row with the field equal to key. The
+    //  field should have an index.
+    //
+    template<uint32_t fieldId, class FunctionT>
+    void ForEachEqual(const KeyType<fieldId>& key, FunctionT&& function) const
+    {
+        constexpr uint32_t index = FindIndex(fieldId, false);
+        static_assert(index < COUNT_OF_INDEXES, "The field has no index");
+        std::get<index>(_indexes).ForEachEqual(key, std::forward<FunctionT>(function));
+    }
+
+    //
+    //  Calls function(row) for each row with the field in [begin, end) in
+    //  order of the field. The field should have an ordered index.
+    //
+    template<uint32_t fieldId, class FunctionT>
+    void ForEachInRange(const KeyType<fieldId>& begin, const KeyType<fieldId>& end, FunctionT&& function) const
+    {
+        constexpr uint32_t index = FindIndex(fieldId, true);
+        static_assert(index < COUNT_OF_INDEXES, "The field has no ordered index");
+        std::get<index>(_indexes).ForEachInRange(begin, end, std::forward<FunctionT>(function));
+    }
+
+    template<uint32_t fieldId>
+    std::vector<RowId> Find(const KeyType<fieldId>& key) const
+    {
+        std::vector<RowId> rows;
+        ForEachEqual<fieldId>(key, [&](RowId row) { rows.push_back(row); });
+        return rows;
+    }
+
+    //
+    //  Any row with the field equal to key or NOT_FOUND
+    //
+    template<uint32_t fieldId>
+    RowId FindFirst(const KeyType<fieldId>& key) const
+    {
+        RowId found = NOT_FOUND;
+        ForEachEqual<fieldId>(key, [&](RowId row) { found = row; });
+        return found;
+    }
+
+    template<uint32_t fieldId>
+    std::vector<RowId> FindRange(const KeyType<fieldId>& begin, const KeyType<fieldId>& end) const
+    {
+        std::vector<RowId> rows;
+        ForEachInRange<fieldId>(begin, end, [&](RowId row) { rows.push_back(row); });
+        return rows;
+    }
+
+    //
+    //  Calls function(row, obj) for each row
+    //
+    template<class FunctionT>
+    void ForEach(FunctionT&& function) const
+    {
+        for(RowId row = 0; row < _rows.size(); ++row)
+        {
+            if(_used[row])
+                function(row, _rows[row]);
+        }
+    }
+};
+
+};  //  namespace vklib
@@ -0,0 +1,424 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains tagged binary serialization, which tolerates schema
+//  changes: fields can be added, removed and reordered. It differs from the
+//  positional format (see Serialization.h) only in reflectable classes,
+//  which are written as uint32 size followed by their fields:
+//  - LEB128 tag of the field;
+//  - uint32 size of the value (for nested reflectable classes it's their own
+//    size) followed by the value.
+//  Tag is derived from the field name, so renaming a field changes it unless
+//  the tag is set explicitly with FIELD_TAGS. Explicit tags are less than
+//  2^20, derived ones are not. Collisions of tags are compile time errors.
+//  Reader skips unknown fields by their size and resets missing ones to the
+//  values of a default constructed object. Fields, which come in declaration
+//  order, are matched without lookup.
+//  E.g.:
+//  class Request
+//  {
+//      int64_t id;
+//      std::string path;
+//      REFLECTABLE_SERIALIZABLE_FIELDS(id, path);
+//      FIELD_TAGS((id, 1), (path, 2));
+//  };
+//  TaggedSerialize(buffer, request);
+//  bool ok = TaggedDeserialize(buffer, otherRequest);
+//
+
+#pragma once
+
+#include "Reflection.h"
+#include "Serialization.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <array>
+#include <bitset>
+#include <string_view>
+#include <type_traits>
+#include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/preprocessor/stringize.hpp>
+#include <boost/preprocessor/tuple/elem.hpp>
+#include <boost/preprocessor/variadic/to_seq.hpp>
+
+namespace vklib
+{
+
+//
+//  Compile time tags of the fields of reflectable class
+//
+template<class ReflectableClass>
+class TaggedSchema
+{
+public:
+    static constexpr uint32_t COUNT_OF_FIELDS = Reflection::GetFieldCount<ReflectableClass>();
+    static constexpr uint32_t DERIVED_TAG_BIT = uint32_t(1) << 20;
+
+    struct TagIndex
+    {
+        uint32_t tag;
+        uint32_t fieldId;
+    };
+
+    //
+    //  LEB128 tag followed by zero uint32 size. Tag is at most 3 bytes, so
+    //  reader compares first 4 bytes of the header under tagMask.
+    //
+    struct FieldHeader
+    {
+        uint8_t bytes[8];
+        uint32_t tagSize;
+        uint32_t size;
+        uint32_t tagBits;
+        uint32_t tagMask;
+    };
+
+protected:
+    template<class T, class = void>
+    struct HasExplicitTags : std::false_type {};
+
+    template<class T>
+    struct HasExplicitTags<T, std::void_t<decltype(T::GetReflectableFieldTag(std::string_view()))>> : std::true_type {};
+
+    static constexpr uint32_t GetTag(std::string_view name)
+    {
+        if constexpr(HasExplicitTags<ReflectableClass>::value)
+        {
+            const uint32_t tag = ReflectableClass::GetReflectableFieldTag(name);
+            if(tag)
+                return tag;
+        }
+
+        //  FNV-1a
+        uint32_t hash = 2166136261u;
+        for(char c : name)
+            hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+        return DERIVED_TAG_BIT | (hash & (DERIVED_TAG_BIT - 1));
+    }
+
+    template<uint32_t... Index>
+    static constexpr std::array<uint32_t, COUNT_OF_FIELDS> MakeTags(std::integer_sequence<uint32_t, Index...>)
+    {
+        return {{ GetTag(Reflection::GetFieldName<ReflectableClass, Index>())... }};
+    }
+
+    static constexpr std::array<FieldHeader, COUNT_OF_FIELDS> MakeHeaders()
+    {
+        std::array<FieldHeader, COUNT_OF_FIELDS> headers = {};
+        const auto tags = MakeTags(std::make_integer_sequence<uint32_t, COUNT_OF_FIELDS>());
+        for(uint32_t i = 0; i < COUNT_OF_FIELDS; ++i)
+        {
+            FieldHeader& header = headers[i];
+            for(uint32_t tag = tags[i]; ; tag >>= 7)
+            {
+                header.bytes[header.tagSize++] = static_cast<uint8_t>(tag >= 0x80 ? (tag & 0x7F) | 0x80 : tag);
+                if(tag < 0x80)
+                    break;
+            }
+            header.size = header.tagSize + sizeof(uint32_t);
+            header.tagMask = (uint32_t(1) << (8 * header.tagSize)) - 1;
+            for(uint32_t j = 0; j < header.tagSize; ++j)
+                header.tagBits |= uint32_t(header.bytes[j]) << (8 * j);
+        }
+        return headers;
+    }
+
+    static constexpr std::array<TagIndex, COUNT_OF_FIELDS> MakeSortedTags()
+    {
+        std::array<TagIndex, COUNT_OF_FIELDS> sorted = {};
+        const auto tags = MakeTags(std::make_integer_sequence<uint32_t, COUNT_OF_FIELDS>());
+        for(uint32_t i = 0; i < COUNT_OF_FIELDS; ++i)
+        {
+            uint32_t j = i;
+            for(; j > 0 && sorted[j - 1].tag > tags[i]; --j)
+                sorted[j] = sorted[j - 1];
+            sorted[j] = { tags[i], i };
+        }
+        return sorted;
+    }
+
+    static constexpr bool AreTagsValid()
+    {
+        for(uint32_t i = 0; i < COUNT_OF_FIELDS; ++i)
+        {
+            if(sortedTags[i].tag == 0 || (i > 0 && sortedTags[i].tag == sortedTags[i - 1].tag))
+                return false;
+        }
+        return true;
+    }
+
+public:
+    //  Tag by field id
+    static constexpr std::array<uint32_t, COUNT_OF_FIELDS> tags = MakeTags(std::make_integer_sequence<uint32_t, COUNT_OF_FIELDS>());
+    static constexpr std::array<TagIndex, COUNT_OF_FIELDS> sortedTags = MakeSortedTags();
+    static constexpr std::array<FieldHeader, COUNT_OF_FIELDS> headers = MakeHeaders();
+
+    static_assert(AreTagsValid(), "Field tags collide, set them explicitly with FIELD_TAGS");
+
+    //
+    //  Returns field id or COUNT_OF_FIELDS if there is no field with the tag
+    //
+    static constexpr uint32_t FindFieldId(uint64_t tag)
+    {
+        uint32_t begin = 0;
+        uint32_t end = COUNT_OF_FIELDS;
+        while(begin < end)
+        {
+            const uint32_t middle = (begin + end) / 2;
+            if(sortedTags[middle].tag < tag)
+                begin = middle + 1;
+            else
+                end = middle;
+        }
+        return begin < COUNT_OF_FIELDS && sortedTags[begin].tag == tag ? sortedTags[begin].fieldId : COUNT_OF_FIELDS;
+    }
+};
+
+template<class BufferT>
+class TaggedSerializer : public BinarySerializer<BufferT, TaggedSerializer<BufferT>>
+{
+protected:
+    typedef BinarySerializer<BufferT, TaggedSerializer<BufferT>> Base;
+
+    using Base::_buffer;
+    using Base::Write;
+
+    size_t BeginSize()
+    {
+        const size_t position = _buffer.size();
+        const uint32_t size = 0;
+        Write(&size, sizeof(size));
+        return position;
+    }
+
+    void EndSize(size_t position)
+    {
+        const uint32_t size = static_cast<uint32_t>(_buffer.size() - position - sizeof(uint32_t));
+        memcpy(&_buffer[position], &size, sizeof(size));
+    }
+
+    template<class T, class FieldHeader>
+    void WriteField(const FieldHeader& header, const T& value)
+    {
+        Write(header.bytes, header.size);
+        const size_t position = _buffer.size() - sizeof(uint32_t);
+        if constexpr(Reflection::IsReflectable<T>())
+        {
+            WriteFields(value, std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<T>()>());
+        }
+        else
+            Visit(value);
+        EndSize(position);
+    }
+
+    template<class ReflectableClass, uint32_t... Index>
+    void WriteFields(const ReflectableClass& obj, std::integer_sequence<uint32_t, Index...>)
+    {
+        static_assert(Reflection::IsSerializable<ReflectableClass>(), "Class should be declared with REFLECTABLE_SERIALIZABLE_FIELDS");
+        typedef TaggedSchema<ReflectableClass> Schema;
+        (WriteField(Schema::headers[Index], Reflection::GetFieldValue<Index>(obj)), ...);
+    }
+
+public:
+    TaggedSerializer(BufferT& buffer) : Base(buffer) {}
+
+    template<class T>
+    void Visit(const T& value)
+    {
+        if constexpr(Reflection::IsReflectable<T>())
+        {
+            const size_t position = BeginSize();
+            WriteFields(value, std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<T>()>());
+            EndSize(position);
+        }
+        else
+            Base::Visit(value);
+    }
+};
+
+class TaggedDeserializer : public BinaryDeserializer<TaggedDeserializer>
+{
+protected:
+    typedef BinaryDeserializer<TaggedDeserializer> Base;
+
+    bool ReadSizedEnd(const uint8_t*& end)
+    {
+        uint32_t size = 0;
+        if(!Read(&size, sizeof(size)) || Remaining() < size)
+            return false;
+
+        end = _position + size;
+        return true;
+    }
+
+    template<class T>
+    bool ReadField(T& value, const uint8_t* end)
+    {
+        if constexpr(Reflection::IsReflectable<T>())
+            return ReadFields(value, end);
+        else
+            return Visit(value) && _position == end;
+    }
+
+    template<class ReflectableClass, uint32_t... Index>
+    bool ReadFieldById(ReflectableClass& obj, uint32_t fieldId, const uint8_t* end, std::integer_sequence<uint32_t, Index...>)
+    {
+        bool result = false;
+        ((fieldId == Index && (result = ReadField(Reflection::GetFieldValue<Index>(obj), end), true)) || ...);
+        return result;
+    }
+
+    template<class ReflectableClass>
+    static const ReflectableClass& GetDefaults()
+    {
+        static const ReflectableClass defaults {};
+        return defaults;
+    }
+
+    template<class T>
+    static void ResetField(T& value, const T& defaultValue)
+    {
+        if constexpr(std::is_copy_assignable<T>::value)
+            value = defaultValue;
+        else
+            value = T();
+    }
+
+    template<class ReflectableClass, size_t Count, uint32_t... Index>
+    static void ResetMissingFields(ReflectableClass& obj, const std::bitset<Count>& found, std::integer_sequence<uint32_t, Index...>)
+    {
+        const ReflectableClass& defaults = GetDefaults<ReflectableClass>();
+        ((found[Index] || (ResetField(Reflection::GetFieldValue<Index>(obj), Reflection::GetFieldValue<Index>(defaults)), true)), ...);
+    }
+
+    template<class ReflectableClass>
+    bool ReadFields(ReflectableClass& obj, const uint8_t* end)
+    {
+        static_assert(Reflection::IsSerializable<ReflectableClass>(), "Class should be declared with REFLECTABLE_SERIALIZABLE_FIELDS");
+        typedef TaggedSchema<ReflectableClass> Schema;
+        typedef std::make_integer_sequence<uint32_t, Schema::COUNT_OF_FIELDS> Indexes;
+
+        std::bitset<Schema::COUNT_OF_FIELDS> found;
+        uint32_t nextFieldId = 0;
+        while(_position != end)
+        {
+            uint32_t fieldId = nextFieldId;
+            uint32_t bits = 0;
+            if(fieldId < Schema::COUNT_OF_FIELDS && Remaining() >= sizeof(bits)
+                && (memcpy(&bits, _position, sizeof(bits)), (bits & Schema::headers[fieldId].tagMask) == Schema::headers[fieldId].tagBits))
+            {
+                _position += Schema::headers[fieldId].tagSize;
+            }
+            else
+            {
+                uint64_t tag = 0;
+                if(!ReadSize(tag))
+                    return false;
+                fieldId = Schema::FindFieldId(tag);
+            }
+
+            const uint8_t* fieldEnd = nullptr;
+            if(!ReadSizedEnd(fieldEnd) || fieldEnd > end)
+                return false;
+            if(fieldId == Schema::COUNT_OF_FIELDS)
+            {
+                _position = fieldEnd;
+                continue;
+            }
+
+            if(!ReadFieldById(obj, fieldId, fieldEnd, Indexes()))
+                return false;
+
+            found.set(fieldId);
+            nextFieldId = fieldId + 1;
+        }
+
+        if(!found.all())
+            ResetMissingFields(obj, found, Indexes());
+        return true;
+    }
+
+public:
+    TaggedDeserializer(const void* data, size_t size) : Base(data, size) {}
+
+    template<class T>
+    bool Visit(T& value)
+    {
+        if constexpr(Reflection::IsReflectable<T>())
+        {
+            const uint8_t* end = nullptr;
+            return ReadSizedEnd(end) && ReadFields(value, end);
+        }
+        else
+            return Base::Visit(value);
+    }
+};
+
+template<typename BufferT, typename ObjectT>
+void TaggedSerialize(BufferT& buffer, const ObjectT& obj)
+{
+    TaggedSerializer<BufferT> serializer(buffer);
+    serializer.Visit(obj);
+}
+
+//
+//  Returns false if data is truncated, corrupted or has trailing bytes.
+//  In case of failure object can be partially updated.
+//
+template<typename ObjectT>
+bool TaggedDeserialize(const void* data, size_t size, ObjectT& obj)
+{
+    TaggedDeserializer deserializer(data, size);
+    return deserializer.Visit(obj) && deserializer.Remaining() == 0;
+}
+
+template<typename BufferT, typename ObjectT>
+bool TaggedDeserialize(const BufferT& buffer, ObjectT& obj)
+{
+    return TaggedDeserialize(buffer.data(), buffer.size(), obj);
+}
+
+};  //  namespace vklib
+
+//
+//  Explicit tags of some fields: FIELD_TAGS((field1, 1), (field2, 2))
+//
+#define FIELD_TAGS_GENERATE_TAG(r, data, elem)                                                  \
+    if(name == BOOST_PP_STRINGIZE(BOOST_PP_TUPLE_ELEM(2, 0, elem)))                             \
+    {                                                                                           \
+        static_assert(BOOST_PP_TUPLE_ELEM(2, 1, elem) > 0                                       \
+            && BOOST_PP_TUPLE_ELEM(2, 1, elem) < (1u << 20),                                    \
+            "Explicit tag should be in [1, 2^20)");                                             \
+        return BOOST_PP_TUPLE_ELEM(2, 1, elem);                                                 \
+    }
+
+#define FIELD_TAGS(...)                                                                         \
+    template<class> friend class vklib::TaggedSchema;                                           \
+    static constexpr uint32_t GetReflectableFieldTag(std::string_view name)                     \
+    {                                                                                           \
+        BOOST_PP_SEQ_FOR_EACH(FIELD_TAGS_GENERATE_TAG, _, BOOST_PP_VARIADIC_TO_SEQ(__VA_ARGS__)) \
+        return 0;                                                                               \
+    }
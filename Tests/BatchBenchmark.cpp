@@ -0,0 +1,60 @@
+#include "../Batch.h"
+#include "Benchmark.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+class BatchBenchmarkRecord
+{
+public:
+    int64_t id = 0;
+    std::string name;
+    double price = 0.0;
+    std::vector<int32_t> values { 1, 2, 3, 4 };
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(id, name, price, values);
+};
+
+int main(int argc, char** argv)
+{
+    std::vector<BatchBenchmarkRecord> records(1000000);
+    for(size_t i = 0; i < records.size(); ++i)
+    {
+        records[i].id = i;
+        records[i].name = "record" + std::to_string(i);
+        records[i].price = i * 0.01;
+    }
+
+    size_t total = 0;
+    const auto sink = [&](const char* data, size_t size) { total += size; };
+
+    Benchmark("ToString of 1M objects into std::stringstream", 1, [&]()
+    {
+        std::stringstream stream;
+        for(const BatchBenchmarkRecord& record : records)
+            stream << ToString(record) << '\n';
+        DoNotOptimize(stream.tellp());
+    });
+
+    BatchOptions single;
+    single.threadCount = 1;
+    Benchmark("BatchToString of 1M objects, 1 thread", 1, [&]()
+    {
+        BatchToString(records.begin(), records.end(), sink, single);
+    });
+
+    Benchmark("BatchToString of 1M objects, all threads", 1, [&]()
+    {
+        BatchToString(records.begin(), records.end(), sink);
+    });
+
+    Benchmark("BatchBinarySerialize of 1M objects, all threads", 1, [&]()
+    {
+        BatchBinarySerialize(records.begin(), records.end(), sink);
+    });
+
+    DoNotOptimize(total);
+    return 0;
+}
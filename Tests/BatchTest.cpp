@@ -0,0 +1,86 @@
+#include "../Batch.h"
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+class BatchTestRecord
+{
+public:
+    int32_t id = 0;
+    std::string name;
+    std::vector<double> values;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(id, name, values);
+};
+
+static std::vector<BatchTestRecord> MakeRecords(size_t count)
+{
+    std::vector<BatchTestRecord> records(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        records[i].id = static_cast<int32_t>(i);
+        records[i].name = "record" + std::to_string(i);
+        records[i].values.assign(i % 5, i * 0.5);
+    }
+    return records;
+}
+
+template<class FunctionT>
+static std::string RunBatch(FunctionT function, const std::vector<BatchTestRecord>& records, const BatchOptions& options)
+{
+    std::string output;
+    size_t callCount = 0;
+    function(records.begin(), records.end(), [&](const char* data, size_t size)
+    {
+        output.append(data, size);
+        ++callCount;
+    }, options);
+    assert(callCount == (records.size() + options.chunkSize - 1) / options.chunkSize);
+    return output;
+}
+
+void BatchTest()
+{
+    const std::vector<BatchTestRecord> records = MakeRecords(10000);
+
+    std::string text;
+    std::string json;
+    std::string binary;
+    std::string flat;
+    for(const BatchTestRecord& record : records)
+    {
+        text += ToString(record) + "\n";
+        json += ToJson(record) + "\n";
+        BinarySerialize(binary, record);
+        FlatSerialize(flat, record);
+    }
+    flat.resize(FlatLayout::Align(flat.size(), FlatLayout::OBJECT_ALIGNMENT));
+
+    for(unsigned threadCount : { 1, 2, 8 })
+    {
+        for(size_t chunkSize : { 1, 7, 1000, 100000 })
+        {
+            BatchOptions options;
+            options.threadCount = threadCount;
+            options.chunkSize = chunkSize;
+            options.windowSize = threadCount == 8 ? 1 : 0;
+            if(chunkSize == 1 && threadCount == 1)
+                continue;
+
+            typedef std::vector<BatchTestRecord>::const_iterator Iterator;
+            assert(RunBatch([](Iterator begin, Iterator end, auto&& sink, const BatchOptions& options)
+                { BatchToString(begin, end, sink, options); }, records, options) == text);
+            assert(RunBatch([](Iterator begin, Iterator end, auto&& sink, const BatchOptions& options)
+                { BatchToJson(begin, end, sink, options); }, records, options) == json);
+            assert(RunBatch([](Iterator begin, Iterator end, auto&& sink, const BatchOptions& options)
+                { BatchBinarySerialize(begin, end, sink, options); }, records, options) == binary);
+            assert(RunBatch([](Iterator begin, Iterator end, auto&& sink, const BatchOptions& options)
+                { BatchFlatSerialize(begin, end, sink, options); }, records, options) == flat);
+        }
+    }
+
+    //  Empty range doesn't call the sink
+    BatchToString(records.end(), records.end(), [](const char*, size_t) { assert(false); });
+}
@@ -0,0 +1,228 @@
+//
+//  Minimal benchmarking helpers shared by *Benchmark.cpp files.
+//  Every benchmark prints ns/op and, where available, retired instructions
+//  per op (Linux perf counters). A file, which defines
+//  BENCHMARK_COUNT_ALLOCATIONS before including this header, replaces global
+//  operator new and also reports allocations and allocated bytes per op.
+//  WriteBenchmarkJson writes all results in machine readable form.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace vklib
+{
+
+inline std::atomic<uint64_t> benchmarkAllocationCount { 0 };
+inline std::atomic<uint64_t> benchmarkAllocatedBytes { 0 };
+
+struct BenchmarkResult
+{
+    std::string name;
+    size_t iterations = 0;
+    double nsPerOp = 0;
+    //  Negative when not measured
+    double allocationsPerOp = -1;
+    double bytesPerOp = -1;
+    double instructionsPerOp = -1;
+};
+
+inline std::vector<BenchmarkResult>& BenchmarkResults()
+{
+    static std::vector<BenchmarkResult> results;
+    return results;
+}
+
+//
+//  Counts user space instructions of the calling thread, if perf events are
+//  available
+//
+class InstructionCounter
+{
+    int _fd = -1;
+
+public:
+    InstructionCounter()
+    {
+#ifdef __linux__
+        perf_event_attr attributes = {};
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        _fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+    }
+
+    InstructionCounter(const InstructionCounter&) = delete;
+    InstructionCounter& operator=(const InstructionCounter&) = delete;
+
+    ~InstructionCounter()
+    {
+#ifdef __linux__
+        if(_fd >= 0)
+            close(_fd);
+#endif
+    }
+
+    bool Available() const { return _fd >= 0; }
+
+    void Start()
+    {
+#ifdef __linux__
+        if(_fd >= 0)
+        {
+            ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    uint64_t Stop()
+    {
+        uint64_t count = 0;
+#ifdef __linux__
+        if(_fd >= 0)
+        {
+            ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if(read(_fd, &count, sizeof(count)) != sizeof(count))
+                count = 0;
+        }
+#endif
+        return count;
+    }
+};
+
+//
+//  Prevents compiler from optimizing away the value computation
+//
+template<class T>
+inline void DoNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+//
+//  Runs function the given number of times and prints average time per call
+//
+template<class FunctionT>
+double Benchmark(const char* name, size_t iterations, FunctionT&& function)
+{
+    for(size_t i = 0; i < iterations / 10 + 1; ++i)
+        function();
+
+    InstructionCounter instructions;
+    const uint64_t allocationCount = benchmarkAllocationCount.load(std::memory_order_relaxed);
+    const uint64_t allocatedBytes = benchmarkAllocatedBytes.load(std::memory_order_relaxed);
+    instructions.Start();
+    const auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+        function();
+    const auto finish = std::chrono::steady_clock::now();
+    const uint64_t instructionCount = instructions.Stop();
+    const uint64_t finishAllocationCount = benchmarkAllocationCount.load(std::memory_order_relaxed);
+    const uint64_t finishAllocatedBytes = benchmarkAllocatedBytes.load(std::memory_order_relaxed);
+
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.nsPerOp = std::chrono::duration<double, std::nano>(finish - start).count() / iterations;
+    std::cout << name << ": " << result.nsPerOp << " ns/op";
+#ifdef BENCHMARK_COUNT_ALLOCATIONS
+    result.allocationsPerOp = double(finishAllocationCount - allocationCount) / iterations;
+    result.bytesPerOp = double(finishAllocatedBytes - allocatedBytes) / iterations;
+    std::cout << ", " << result.allocationsPerOp << " allocs/op, " << result.bytesPerOp << " B/op";
+#else
+    (void)finishAllocationCount;
+    (void)finishAllocatedBytes;
+#endif
+    if(instructions.Available())
+    {
+        result.instructionsPerOp = double(instructionCount) / iterations;
+        std::cout << ", " << result.instructionsPerOp << " instructions/op";
+    }
+    std::cout << std::endl;
+
+    BenchmarkResults().push_back(result);
+    return result.nsPerOp;
+}
+
+//
+//  Writes results of all benchmarks as JSON:
+//  {"benchmarks":[{"name":"...","iterations":1,"ns_per_op":1.5,"allocs_per_op":0,"bytes_per_op":0,"instructions_per_op":null}]}
+//
+inline void WriteBenchmarkJson(std::ostream& stream)
+{
+    const auto writeValue = [&](double value)
+    {
+        if(value < 0)
+            stream << "null";
+        else
+            stream << value;
+    };
+
+    stream << "{\"benchmarks\":[";
+    bool first = true;
+    for(const BenchmarkResult& result : BenchmarkResults())
+    {
+        stream << (first ? "" : ",") << "\n{\"name\":\"";
+        for(char c : result.name)
+        {
+            if(c == '"' || c == '\\')
+                stream << '\\';
+            stream << c;
+        }
+        stream << "\",\"iterations\":" << result.iterations << ",\"ns_per_op\":" << result.nsPerOp;
+        stream << ",\"allocs_per_op\":";
+        writeValue(result.allocationsPerOp);
+        stream << ",\"bytes_per_op\":";
+        writeValue(result.bytesPerOp);
+        stream << ",\"instructions_per_op\":";
+        writeValue(result.instructionsPerOp);
+        stream << "}";
+        first = false;
+    }
+    stream << "\n]}" << std::endl;
+}
+
+};  //  namespace vklib
+
+#ifdef BENCHMARK_COUNT_ALLOCATIONS
+
+void* operator new(size_t size)
+{
+    vklib::benchmarkAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    vklib::benchmarkAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if(void* data = malloc(size ? size : 1))
+        return data;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* data) noexcept
+{
+    free(data);
+}
+
+void operator delete(void* data, size_t) noexcept
+{
+    free(data);
+}
+
+#endif
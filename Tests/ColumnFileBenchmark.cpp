@@ -0,0 +1,72 @@
+#include "../ColumnFile.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+
+using namespace vklib;
+
+class BenchmarkSnapshotRecord
+{
+public:
+    int64_t id = 0;
+    int32_t balance = 0;
+    bool verified = false;
+    double score = 0.0;
+    std::string city;
+    std::string name;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(id, balance, verified, score, city, name);
+};
+
+int main(int argc, char** argv)
+{
+    const size_t rowCount = 100000;
+    const char* cities[] = { "Paris", "Rome", "Oslo", "Berlin" };
+    std::vector<BenchmarkSnapshotRecord> records(rowCount);
+    for(size_t i = 0; i < rowCount; ++i)
+    {
+        records[i].id = 1000000 + i;
+        records[i].balance = static_cast<int32_t>(i % 1000);
+        records[i].verified = i % 100 < 90;
+        records[i].score = i * 0.5;
+        records[i].city = cities[i % 4];
+        records[i].name = "user" + std::to_string(i);
+    }
+
+    std::string binary;
+    BinarySerialize(binary, records);
+    std::string columnar;
+    ColumnSerialize(columnar, records);
+    std::cout << "binary size: " << binary.size() << " bytes, columnar size: " << columnar.size() << " bytes" << std::endl;
+
+    Benchmark("ColumnSerialize 100K rows", 20, [&]()
+    {
+        std::string buffer;
+        ColumnSerialize(buffer, records);
+        DoNotOptimize(buffer);
+    });
+
+    Benchmark("BinaryDeserialize 100K rows", 20, [&]()
+    {
+        std::vector<BenchmarkSnapshotRecord> loaded;
+        DoNotOptimize(BinaryDeserialize(binary, loaded));
+    });
+
+    ColumnFileReader reader;
+    reader.Open(columnar.data(), columnar.size());
+    Benchmark("ColumnFileReader all columns 100K rows", 20, [&]()
+    {
+        std::vector<BenchmarkSnapshotRecord> loaded;
+        DoNotOptimize(reader.Read(loaded));
+    });
+
+    constexpr uint32_t ID = Reflection::FindFieldId<BenchmarkSnapshotRecord>("id");
+    constexpr uint32_t BALANCE = Reflection::FindFieldId<BenchmarkSnapshotRecord>("balance");
+    Benchmark("ColumnFileReader 2 columns 100K rows", 20, [&]()
+    {
+        std::vector<BenchmarkSnapshotRecord> loaded;
+        DoNotOptimize(reader.Read<ID, BALANCE>(loaded));
+    });
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include "../ColumnFile.h"
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+enum class ColumnFileTestState : uint8_t { Active = 1, Blocked = 2, Deleted = 3 };
+
+class ColumnFileTestRecord
+{
+public:
+    int64_t id = 0;
+    int32_t balance = 0;
+    uint16_t random = 0;
+    bool verified = false;
+    ColumnFileTestState state = ColumnFileTestState::Active;
+    double score = 0.0;
+    std::string city;
+    std::string name;
+    std::vector<int32_t> tags;
+    std::map<std::string, int32_t> counters;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(id, balance, random, verified, state, score, city, name, tags, counters);
+};
+
+//
+//  Later version of the record: fields are removed, reordered and added
+//
+class ColumnFileTestRecordV2
+{
+public:
+    std::string name;
+    int64_t id = 0;
+    int32_t added = 7;
+
+    REFLECTABLE_FIELDS(name, id, added);
+};
+
+static std::vector<ColumnFileTestRecord> MakeRecords(size_t count)
+{
+    const char* cities[] = { "Paris", "Rome", "Oslo" };
+    std::vector<ColumnFileTestRecord> records(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        ColumnFileTestRecord& record = records[i];
+        record.id = 1000000000000 + i * 3;
+        record.balance = static_cast<int32_t>(i % 7) * 1000 - 3000;
+        record.random = static_cast<uint16_t>(i * 40503);
+        record.verified = i >= count / 2;
+        record.state = i % 10 == 0 ? ColumnFileTestState::Blocked : ColumnFileTestState::Active;
+        record.score = i * 0.25;
+        record.city = cities[i % 3];
+        record.name = "user" + std::to_string(i);
+        record.tags.assign(i % 3, static_cast<int32_t>(i));
+        if(i % 5 == 0)
+            record.counters["visits"] = static_cast<int32_t>(i);
+    }
+    return records;
+}
+
+static ColumnEncoding GetEncoding(const ColumnFileReader& reader, const char* name)
+{
+    const ColumnFileReader::Column* column = reader.FindColumn(name);
+    assert(column);
+    return column->encoding;
+}
+
+void ColumnFileTest()
+{
+    typedef ColumnFileTestRecord Record;
+    const std::vector<Record> records = MakeRecords(1000);
+    std::vector<uint8_t> buffer;
+    ColumnSerialize(buffer, records);
+
+    //  Encodings are chosen by values
+    ColumnFileReader reader;
+    assert(reader.Open(buffer.data(), buffer.size()));
+    assert(reader.GetRowCount() == records.size() && reader.GetColumns().size() == 10);
+    assert(GetEncoding(reader, "id") == ColumnEncoding::Delta);
+    assert(GetEncoding(reader, "balance") == ColumnEncoding::FrameOfReference);
+    assert(GetEncoding(reader, "random") == ColumnEncoding::Plain);
+    assert(GetEncoding(reader, "verified") == ColumnEncoding::RunLength);
+    assert(GetEncoding(reader, "state") == ColumnEncoding::FrameOfReference);
+    assert(GetEncoding(reader, "score") == ColumnEncoding::Plain);
+    assert(GetEncoding(reader, "city") == ColumnEncoding::Dictionary);
+    assert(GetEncoding(reader, "name") == ColumnEncoding::Strings);
+    assert(GetEncoding(reader, "tags") == ColumnEncoding::Binary);
+    assert(buffer.size() < records.size() * 40);
+
+    //  All columns
+    std::vector<Record> loaded;
+    assert(reader.Read(loaded));
+    assert(loaded.size() == records.size());
+    for(size_t i = 0; i < records.size(); ++i)
+        assert(Reflection::Equal(loaded[i], records[i]));
+
+    //  Requested columns only
+    constexpr uint32_t ID = Reflection::FindFieldId<Record>("id");
+    constexpr uint32_t CITY = Reflection::FindFieldId<Record>("city");
+    std::vector<Record> partial;
+    assert((reader.Read<ID, CITY>(partial)));
+    assert(partial[5].id == records[5].id && partial[5].city == records[5].city && partial[5].name.empty());
+
+    std::vector<bool> verified;
+    assert((reader.ReadColumn<Record, Reflection::FindFieldId<Record>("verified")>(verified)));
+    assert(verified.size() == records.size() && !verified[0] && verified.back());
+
+    //  Columns are matched by names
+    std::vector<ColumnFileTestRecordV2> upgraded;
+    assert(reader.Read(upgraded));
+    assert(upgraded[7].name == "user7" && upgraded[7].id == records[7].id && upgraded[7].added == 7);
+
+    //  Mapped file
+    const char* path = "ColumnFileTest.vkcf";
+    assert(WriteColumnFile(path, records));
+    ColumnFileReader fileReader;
+    assert(fileReader.Open(path));
+    std::vector<Record> mapped;
+    assert(fileReader.Read(mapped) && Reflection::Equal(mapped[999], records[999]));
+    std::remove(path);
+
+    //  Empty set
+    buffer.clear();
+    ColumnSerialize(buffer, std::vector<Record>());
+    assert(reader.Open(buffer.data(), buffer.size()) && reader.GetRowCount() == 0);
+    assert(reader.Read(loaded) && loaded.empty());
+
+    //  Truncated files are rejected or fail to decode
+    buffer.clear();
+    ColumnSerialize(buffer, MakeRecords(20));
+    for(size_t size = 0; size < buffer.size(); ++size)
+        assert(!reader.Open(buffer.data(), size) || !reader.Read(loaded));
+
+    //  Count of rows in the header exceeding the columns is rejected by Open,
+    //  smaller one fails to decode
+    for(const uint64_t rowCount : { uint64_t(19), uint64_t(21), uint64_t(1) << 40, ~uint64_t(0) })
+    {
+        std::vector<uint8_t> corrupted = buffer;
+        memcpy(&corrupted[8], &rowCount, sizeof(rowCount));
+        if(rowCount < 20)
+            assert(!reader.Open(corrupted.data(), corrupted.size()) || !reader.Read(loaded));
+        else
+            assert(!reader.Open(corrupted.data(), corrupted.size()));
+    }
+
+    //  Without columns count of rows isn't bounded by them, but by size of the file
+    std::vector<uint8_t> header(ColumnCodec::HEADER_SIZE);
+    const uint32_t magic = ColumnCodec::MAGIC;
+    const uint32_t version = ColumnCodec::VERSION;
+    const uint64_t hugeRowCount = uint64_t(1) << 56;
+    memcpy(&header[0], &magic, sizeof(magic));
+    memcpy(&header[4], &version, sizeof(version));
+    memcpy(&header[8], &hugeRowCount, sizeof(hugeRowCount));
+    assert(!reader.Open(header.data(), header.size()));
+
+    //  Columns of equal values still bound count of rows
+    std::vector<ColumnFileTestRecordV2> constant(100000);
+    buffer.clear();
+    ColumnSerialize(buffer, constant);
+    assert(buffer.size() < constant.size() && reader.Open(buffer.data(), buffer.size()));
+    assert(GetEncoding(reader, "id") == ColumnEncoding::RunLength && GetEncoding(reader, "name") == ColumnEncoding::Dictionary);
+    assert(reader.Read(upgraded) && upgraded.size() == constant.size() && upgraded.back().added == 7);
+    for(const uint64_t rowCount : { uint64_t(100001), hugeRowCount })
+    {
+        std::vector<uint8_t> corrupted = buffer;
+        memcpy(&corrupted[8], &rowCount, sizeof(rowCount));
+        assert(!reader.Open(corrupted.data(), corrupted.size()));
+    }
+}
@@ -0,0 +1,96 @@
+#include "../ColumnStore.h"
+#include "Benchmark.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+class ColumnStoreBenchmarkRecord
+{
+public:
+    int64_t id = 0;
+    int32_t region = 0;
+    int32_t day = 0;
+    int64_t amount = 0;
+    double price = 0.0;
+    double weight = 0.0;
+    bool active = false;
+    std::string comment;
+
+    REFLECTABLE_FIELDS(id, region, day, amount, price, weight, active, comment);
+};
+
+int main(int argc, char** argv)
+{
+    typedef ColumnStoreBenchmarkRecord Record;
+    constexpr uint32_t DAY = Reflection::FindFieldId<Record>("day");
+    constexpr uint32_t AMOUNT = Reflection::FindFieldId<Record>("amount");
+    constexpr uint32_t PRICE = Reflection::FindFieldId<Record>("price");
+
+    std::mt19937 random(1);
+    std::vector<Record> records(4000000);
+    ReflectableColumnStore<Record> store;
+    store.reserve(records.size());
+    for(Record& record : records)
+    {
+        record.id = random();
+        record.region = random() % 16;
+        record.day = random() % 365;
+        record.amount = random() % 100000;
+        record.price = random() / 100.0;
+        store.push_back(record);
+    }
+
+    std::vector<uint32_t> rows;
+    rows.reserve(records.size());
+
+    Benchmark("Sum of int64 field, std::vector", 10, [&]()
+    {
+        int64_t sum = 0;
+        for(const Record& record : records)
+            sum += record.amount;
+        DoNotOptimize(sum);
+    });
+
+    Benchmark("Sum of int64 field, ReflectableColumnStore", 10, [&]()
+    {
+        DoNotOptimize(store.Sum<AMOUNT>());
+    });
+
+    Benchmark("MinMax of double field, std::vector", 10, [&]()
+    {
+        double minValue = records[0].price;
+        double maxValue = records[0].price;
+        for(const Record& record : records)
+        {
+            minValue = record.price < minValue ? record.price : minValue;
+            maxValue = maxValue < record.price ? record.price : maxValue;
+        }
+        DoNotOptimize(minValue);
+        DoNotOptimize(maxValue);
+    });
+
+    Benchmark("MinMax of double field, ReflectableColumnStore", 10, [&]()
+    {
+        DoNotOptimize(store.MinMax<PRICE>());
+    });
+
+    Benchmark("Filter by int32 field, std::vector", 10, [&]()
+    {
+        rows.clear();
+        for(size_t i = 0; i < records.size(); ++i)
+        {
+            if(records[i].day < 30)
+                rows.push_back(static_cast<uint32_t>(i));
+        }
+        DoNotOptimize(rows.size());
+    });
+
+    Benchmark("Filter by int32 field, ReflectableColumnStore", 10, [&]()
+    {
+        rows.clear();
+        DoNotOptimize(store.Filter<DAY>([](int32_t day) { return day < 30; }, rows));
+    });
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "../ColumnStore.h"
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+class ColumnStoreTestRecord
+{
+public:
+    int32_t id = 0;
+    double price = 0.0;
+    bool active = false;
+    std::string name;
+    std::vector<int> tags;
+
+    REFLECTABLE_FIELDS(id, price, active, name, tags);
+};
+
+static ColumnStoreTestRecord MakeRecord(int32_t id)
+{
+    ColumnStoreTestRecord record;
+    record.id = id;
+    record.price = id * 0.5 - 10;
+    record.active = id % 3 == 0;
+    record.name = "record" + std::to_string(id);
+    record.tags.assign(id % 4, id);
+    return record;
+}
+
+void ColumnStoreTest()
+{
+    typedef ColumnStoreTestRecord Record;
+    constexpr uint32_t ID = Reflection::FindFieldId<Record>("id");
+    constexpr uint32_t PRICE = Reflection::FindFieldId<Record>("price");
+    constexpr uint32_t ACTIVE = Reflection::FindFieldId<Record>("active");
+    constexpr uint32_t NAME = Reflection::FindFieldId<Record>("name");
+    static_assert(std::is_same<Reflection::FieldType<Record, NAME>, std::string>::value, "Wrong field type");
+    static_assert(std::is_same<ReflectableColumnStore<Record>::ColumnType<ACTIVE>, uint8_t>::value, "Wrong column type");
+
+    ReflectableColumnStore<Record> store;
+    assert(store.empty());
+    store.reserve(100);
+    for(int32_t id = 0; id < 100; ++id)
+    {
+        Record record = MakeRecord(id);
+        if(id % 2)
+            store.push_back(record);
+        else
+            store.push_back(std::move(record));
+    }
+    assert(store.size() == 100);
+
+    //  Materialization
+    for(int32_t id = 0; id < 100; ++id)
+        assert(Reflection::Equal(store.Get(id), MakeRecord(id)));
+
+    Record record = MakeRecord(1000);
+    store.Set(5, record);
+    store.Get(6, record);
+    assert(Reflection::Equal(record, MakeRecord(6)));
+    assert(Reflection::Equal(store.Get(5), MakeRecord(1000)));
+    store.Set(5, MakeRecord(5));
+
+    //  Columns and scans
+    assert(store.Column<NAME>().size() == 100);
+    assert(store.Column<NAME>()[42] == "record42");
+    store.Column<ID>()[0] = 7;
+    assert(store.Get(0).id == 7);
+    store.Column<ID>()[0] = 0;
+
+    assert(store.Sum<ID>() == 99 * 100 / 2);
+    assert(store.Sum<PRICE>() == 99 * 100 / 4 - 1000);
+    assert(store.Sum<ACTIVE>() == 34);
+    assert(store.MinMax<ID>() == std::make_pair(0, 99));
+    assert(store.MinMax<PRICE>() == std::make_pair(-10.0, 39.5));
+
+    std::vector<uint32_t> rows { 1000 };
+    assert(store.Filter<PRICE>([](double price) { return price > 35; }, rows) == 9);
+    assert(rows.size() == 10 && rows[0] == 1000 && rows[1] == 91 && rows[9] == 99);
+
+    store.clear();
+    assert(store.empty() && store.Column<ID>().empty());
+}
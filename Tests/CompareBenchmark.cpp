@@ -0,0 +1,59 @@
+#include "../Reflection.h"
+#include "Benchmark.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace vklib;
+
+class CompareBenchmarkRow
+{
+public:
+    int32_t region = 0;
+    int32_t day = 0;
+    int64_t account = 0;
+    int64_t sequence = 0;
+    std::string comment;
+
+    REFLECTABLE_FIELDS(region, day, account, sequence, comment);
+};
+
+int main(int argc, char** argv)
+{
+    std::mt19937 random(1);
+    std::vector<CompareBenchmarkRow> rows(1000000);
+    for(CompareBenchmarkRow& row : rows)
+    {
+        row.region = random() % 4;
+        row.day = random() % 16;
+        row.account = random() % 64;
+        row.sequence = random();
+    }
+
+    const CompareBenchmarkRow copy = rows[0];
+    Benchmark("Compare equal", 10000000, [&]()
+    {
+        DoNotOptimize(Reflection::Compare(rows[0], copy));
+    });
+
+    Benchmark("Sort 1M rows", 1, [&]()
+    {
+        std::vector<CompareBenchmarkRow> copy = rows;
+        std::sort(copy.begin(), copy.end(), vklib::Less<CompareBenchmarkRow>());
+        DoNotOptimize(copy.front().sequence);
+    });
+
+    Benchmark("Sort 1M rows with std::tie", 1, [&]()
+    {
+        std::vector<CompareBenchmarkRow> copy = rows;
+        std::sort(copy.begin(), copy.end(), [](const CompareBenchmarkRow& a, const CompareBenchmarkRow& b)
+        {
+            return std::tie(a.region, a.day, a.account, a.sequence, a.comment)
+                < std::tie(b.region, b.day, b.account, b.sequence, b.comment);
+        });
+        DoNotOptimize(copy.front().sequence);
+    });
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "../Reflection.h"
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+class CompareTestKey
+{
+public:
+    int32_t major = 0;
+    int32_t minor = 0;
+    uint16_t patch = 0;
+
+    REFLECTABLE_FIELDS(major, minor, patch);
+};
+
+class CompareTestClass
+{
+public:
+    std::string name;
+    CompareTestKey key;
+    double weight = 0.0;
+    std::vector<int> values;
+    std::shared_ptr<int> pointer;
+
+    REFLECTABLE_FIELDS(name, key, weight, values, pointer);
+};
+
+static CompareTestKey MakeKey(int32_t major, int32_t minor, uint16_t patch)
+{
+    CompareTestKey key;
+    key.major = major;
+    key.minor = minor;
+    key.patch = patch;
+    return key;
+}
+
+static void LexicographicTest()
+{
+    //  The first differing field decides, later fields don't matter
+    assert(Reflection::Compare(MakeKey(1, 5, 5), MakeKey(2, 0, 0)) < 0);
+    assert(Reflection::Compare(MakeKey(2, 0, 0), MakeKey(1, 5, 5)) > 0);
+    assert(Reflection::Compare(MakeKey(1, 2, 3), MakeKey(1, 2, 3)) == 0);
+    assert(Reflection::Compare(MakeKey(1, 2, 3), MakeKey(1, 2, 4)) < 0);
+    assert(Reflection::Compare(MakeKey(-1, 0, 0), MakeKey(1, 0, 0)) < 0);
+
+    assert(MakeKey(1, 5, 5) < MakeKey(2, 0, 0));
+    assert(!(MakeKey(2, 0, 0) < MakeKey(1, 5, 5)));
+    assert(!(MakeKey(1, 2, 3) < MakeKey(1, 2, 3)));
+    assert(MakeKey(1, 2, 3) <= MakeKey(1, 2, 3));
+    assert(MakeKey(1, 2, 4) > MakeKey(1, 2, 3));
+    assert(MakeKey(1, 2, 3) >= MakeKey(1, 2, 3));
+    assert(MakeKey(1, 2, 3) == MakeKey(1, 2, 3));
+    assert(MakeKey(1, 2, 3) != MakeKey(1, 3, 3));
+}
+
+static void NestedTest()
+{
+    CompareTestClass obj1;
+    CompareTestClass obj2;
+    obj1.name = obj2.name = "name";
+    obj1.key = MakeKey(1, 2, 3);
+    obj2.key = MakeKey(1, 2, 3);
+    obj1.values = { 1, 2, 3 };
+    obj2.values = { 1, 2, 3 };
+    assert(Reflection::Equal(obj1, obj2));
+    assert(Reflection::Compare(obj1, obj2) == 0);
+
+    obj2.values.push_back(0);
+    assert(!Reflection::Equal(obj1, obj2));
+    assert(Reflection::Compare(obj1, obj2) < 0);
+
+    obj2.values = { 1, 2, 3 };
+    obj2.weight = -0.0;
+    assert(Reflection::Equal(obj1, obj2));
+
+    obj2.key.minor = 1;
+    assert(!Reflection::Equal(obj1, obj2));
+    assert(Reflection::Compare(obj1, obj2) > 0);
+
+    obj2.name = "a";
+    assert(Reflection::Compare(obj1, obj2) > 0);
+    obj2.name = "z";
+    assert(Reflection::Compare(obj1, obj2) < 0);
+}
+
+static void SortTest()
+{
+    std::vector<CompareTestKey> keys;
+    for(int32_t i = 0; i < 1000; ++i)
+        keys.push_back(MakeKey(i % 7, (i * 31) % 11, static_cast<uint16_t>(i % 3)));
+
+    std::sort(keys.begin(), keys.end(), vklib::Less<CompareTestKey>());
+    for(size_t i = 1; i < keys.size(); ++i)
+    {
+        const CompareTestKey& a = keys[i - 1];
+        const CompareTestKey& b = keys[i];
+        assert(std::make_tuple(a.major, a.minor, a.patch) <= std::make_tuple(b.major, b.minor, b.patch));
+    }
+
+    std::map<CompareTestKey, int, vklib::Less<CompareTestKey>> map;
+    for(int32_t i = 0; i < 1000; ++i)
+        ++map[MakeKey(i % 7, (i * 31) % 11, static_cast<uint16_t>(i % 3))];
+    int total = 0;
+    for(auto& item : map)
+        total += item.second;
+    assert(total == 1000);
+    assert(map.size() == 7 * 11 * 3);
+}
+
+void CompareTest()
+{
+    LexicographicTest();
+    NestedTest();
+    SortTest();
+}
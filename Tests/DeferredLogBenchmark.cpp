@@ -0,0 +1,63 @@
+#include "../DeferredLog.h"
+#include "../ToString.h"
+#include "Benchmark.h"
+#include <string>
+
+using namespace vklib;
+
+class DeferredLogBenchmarkNarrow
+{
+public:
+    int64_t id = 1;
+    int32_t code = 2;
+    double value = 3.5;
+
+    REFLECTABLE_FIELDS(id, code, value);
+};
+
+class DeferredLogBenchmarkWide
+{
+public:
+    int64_t f0 = 0, f1 = 1, f2 = 2, f3 = 3, f4 = 4, f5 = 5, f6 = 6, f7 = 7;
+    double d0 = 0.5, d1 = 1.5, d2 = 2.5, d3 = 3.5, d4 = 4.5, d5 = 5.5, d6 = 6.5, d7 = 7.5;
+    int32_t i0 = 0, i1 = 1, i2 = 2, i3 = 3, i4 = 4, i5 = 5, i6 = 6, i7 = 7;
+    std::string name = "wide benchmark object";
+
+    REFLECTABLE_FIELDS(f0, f1, f2, f3, f4, f5, f6, f7, d0, d1, d2, d3, d4, d5, d6, d7,
+        i0, i1, i2, i3, i4, i5, i6, i7, name);
+};
+
+int main(int argc, char** argv)
+{
+    const size_t iterations = 200000;
+    DeferredLogBenchmarkNarrow narrow;
+    DeferredLogBenchmarkWide wide;
+
+    Benchmark("ToString of 3 field object", iterations, [&]()
+    {
+        DoNotOptimize(ToString(narrow));
+    });
+
+    Benchmark("ToString of 25 field object", iterations, [&]()
+    {
+        DoNotOptimize(ToString(wide));
+    });
+
+    size_t lineCount = 0;
+    DeferredLogger logger([&](std::string_view line) { lineCount += line.size() > 0; }, size_t(1) << 26);
+
+    Benchmark("DeferredLogger::Log of 3 field object", iterations, [&]()
+    {
+        DoNotOptimize(logger.Log(narrow));
+    });
+    logger.Flush();
+
+    Benchmark("DeferredLogger::Log of 25 field object", iterations, [&]()
+    {
+        DoNotOptimize(logger.Log(wide));
+    });
+    logger.Flush();
+
+    std::cout << "dropped: " << logger.GetDroppedCount() << std::endl;
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include "../DeferredLog.h"
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace vklib;
+
+class DeferredLogTestPoint
+{
+public:
+    int32_t x = 0;
+    int32_t y = 0;
+
+    REFLECTABLE_FIELDS(x, y);
+};
+
+class DeferredLogTestRecord
+{
+public:
+    uint64_t id = 0;
+    std::string name;
+    double value = 0;
+    bool flag = false;
+    DeferredLogTestPoint point;
+    std::vector<int32_t> numbers;
+    std::vector<std::string> tags;
+
+    REFLECTABLE_FIELDS(id, name, value, flag, point, numbers, tags);
+};
+
+//
+//  Trivially copyable, but text is referenced by address
+//
+class DeferredLogTestView
+{
+public:
+    int32_t id = 0;
+    const char* text = nullptr;
+    std::string_view view;
+    const char* empty = nullptr;
+
+    REFLECTABLE_FIELDS(id, text, view, empty);
+};
+
+static DeferredLogTestRecord MakeRecord(uint64_t id)
+{
+    DeferredLogTestRecord record;
+    record.id = id;
+    record.name = "record" + std::to_string(id);
+    record.value = id * 0.25;
+    record.flag = id % 2;
+    record.point.x = static_cast<int32_t>(id);
+    record.point.y = -static_cast<int32_t>(id);
+    record.numbers.assign(id % 4, static_cast<int32_t>(id));
+    record.tags.assign(id % 3, "tag");
+    return record;
+}
+
+void DeferredLogTest()
+{
+    {
+        const DeferredLogTestRecord record = MakeRecord(5);
+        std::string buffer(DeferredCapture::GetSize(record), '\0');
+        uint8_t* data = reinterpret_cast<uint8_t*>(&buffer[0]);
+        assert(DeferredCapture::Write(data, record) == data + buffer.size());
+
+        DeferredLogTestRecord decoded;
+        assert(DeferredCapture::Read(data, decoded) == data + buffer.size());
+        assert(ToString(decoded) == ToString(record));
+    }
+
+    //  Order of records of every thread is kept, records aren't lost
+    {
+        const size_t threadCount = 4;
+        const size_t recordCount = 2000;
+        std::vector<std::vector<std::string>> lines(threadCount);
+        std::vector<std::string> expected;
+        for(size_t i = 0; i < threadCount * recordCount; ++i)
+        {
+            const DeferredLogTestRecord record = MakeRecord(i);
+            expected.push_back(ToString(record));
+        }
+
+        {
+            DeferredLogger logger([&](std::string_view line)
+            {
+                const size_t id = std::stoul(std::string(line.substr(line.find("id=") + 3)));
+                lines[id / recordCount].emplace_back(line);
+            }, 4096);
+
+            std::vector<std::thread> threads;
+            for(size_t thread = 0; thread < threadCount; ++thread)
+            {
+                threads.emplace_back([&, thread]()
+                {
+                    for(size_t i = 0; i < recordCount; ++i)
+                    {
+                        const DeferredLogTestRecord record = MakeRecord(thread * recordCount + i);
+                        while(!logger.Log(record))
+                            std::this_thread::yield();
+                    }
+                });
+            }
+            for(std::thread& thread : threads)
+                thread.join();
+            logger.Flush();
+
+            for(size_t thread = 0; thread < threadCount; ++thread)
+            {
+                assert(lines[thread].size() == recordCount);
+                for(size_t i = 0; i < recordCount; ++i)
+                    assert(lines[thread][i] == expected[thread * recordCount + i]);
+            }
+        }
+    }
+
+    //  Records, which don't fit the ring, are dropped; destructor formats the rest
+    {
+        std::vector<std::string> lines;
+        {
+            DeferredLogger logger([&](std::string_view line) { lines.emplace_back(line); }, 256);
+            DeferredLogTestRecord record = MakeRecord(1);
+            record.name.assign(300, 'a');
+            assert(!logger.Log(record));
+            assert(logger.GetDroppedCount() == 1);
+            assert(logger.Log(MakeRecord(2)));
+        }
+        const DeferredLogTestRecord record = MakeRecord(2);
+        assert(lines.size() == 1);
+        assert(lines[0] == ToString(record));
+    }
+
+    //  Text referenced by pointers is copied when logged, so the source can
+    //  be freed before formatting
+    {
+        std::vector<std::string> lines;
+        {
+            DeferredLogger logger([&](std::string_view line) { lines.emplace_back(line); });
+            {
+                std::unique_ptr<std::string> text(new std::string("pointed text, long enough to be on heap"));
+                DeferredLogTestView view;
+                view.id = 7;
+                view.text = text->c_str();
+                view.view = std::string_view(*text).substr(0, 7);
+                view.empty = "";
+                assert(logger.Log(view));
+                text->assign(text->size(), 'x');
+            }
+            logger.Flush();
+        }
+        assert(lines.size() == 1);
+        assert(lines[0] == "{id=7,text=pointed text, long enough to be on heap,view=pointed,empty=}");
+
+        DeferredLogTestView view;
+        view.text = "text";
+        std::string buffer(DeferredCapture::GetSize(view), '\0');
+        uint8_t* data = reinterpret_cast<uint8_t*>(&buffer[0]);
+        assert(DeferredCapture::Write(data, view) == data + buffer.size());
+        DeferredLogTestView decoded;
+        decoded.empty = "stale";
+        assert(DeferredCapture::Read(data, decoded) == data + buffer.size());
+        assert(decoded.text == buffer.data() + 2 * sizeof(uint32_t) && !decoded.empty);
+    }
+}
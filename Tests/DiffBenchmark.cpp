@@ -0,0 +1,71 @@
+#include "../Diff.h"
+#include "Benchmark.h"
+#include <string>
+
+using namespace vklib;
+
+//
+//  State struct, where one counter changes between replications
+//
+class DiffBenchmarkState
+{
+public:
+    int64_t f00 = 0, f01 = 1, f02 = 2, f03 = 3, f04 = 4, f05 = 5, f06 = 6, f07 = 7, f08 = 8, f09 = 9;
+    int64_t f10 = 0, f11 = 1, f12 = 2, f13 = 3, f14 = 4, f15 = 5, f16 = 6, f17 = 7, f18 = 8, f19 = 9;
+    double d00 = 0, d01 = 1, d02 = 2, d03 = 3, d04 = 4, d05 = 5, d06 = 6, d07 = 7, d08 = 8, d09 = 9;
+    std::string s00 = "string field 0", s01 = "string field 1", s02 = "string field 2", s03 = "string field 3";
+    std::string s04 = "string field 4", s05 = "string field 5", s06 = "string field 6", s07 = "string field 7";
+    uint64_t counter = 0;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(f00, f01, f02, f03, f04, f05, f06, f07, f08, f09,
+        f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, d00, d01, d02, d03, d04, d05, d06, d07, d08, d09,
+        s00, s01, s02, s03, s04, s05, s06, s07, counter);
+};
+
+int main(int argc, char** argv)
+{
+    typedef DiffBenchmarkState State;
+    constexpr uint32_t COUNTER = Reflection::FindFieldId<State>("counter");
+
+    State previous;
+    State state;
+    Tracked<State> tracked;
+    State replica;
+    std::string buffer;
+
+    std::cout << "Full state: ";
+    BinarySerialize(buffer, state);
+    std::cout << buffer.size() << " bytes, delta: ";
+    buffer.clear();
+    state.counter = 1;
+    Diff(buffer, previous, state);
+    std::cout << buffer.size() << " bytes" << std::endl;
+
+    Benchmark("BinarySerialize + BinaryDeserialize", 1000000, [&]()
+    {
+        ++state.counter;
+        buffer.clear();
+        BinarySerialize(buffer, state);
+        BinaryDeserialize(buffer, replica);
+        DoNotOptimize(replica.counter);
+    });
+
+    Benchmark("Diff + Apply", 1000000, [&]()
+    {
+        ++state.counter;
+        buffer.clear();
+        Diff(buffer, previous, state);
+        Apply(previous, buffer);
+        DoNotOptimize(previous.counter);
+    });
+
+    Benchmark("Tracked Diff + Apply", 1000000, [&]()
+    {
+        ++tracked.Mutable<COUNTER>();
+        buffer.clear();
+        Diff(buffer, tracked);
+        Apply(replica, buffer);
+        DoNotOptimize(replica.counter);
+    });
+    return 0;
+}
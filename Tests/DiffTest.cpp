@@ -0,0 +1,119 @@
+#include "../Diff.h"
+#include "../ToString.h"
+#include <cassert>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+class DiffTestPosition
+{
+public:
+    double x = 0.0;
+    double y = 0.0;
+
+    REFLECTABLE_FIELDS(x, y);
+};
+
+class DiffTestState
+{
+public:
+    uint64_t counter = 0;
+    std::string name = "state";
+    DiffTestPosition position;
+    std::vector<int> values { 1, 2, 3 };
+    std::map<std::string, int> scores { { "a", 1 } };
+    bool active = false;
+
+    REFLECTABLE_FIELDS(counter, name, position, values, scores, active);
+};
+
+static void DiffApplyTest()
+{
+    DiffTestState from;
+    DiffTestState to;
+
+    std::string delta;
+    assert(!Diff(delta, from, to));
+    assert(delta.size() == 1);
+    DiffTestState replica;
+    assert(Apply(replica, delta));
+    assert(Reflection::Equal(replica, to));
+
+    //  One counter changed: tag and value only
+    to.counter = 5;
+    delta.clear();
+    assert(Diff(delta, from, to));
+    assert(delta.size() == 1 + sizeof(uint64_t) + 1);
+    assert(Apply(replica, delta));
+    assert(replica.counter == 5);
+    assert(Reflection::Equal(replica, to));
+
+    //  Nested field carries only changed subfields
+    to.position.y = 2.5;
+    to.values.push_back(4);
+    to.scores["b"] = 2;
+    delta.clear();
+    assert(Diff(delta, replica, to));
+    std::string fullDelta;
+    DiffWriter<std::string>(fullDelta).WriteAll(to);
+    assert(delta.size() < fullDelta.size());
+    assert(Apply(replica, delta));
+    assert(replica.position.x == 0.0 && replica.position.y == 2.5);
+    assert(Reflection::Equal(replica, to));
+
+    //  Full delta recreates the object
+    DiffTestState other;
+    other.name = "other";
+    assert(Apply(other, fullDelta));
+    assert(ToString(other) == ToString(to));
+
+    //  Corrupted deltas are rejected
+    assert(!Apply(replica, fullDelta.data(), fullDelta.size() - 1));
+    std::string trailing = delta + '\0';
+    assert(!Apply(replica, trailing));
+    const char wrongField[] = { 100, 0 };
+    assert(!Apply(replica, wrongField, sizeof(wrongField)));
+    const char wrongNested[] = { (1 + 1) << 1 | 1, 0, 0 };
+    assert(!Apply(replica, wrongNested, sizeof(wrongNested)));
+}
+
+static void TrackedTest()
+{
+    typedef DiffTestState State;
+    constexpr uint32_t COUNTER = Reflection::FindFieldId<State>("counter");
+    constexpr uint32_t POSITION = Reflection::FindFieldId<State>("position");
+    constexpr uint32_t NAME = Reflection::FindFieldId<State>("name");
+    constexpr uint32_t VALUES = Reflection::FindFieldId<State>("values");
+
+    Tracked<State> state;
+    State replica;
+    std::string delta;
+    assert(!Diff(delta, state));
+    assert(delta.size() == 1);
+
+    state.Set<COUNTER>(7);
+    state.Mutable<VALUES>().push_back(9);
+    state.Mutable<POSITION>().x = 1.0;
+    assert(state.GetDirty().Test(COUNTER) && state.GetDirty().Test(VALUES) && !state.GetDirty().Test(NAME));
+
+    delta.clear();
+    assert(Diff(delta, state));
+    assert(!state.GetDirty().Any());
+    assert(Apply(replica, delta));
+    assert(Reflection::Equal(replica, state.Get()));
+    assert(state.Get<COUNTER>() == 7);
+
+    state.MutableAll().name = "renamed";
+    delta.clear();
+    assert(Diff(delta, state));
+    assert(Apply(replica, delta));
+    assert(replica.name == "renamed");
+}
+
+void DiffTest()
+{
+    DiffApplyTest();
+    TrackedTest();
+}
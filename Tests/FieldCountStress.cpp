@@ -0,0 +1,76 @@
+//
+//  Compile time stress test of Reflection for a class with FIELD_COUNT fields.
+//  Built by "make compile-benchmark" for several field counts, which reports
+//  compile time and generated code size for each of them.
+//
+
+#include "../Reflection.h"
+#include "../ToString.h"
+#include <boost/preprocessor/cat.hpp>
+#include <boost/preprocessor/repetition/repeat.hpp>
+
+#ifndef FIELD_COUNT
+#define FIELD_COUNT 10
+#endif
+
+#define STRESS_FIELD(z, n, data)    int BOOST_PP_CAT(field, n) = n;
+#define STRESS_FIELD_SEQ(z, n, data)    (BOOST_PP_CAT(field, n))
+
+using namespace vklib;
+
+class StressClass
+{
+    BOOST_PP_REPEAT(FIELD_COUNT, STRESS_FIELD, _)
+
+    REFLECTABLE_FIELDS_FROM_SEQ(BOOST_PP_REPEAT(FIELD_COUNT, STRESS_FIELD_SEQ, _))
+};
+
+class StressVisitor
+{
+public:
+    long sum = 0;
+
+    template<class T>
+    bool VisitField(const char* fieldName, const T& value)
+    {
+        sum += value;
+        return true;
+    }
+};
+
+long VisitStress(StressClass& obj)
+{
+    StressVisitor visitor;
+    Reflection::VisitFields(obj, visitor);
+    return visitor.sum;
+}
+
+bool EqualStress(const StressClass& obj1, const StressClass& obj2)
+{
+    return Reflection::Equal(obj1, obj2);
+}
+
+bool LessStress(const StressClass& obj1, const StressClass& obj2)
+{
+    return Reflection::Less(obj1, obj2);
+}
+
+size_t HashStress(const StressClass& obj)
+{
+    return Reflection::Hash(obj);
+}
+
+void CopyStress(StressClass& target, const StressClass& source)
+{
+    Reflection::Copy(target, source);
+}
+
+void MoveStress(StressClass& target, StressClass& source)
+{
+    Reflection::Move(target, std::move(source));
+}
+
+std::string ToStringStress(StressClass& obj)
+{
+    return ToString(obj);
+}
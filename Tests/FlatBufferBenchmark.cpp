@@ -0,0 +1,65 @@
+#include "../FlatBuffer.h"
+#include "../Serialization.h"
+#include "Benchmark.h"
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+//
+//  Routing layer message: 40 fields, two of them are inspected
+//
+class FlatBufferBenchmarkMessage
+{
+public:
+    uint64_t id = 1;
+    std::string route = "service/method";
+    int32_t i00 = 0, i01 = 1, i02 = 2, i03 = 3, i04 = 4, i05 = 5, i06 = 6, i07 = 7, i08 = 8, i09 = 9;
+    double d00 = 0, d01 = 1, d02 = 2, d03 = 3, d04 = 4, d05 = 5, d06 = 6, d07 = 7, d08 = 8, d09 = 9;
+    std::string s00 = "string field 0", s01 = "string field 1", s02 = "string field 2", s03 = "string field 3";
+    std::string s04 = "string field 4", s05 = "string field 5", s06 = "string field 6", s07 = "string field 7";
+    std::vector<int64_t> v00 = std::vector<int64_t>(16, 1), v01 = std::vector<int64_t>(16, 2);
+    std::vector<int64_t> v02 = std::vector<int64_t>(16, 3), v03 = std::vector<int64_t>(16, 4);
+    std::vector<std::string> t00 { "a", "b", "c" }, t01 { "d", "e" }, t02 { "f" }, t03 { "g", "h" };
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(id, route, i00, i01, i02, i03, i04, i05, i06, i07, i08, i09,
+        d00, d01, d02, d03, d04, d05, d06, d07, d08, d09, s00, s01, s02, s03, s04, s05, s06, s07,
+        v00, v01, v02, v03, t00, t01, t02, t03);
+};
+
+int main(int argc, char** argv)
+{
+    typedef FlatBufferBenchmarkMessage Message;
+    constexpr uint32_t ID = Reflection::FindFieldId<Message>("id");
+    constexpr uint32_t ROUTE = Reflection::FindFieldId<Message>("route");
+
+    const Message message;
+    std::string binary;
+    BinarySerialize(binary, message);
+    std::string flat;
+    FlatSerialize(flat, message);
+
+    Message decoded;
+    Benchmark("BinaryDeserialize + read 2 fields", 1000000, [&]()
+    {
+        BinaryDeserialize(binary, decoded);
+        DoNotOptimize(decoded.id);
+        DoNotOptimize(decoded.route.size());
+    });
+
+    Benchmark("FlatView read 2 fields", 10000000, [&]()
+    {
+        FlatView<Message> view(flat.data(), flat.size());
+        DoNotOptimize(view.Get<ID>());
+        DoNotOptimize(view.Get<ROUTE>().size());
+    });
+
+    Benchmark("FlatView validate + read 2 fields", 1000000, [&]()
+    {
+        FlatView<Message> view(flat.data(), flat.size());
+        DoNotOptimize(view.IsValid());
+        DoNotOptimize(view.Get<ID>());
+        DoNotOptimize(view.Get<ROUTE>().size());
+    });
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "../FlatBuffer.h"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+enum class FlatBufferTestKind : uint8_t { Request = 1, Response = 2 };
+
+class FlatBufferTestHeader
+{
+public:
+    uint64_t id = 0;
+    std::string route;
+
+    REFLECTABLE_FIELDS(id, route);
+};
+
+class FlatBufferTestMessage
+{
+public:
+    bool urgent = false;
+    FlatBufferTestKind kind = FlatBufferTestKind::Request;
+    FlatBufferTestHeader header;
+    int16_t priority = 0;
+    double score = 0.0;
+    std::string body;
+    std::vector<int64_t> values;
+    std::array<float, 3> position {};
+    std::vector<std::string> tags;
+    std::vector<FlatBufferTestHeader> hops;
+
+    REFLECTABLE_FIELDS(urgent, kind, header, priority, score, body, values, position, tags, hops);
+};
+
+typedef FlatBufferTestMessage Message;
+static constexpr uint32_t URGENT = Reflection::FindFieldId<Message>("urgent");
+static constexpr uint32_t KIND = Reflection::FindFieldId<Message>("kind");
+static constexpr uint32_t HEADER = Reflection::FindFieldId<Message>("header");
+static constexpr uint32_t PRIORITY = Reflection::FindFieldId<Message>("priority");
+static constexpr uint32_t SCORE = Reflection::FindFieldId<Message>("score");
+static constexpr uint32_t BODY = Reflection::FindFieldId<Message>("body");
+static constexpr uint32_t VALUES = Reflection::FindFieldId<Message>("values");
+static constexpr uint32_t POSITION = Reflection::FindFieldId<Message>("position");
+static constexpr uint32_t TAGS = Reflection::FindFieldId<Message>("tags");
+static constexpr uint32_t HOPS = Reflection::FindFieldId<Message>("hops");
+static constexpr uint32_t ROUTE = Reflection::FindFieldId<FlatBufferTestHeader>("route");
+
+static Message MakeMessage()
+{
+    Message message;
+    message.urgent = true;
+    message.kind = FlatBufferTestKind::Response;
+    message.header.id = 1234567890123ull;
+    message.header.route = "a/b/c";
+    message.priority = -7;
+    message.score = 0.25;
+    message.body = std::string("body with \0 zero", 16);
+    message.values = { 1, -2, 3 };
+    message.position = {{ 1.5f, 2.5f, 3.5f }};
+    message.tags = { "x", "", "yz" };
+    message.hops.resize(2);
+    message.hops[1].id = 2;
+    message.hops[1].route = "hop";
+    return message;
+}
+
+static void CheckView(const FlatView<Message>& view)
+{
+    assert(view.IsValid());
+    assert(view.Get<URGENT>());
+    assert(view.Get<KIND>() == FlatBufferTestKind::Response);
+    assert(view.Get<HEADER>().Get<0>() == 1234567890123ull);
+    assert(view.Get<HEADER>().Get<ROUTE>() == "a/b/c");
+    assert(view.Get<PRIORITY>() == -7);
+    assert(view.Get<SCORE>() == 0.25);
+    assert(view.Get<BODY>() == std::string_view("body with \0 zero", 16));
+
+    const Span<const int64_t> values = view.Get<VALUES>();
+    assert(values.size() == 3 && values[0] == 1 && values[1] == -2 && values[2] == 3);
+    assert(reinterpret_cast<uintptr_t>(values.data()) % alignof(int64_t) == 0);
+    assert(view.Get<POSITION>().size() == 3 && view.Get<POSITION>()[2] == 3.5f);
+
+    assert(view.Get<TAGS>().size() == 3);
+    assert(view.Get<TAGS>()[0] == "x" && view.Get<TAGS>()[1].empty() && view.Get<TAGS>()[2] == "yz");
+    assert(view.Get<HOPS>().size() == 2);
+    assert(view.Get<HOPS>()[0].Get<ROUTE>().empty());
+    assert(view.Get<HOPS>()[1].Get<0>() == 2 && view.Get<HOPS>()[1].Get<ROUTE>() == "hop");
+}
+
+static void ViewTest()
+{
+    std::string buffer;
+    FlatSerialize(buffer, MakeMessage());
+    FlatView<Message> view(buffer.data(), buffer.size());
+    assert(view.Size() == buffer.size());
+    CheckView(view);
+
+    //  Objects written one after another
+    std::vector<char> objects;
+    for(int i = 0; i < 3; ++i)
+        FlatSerialize(objects, MakeMessage());
+    size_t offset = 0;
+    for(int i = 0; i < 3; ++i)
+    {
+        FlatView<Message> next(objects.data() + offset, objects.size() - offset);
+        CheckView(next);
+        offset = FlatLayout::Align(offset + next.Size(), FlatLayout::OBJECT_ALIGNMENT);
+    }
+    assert(offset == FlatLayout::Align(objects.size(), FlatLayout::OBJECT_ALIGNMENT));
+}
+
+static void ValidationTest()
+{
+    std::string buffer;
+    FlatSerialize(buffer, MakeMessage());
+
+    //  Any truncation is detected
+    for(size_t size = 0; size < buffer.size(); ++size)
+        assert(!FlatView<Message>(buffer.data(), size).IsValid());
+
+    //  Corrupted offsets and sizes are detected or stay within the object
+    for(size_t i = 0; i < buffer.size(); ++i)
+    {
+        std::string corrupted = buffer;
+        corrupted[i] = static_cast<char>(corrupted[i] + 0x80);
+        FlatView<Message> view(corrupted.data(), corrupted.size());
+        if(view.IsValid())
+        {
+            view.Get<BODY>();
+            view.Get<VALUES>();
+            for(size_t tag = 0; tag < view.Get<TAGS>().size(); ++tag)
+                view.Get<TAGS>()[tag];
+        }
+    }
+}
+
+static void MappedFileTest()
+{
+    const char* path = "FlatBufferTest.bin";
+    std::string buffer;
+    FlatSerialize(buffer, MakeMessage());
+    std::ofstream(path, std::ios::binary).write(buffer.data(), buffer.size());
+
+    MappedFile file(path);
+    assert(file.IsOpen() && file.Size() == buffer.size());
+    CheckView(FlatView<Message>(file.Data(), file.Size()));
+    file.Close();
+    std::remove(path);
+
+    assert(!MappedFile("FlatBufferTest.missing").IsOpen());
+}
+
+void FlatBufferTest()
+{
+    ViewTest();
+    ValidationTest();
+    MappedFileTest();
+}
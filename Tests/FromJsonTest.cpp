@@ -0,0 +1,124 @@
+#include "../Reflection.h"
+#include "../FromJson.h"
+#include "../ToJson.h"
+#include <cassert>
+
+using namespace vklib;
+
+class FromJsonTestClass1
+{
+public:
+    int intField = 3;
+    std::string stringField = "String \"field\"\n";
+    bool boolField = true;
+    char charField = '"';
+
+    REFLECTABLE_FIELDS(intField, stringField, boolField, charField);
+};
+
+class FromJsonTestClass2
+{
+public:
+    std::unique_ptr<FromJsonTestClass1> classField { new FromJsonTestClass1() };
+    std::shared_ptr<FromJsonTestClass1> nullField;
+    double doubleField = 3423.532;
+    std::tuple<char, int, std::string> tupleField { 'c', -6786, "tuple" };
+    std::pair<uint64_t, std::string> pairField { 18446744073709551615ull, "pair" };
+    std::array<int16_t, 3> arrayField {{ 1, -2, 3 }};
+    std::vector<FromJsonTestClass1> vectorField { FromJsonTestClass1(), FromJsonTestClass1() };
+    std::vector<bool> boolVectorField { true, false, true };
+    std::deque<float> dequeField { 1.5f, 2.5f };
+    std::forward_list<int> forwardListField { 1, 2, 3 };
+    std::list<std::string> listField { "a", "bc" };
+    std::set<std::string> setField { "x", "y" };
+    std::map<std::string, std::vector<int>> mapField { { "one", { 1 } }, { "two", { 2, 2 } } };
+    std::multimap<int, int> multimapField { { 1, 1 }, { 1, 2 } };
+    std::unordered_map<int, double> unorderedMapField { { 1, 1.1 }, { 2, 2.2 } };
+
+    REFLECTABLE_FIELDS(classField, nullField, doubleField, tupleField, pairField, arrayField, vectorField,
+        boolVectorField, dequeField, forwardListField, listField, setField, mapField, multimapField,
+        unorderedMapField);
+};
+
+static void RoundTripTest()
+{
+    FromJsonTestClass2 source;
+    source.vectorField[1].stringField = "\x01\x1F unicode \xD0\x96";
+    const std::string json = ToJson(source);
+
+    FromJsonTestClass2 target;
+    target.classField.reset();
+    target.nullField = std::make_shared<FromJsonTestClass1>();
+    target.vectorField.resize(5);
+    target.forwardListField.clear();
+    target.mapField.clear();
+    assert(FromJson(json, target));
+    assert(target.nullField == nullptr);
+    assert(target.vectorField.size() == 2);
+    assert(target.unorderedMapField == source.unorderedMapField);
+
+    source.unorderedMapField.clear();
+    target.unorderedMapField.clear();
+    assert(ToJson(target) == ToJson(source));
+}
+
+static void GeneralJsonTest()
+{
+    const char* json = " {\n"
+        "  \"unknown\" : { \"a\" : [1, 2, {\"b\": \"]}\\\"\"}], \"c\": null },\n"
+        "  \"intField\" : -42 ,\n"
+        "  \"string\\u0046ield\" : \"\\u0041\\u00e9\\ud83d\\ude00\\/\",\n"
+        "  \"unknownNumber\" : 1.5e10\n"
+        "}  ";
+
+    FromJsonTestClass1 obj;
+    assert(FromJson(json, obj));
+    assert(obj.intField == -42);
+    assert(obj.stringField == "A\xC3\xA9\xF0\x9F\x98\x80/");
+    assert(obj.boolField);
+
+    std::map<std::string, int> map;
+    assert(FromJson("{\"a\": 1, \"b\": 2}", map));
+    assert(map.size() == 2 && map["a"] == 1 && map["b"] == 2);
+}
+
+static void InvalidJsonTest()
+{
+    FromJsonTestClass1 obj;
+    assert(!FromJson("", obj));
+    assert(!FromJson("{\"intField\": 1", obj));
+    assert(!FromJson("{\"intField\": 1.5}", obj));
+    assert(!FromJson("{\"intField\": \"1\"}", obj));
+    assert(!FromJson("{\"stringField\": \"unterminated}", obj));
+    assert(!FromJson("{\"boolField\": 1}", obj));
+    assert(!FromJson("{} {}", obj));
+
+    std::array<int, 2> array;
+    assert(!FromJson("[1]", array));
+    assert(!FromJson("[1,2,3]", array));
+
+    uint8_t byte = 0;
+    assert(!FromJson("256", byte));
+    assert(!FromJson("-1", byte));
+}
+
+static void ReuseTest()
+{
+    std::vector<FromJsonTestClass1> target(2);
+    target[0].stringField.reserve(64);
+    const char* stringData = target[0].stringField.data();
+    const FromJsonTestClass1* itemData = target.data();
+
+    assert(FromJson("[{\"stringField\": \"short\"}, {}]", target));
+    assert(target.data() == itemData);
+    assert(target[0].stringField.data() == stringData);
+    assert(target[0].stringField == "short");
+}
+
+void FromJsonTest()
+{
+    RoundTripTest();
+    GeneralJsonTest();
+    InvalidJsonTest();
+    ReuseTest();
+}
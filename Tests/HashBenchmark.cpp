@@ -0,0 +1,50 @@
+#include "../Reflection.h"
+#include "Benchmark.h"
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+class HashBenchmarkWide
+{
+    int32_t f00 = 0, f01 = 1, f02 = 2, f03 = 3, f04 = 4, f05 = 5, f06 = 6, f07 = 7;
+    int32_t f08 = 8, f09 = 9, f10 = 10, f11 = 11, f12 = 12, f13 = 13, f14 = 14, f15 = 15;
+    int64_t g00 = 0, g01 = 1, g02 = 2, g03 = 3, g04 = 4, g05 = 5, g06 = 6, g07 = 7;
+    uint16_t h00 = 0, h01 = 1, h02 = 2, h03 = 3;
+    bool b00 = true, b01 = false;
+
+    REFLECTABLE_FIELDS(f00, f01, f02, f03, f04, f05, f06, f07, f08, f09, f10, f11, f12, f13, f14, f15,
+        g00, g01, g02, g03, g04, g05, g06, g07, h00, h01, h02, h03, b00, b01);
+};
+
+class HashBenchmarkCollections
+{
+    int32_t id = 5;
+    std::string name = std::string(256, 'n');
+    std::vector<int32_t> values = std::vector<int32_t>(1000, 7);
+
+    REFLECTABLE_FIELDS(id, name, values);
+};
+
+template<class ObjectT>
+void Run(const char* name, const ObjectT& obj, size_t iterations)
+{
+    std::cout << name << std::endl;
+
+    Benchmark("  WyHasher", iterations, [&]()
+    {
+        DoNotOptimize(Reflection::Hash<ObjectT, WyHasher>(obj));
+    });
+
+    Benchmark("  BoostHasher", iterations, [&]()
+    {
+        DoNotOptimize(Reflection::Hash<ObjectT, BoostHasher>(obj));
+    });
+}
+
+int main(int argc, char** argv)
+{
+    Run("Wide", HashBenchmarkWide(), 10000000);
+    Run("Collections", HashBenchmarkCollections(), 1000000);
+    return 0;
+}
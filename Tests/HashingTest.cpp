@@ -0,0 +1,149 @@
+#include "../Reflection.h"
+#include <cassert>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace vklib;
+
+class HashingTestPoint
+{
+public:
+    int32_t x = 0;
+    int32_t y = 0;
+    uint16_t tag = 0;
+    int64_t time = 0;
+
+    REFLECTABLE_FIELDS(x, y, tag, time);
+};
+
+class HashingTestClass
+{
+public:
+    HashingTestPoint point;
+    double doubleField = 0.0;
+    std::string stringField = "text";
+    std::vector<int> vectorField { 1, 2, 3 };
+    std::map<int, std::string> mapField { { 1, "a" } };
+    std::unordered_map<std::string, int> unorderedMapField;
+
+    REFLECTABLE_FIELDS(point, doubleField, stringField, vectorField, mapField, unorderedMapField);
+};
+
+static void ConsistencyTest()
+{
+    HashingTestClass obj1;
+    HashingTestClass obj2;
+    obj2.doubleField = -0.0;
+    for(int i = 0; i < 100; ++i)
+    {
+        obj1.unorderedMapField[std::to_string(i)] = i;
+        obj2.unorderedMapField[std::to_string(99 - i)] = 99 - i;
+    }
+    assert(Reflection::Hash(obj1) == Reflection::Hash(obj2));
+    assert(vklib::Hash<HashingTestClass>()(obj1) == Reflection::Hash(obj2));
+
+    obj2.vectorField.push_back(4);
+    assert(Reflection::Hash(obj1) != Reflection::Hash(obj2));
+}
+
+static void StreamingTest()
+{
+    uint8_t data[100];
+    for(size_t i = 0; i < sizeof(data); ++i)
+        data[i] = static_cast<uint8_t>(i * 37);
+
+    for(size_t size = 0; size <= sizeof(data); ++size)
+    {
+        WyHasher whole;
+        whole.Update(data, size);
+
+        for(size_t step = 1; step < 20; ++step)
+        {
+            WyHasher parts;
+            for(size_t offset = 0; offset < size; offset += step)
+                parts.Update(data + offset, std::min(step, size - offset));
+            assert(parts.Result() == whole.Result());
+        }
+    }
+
+    //  Adjacent fields hashed at once produce the same hash as field by field
+    HashingTestPoint point;
+    point.x = 1;
+    point.y = 2;
+    point.tag = 3;
+    point.time = 4;
+    WyHasher fields;
+    fields.Update(&point.x, sizeof(point.x));
+    fields.Update(&point.y, sizeof(point.y));
+    fields.Update(&point.tag, sizeof(point.tag));
+    fields.Update(&point.time, sizeof(point.time));
+    assert(Reflection::Hash(point) == fields.Result());
+}
+
+static void CollisionTest()
+{
+    const size_t bucketCount = 1024;
+    std::vector<size_t> buckets(bucketCount);
+    std::unordered_set<size_t> hashes;
+    HashingTestPoint point;
+    for(int32_t x = 0; x < 512; ++x)
+    {
+        for(int32_t y = 0; y < 512; ++y)
+        {
+            point.x = x;
+            point.y = y;
+            const size_t hash = Reflection::Hash(point);
+            hashes.insert(hash);
+            ++buckets[hash % bucketCount];
+        }
+    }
+    assert(hashes.size() == 512 * 512);
+
+    const size_t expected = 512 * 512 / bucketCount;
+    for(size_t count : buckets)
+        assert(count > expected / 2 && count < expected * 3 / 2);
+}
+
+static void AvalancheTest()
+{
+    HashingTestPoint point;
+    point.x = 12345;
+    point.time = 67890;
+    const size_t hash = Reflection::Hash(point);
+
+    size_t changedBits = 0;
+    for(int bit = 0; bit < 32; ++bit)
+    {
+        HashingTestPoint changed = point;
+        changed.x ^= 1 << bit;
+        changedBits += __builtin_popcountll(Reflection::Hash(changed) ^ hash);
+    }
+
+    const size_t average = changedBits / 32;
+    assert(average > 24 && average < 40);
+}
+
+static void BoostHasherTest()
+{
+    HashingTestPoint point;
+    point.x = 1;
+    point.tag = 7;
+
+    size_t seed = 0;
+    boost::hash_combine(seed, point.x);
+    boost::hash_combine(seed, point.y);
+    boost::hash_combine(seed, point.tag);
+    boost::hash_combine(seed, point.time);
+    assert((Reflection::Hash<HashingTestPoint, BoostHasher>(point)) == seed);
+}
+
+void HashingTest()
+{
+    ConsistencyTest();
+    StreamingTest();
+    CollisionTest();
+    AvalancheTest();
+    BoostHasherTest();
+}
@@ -0,0 +1,90 @@
+#include "../Reflection.h"
+#include "../ToString.h"
+#include <cassert>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+class InstrumentationTestPoint
+{
+public:
+    int32_t x = 1;
+    int32_t y = 2;
+
+    REFLECTABLE_FIELDS(x, y);
+};
+
+class InstrumentationTestRecord
+{
+public:
+    std::string name = "record";
+    std::vector<InstrumentationTestPoint> points = std::vector<InstrumentationTestPoint>(3);
+
+    REFLECTABLE_FIELDS(name, points);
+};
+
+class InstrumentationTestVisitor
+{
+public:
+    template<class T>
+    bool VisitField(const char*, const T&)
+    {
+        return true;
+    }
+};
+
+//
+//  Built with -DVKLIB_INSTRUMENTATION as InstrumentedTest, see makefile
+//
+void InstrumentationTest()
+{
+#ifdef VKLIB_INSTRUMENTATION
+    InstrumentationRegistry& registry = InstrumentationRegistry::Instance();
+    InstrumentationTestRecord record;
+    InstrumentationTestVisitor visitor;
+    Reflection::VisitFields(record, visitor);
+    Reflection::VisitFields(record, visitor);
+
+    const std::string text = ToString(record);
+    std::stringstream stream;
+    ToString(stream, record);
+    assert(stream.str() == text);
+
+    InstrumentationSnapshot snapshot;
+    assert(registry.Find("InstrumentationTestRecord", InstrumentedOperation::VisitFields, snapshot));
+    assert(snapshot.calls == 2);
+    assert(snapshot.bytes == 0);
+
+    assert(registry.Find("InstrumentationTestRecord", InstrumentedOperation::Print, snapshot));
+    assert(snapshot.calls == 2);
+    assert(snapshot.bytes == text.size() * 2);
+
+    assert(registry.Find("InstrumentationTestPoint", InstrumentedOperation::Print, snapshot));
+    assert(snapshot.calls == 6);
+    assert(snapshot.bytes == ToString(record.points[0]).size() * 6);
+    assert(!registry.Find("InstrumentationTestPoint", InstrumentedOperation::VisitFields, snapshot));
+
+    //  ToString to std::string allocates the result
+    registry.Reset();
+    assert(registry.Find("InstrumentationTestRecord", InstrumentedOperation::Print, snapshot));
+    assert(snapshot.calls == 0);
+    const size_t allocationCount = instrumentationAllocationCount;
+    std::string output;
+    StringWriter writer(output);
+    ToString(writer, record);
+    const size_t allocations = instrumentationAllocationCount - allocationCount;
+    assert(output == text);
+    assert(registry.Find("InstrumentationTestRecord", InstrumentedOperation::Print, snapshot));
+    assert(snapshot.calls == 1);
+    assert(snapshot.bytes == text.size());
+    assert(snapshot.allocations == allocations);
+    assert(snapshot.allocations > 0);
+
+    std::stringstream dump;
+    registry.Dump(dump);
+    assert(dump.str().find("InstrumentationTestRecord") != std::string::npos);
+    assert(dump.str().find("InstrumentationTestPoint") != std::string::npos);
+#endif
+}
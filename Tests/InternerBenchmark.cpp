@@ -0,0 +1,76 @@
+#include "../Interner.h"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+
+using namespace vklib;
+
+class BenchmarkRoute
+{
+public:
+    std::string host = "backend.service.internal";
+    int32_t port = 8080;
+    std::vector<std::string> paths { "/api/v1/users", "/api/v1/groups", "/api/v1/roles" };
+    std::string cluster = "production-east";
+
+    REFLECTABLE_FIELDS(host, port, paths, cluster);
+};
+
+int main(int argc, char** argv)
+{
+    const size_t iterations = 1000000;
+    const int32_t valueCount = 1000;
+    std::vector<BenchmarkRoute> routes(valueCount);
+    for(int32_t i = 0; i < valueCount; ++i)
+        routes[i].port = i;
+
+    Interner<BenchmarkRoute> interner;
+    std::vector<Interner<BenchmarkRoute>::Handle> handles;
+    for(const BenchmarkRoute& route : routes)
+        handles.push_back(interner.Intern(route));
+
+    size_t index = 0;
+    Benchmark("Intern hit", iterations, [&]()
+    {
+        DoNotOptimize(interner.Intern(routes[index++ % valueCount]));
+    });
+
+    const BenchmarkRoute copy = routes[1];
+    Benchmark("Equal of copies", iterations, [&]()
+    {
+        DoNotOptimize(Reflection::Equal(routes[1], copy));
+    });
+
+    const auto handle = interner.Intern(copy);
+    Benchmark("Equal of interned", iterations, [&]()
+    {
+        DoNotOptimize(Reflection::Equal(*handles[1], *handle));
+    });
+
+    //  Throughput of threads interning the same values
+    const size_t threadCount = 4;
+    const size_t threadIterations = iterations / threadCount;
+    const double threadsNs = Benchmark("Intern hit by 4 threads, 1M calls", 1, [&]()
+    {
+        std::vector<std::thread> threads;
+        for(size_t i = 0; i < threadCount; ++i)
+        {
+            threads.emplace_back([&, i]()
+            {
+                for(size_t j = 0; j < threadIterations; ++j)
+                    DoNotOptimize(interner.Intern(routes[(i + j) % valueCount]));
+            });
+        }
+        for(std::thread& thread : threads)
+            thread.join();
+    });
+
+    std::cout << "Intern hit by 4 threads: " << threadsNs / (threadIterations * threadCount) << " ns/call" << std::endl;
+
+    const InternerStats stats = interner.GetStats();
+    std::cout << "objects: " << stats.objects << ", hit rate: " << stats.GetHitRate()
+        << ", bytes saved: " << stats.bytesSaved << std::endl;
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "../Interner.h"
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace vklib;
+
+class InternerTestRoute
+{
+public:
+    std::string host;
+    int32_t port = 0;
+    std::vector<std::string> paths;
+
+    REFLECTABLE_FIELDS(host, port, paths);
+};
+
+static InternerTestRoute MakeRoute(int32_t port)
+{
+    InternerTestRoute route;
+    route.host = "example.com";
+    route.port = port;
+    route.paths = { "/a", "/b" };
+    return route;
+}
+
+static void CanonicalTest()
+{
+    Interner<InternerTestRoute> interner;
+    const InternerTestRoute route = MakeRoute(80);
+    const auto first = interner.Intern(route);
+    const auto second = interner.Intern(MakeRoute(80));
+    const auto other = interner.Intern(MakeRoute(443));
+    assert(first == second && first != other);
+    assert(Reflection::Equal(*first, route) && other->port == 443);
+
+    const InternerStats stats = interner.GetStats();
+    assert(stats.lookups == 3 && stats.hits == 1 && stats.objects == 2);
+    assert(stats.bytesSaved == sizeof(InternerTestRoute));
+    assert(stats.GetHitRate() > 0.3 && stats.GetHitRate() < 0.4);
+}
+
+static void CollectTest()
+{
+    Interner<InternerTestRoute, 4> interner;
+    auto kept = interner.Intern(MakeRoute(1));
+    interner.Intern(MakeRoute(2));
+    interner.Intern(MakeRoute(3));
+    assert(interner.Collect() == 2);
+    assert(interner.GetStats().objects == 1);
+    assert(interner.Intern(MakeRoute(1)) == kept);
+    assert(interner.Intern(MakeRoute(2)) != nullptr && interner.GetStats().objects == 2);
+}
+
+static void ConcurrentTest()
+{
+    const size_t threadCount = 4;
+    const int32_t valueCount = 100;
+    Interner<InternerTestRoute> interner;
+    std::vector<std::vector<Interner<InternerTestRoute>::Handle>> handles(threadCount);
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back([&, i]()
+        {
+            for(int32_t port = 0; port < valueCount; ++port)
+                handles[i].push_back(interner.Intern(MakeRoute(port)));
+        });
+    }
+    for(std::thread& thread : threads)
+        thread.join();
+
+    //  All threads got the same canonical objects
+    for(size_t i = 1; i < threadCount; ++i)
+        assert(handles[i] == handles[0]);
+    const InternerStats stats = interner.GetStats();
+    assert(stats.objects == valueCount);
+    assert(stats.lookups == threadCount * valueCount && stats.hits == (threadCount - 1) * valueCount);
+}
+
+void InternerTest()
+{
+    CanonicalTest();
+    CollectTest();
+    ConcurrentTest();
+}
@@ -0,0 +1,42 @@
+#include "../PagedWriter.h"
+#include "../ToString.h"
+#include "Benchmark.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <map>
+#include <string>
+
+using namespace vklib;
+
+class PagedWriterBenchmarkClass
+{
+public:
+    std::map<int, std::string> items;
+
+    REFLECTABLE_FIELDS(items);
+};
+
+int main(int argc, char** argv)
+{
+    PagedWriterBenchmarkClass obj;
+    for(int i = 0; i < 1000000; ++i)
+        obj.items[i] = "item" + std::to_string(i);
+
+    const int fd = open("/dev/null", O_WRONLY);
+
+    Benchmark("ToString + write of 1M item map", 3, [&]()
+    {
+        const std::string text = ToString(obj);
+        DoNotOptimize(write(fd, text.data(), text.size()));
+    });
+
+    Benchmark("FdWriter of 1M item map", 3, [&]()
+    {
+        FdWriter<> writer(fd);
+        ToString(writer, obj);
+        DoNotOptimize(writer.Flush());
+    });
+
+    close(fd);
+    return 0;
+}
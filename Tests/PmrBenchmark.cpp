@@ -0,0 +1,85 @@
+#define BENCHMARK_COUNT_ALLOCATIONS
+
+#include "../Pmr.h"
+#include "Benchmark.h"
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+class PmrBenchmarkRequest
+{
+public:
+    int64_t id = 0;
+    std::string path;
+    std::vector<std::string> headers;
+    std::map<std::string, std::string> parameters;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(id, path, headers, parameters);
+};
+
+class PmrBenchmarkPmrRequest
+{
+public:
+    int64_t id = 0;
+    std::pmr::string path;
+    std::pmr::vector<std::pmr::string> headers;
+    std::pmr::map<std::pmr::string, std::pmr::string> parameters;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(id, path, headers, parameters);
+};
+
+template<class RequestT>
+RequestT MakeRequest()
+{
+    RequestT request;
+    request.id = 1;
+    request.path = "/api/v1/objects/with/a/long/path";
+    for(int i = 0; i < 100; ++i)
+    {
+        request.headers.emplace_back("X-Header-" + std::to_string(i) + ": header value, which doesn't fit small string");
+        request.parameters.emplace("parameter-name-" + std::to_string(i), "parameter value " + std::to_string(i));
+    }
+    return request;
+}
+
+int main(int argc, char** argv)
+{
+    const size_t iterations = 10000;
+    const PmrBenchmarkRequest request = MakeRequest<PmrBenchmarkRequest>();
+    const PmrBenchmarkPmrRequest pmrRequest = MakeRequest<PmrBenchmarkPmrRequest>();
+    std::string data;
+    BinarySerialize(data, request);
+    std::vector<char> arenaBuffer(1 << 20);
+
+    Benchmark("Reflection::Copy", iterations, [&]()
+    {
+        PmrBenchmarkRequest copy;
+        Reflection::Copy(copy, request);
+        DoNotOptimize(copy);
+    });
+
+    Benchmark("PmrCopy into arena", iterations, [&]()
+    {
+        std::pmr::monotonic_buffer_resource arena(arenaBuffer.data(), arenaBuffer.size());
+        PmrBenchmarkPmrRequest copy;
+        PmrCopy(copy, pmrRequest, &arena);
+        DoNotOptimize(copy);
+    });
+
+    Benchmark("BinaryDeserialize", iterations, [&]()
+    {
+        PmrBenchmarkRequest decoded;
+        DoNotOptimize(BinaryDeserialize(data, decoded));
+    });
+
+    Benchmark("PmrBinaryDeserialize into arena", iterations, [&]()
+    {
+        std::pmr::monotonic_buffer_resource arena(arenaBuffer.data(), arenaBuffer.size());
+        PmrBenchmarkPmrRequest decoded;
+        DoNotOptimize(PmrBinaryDeserialize(data, decoded, &arena));
+    });
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include "../FromJson.h"
+#include "../Pmr.h"
+#include "../ToJson.h"
+#include "../ToString.h"
+#include <cassert>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+class PmrTestChild
+{
+public:
+    int32_t id = 0;
+    std::pmr::string name;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(id, name);
+};
+
+class PmrTestRecord
+{
+public:
+    int64_t id = 0;
+    std::pmr::string name;
+    std::pmr::vector<std::pmr::string> tags;
+    std::pmr::map<int32_t, std::pmr::string> index;
+    std::pmr::vector<int32_t> values;
+    PmrTestChild child;
+    PmrPtr<PmrTestChild> optional;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(id, name, tags, index, values, child, optional);
+};
+
+//
+//  Counts allocations, which are passed to upstream resource
+//
+class PmrTestResource : public std::pmr::memory_resource
+{
+    std::pmr::memory_resource* _upstream;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++allocationCount;
+        return _upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* data, size_t bytes, size_t alignment) override
+    {
+        _upstream->deallocate(data, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+public:
+    size_t allocationCount = 0;
+
+    explicit PmrTestResource(std::pmr::memory_resource* upstream) : _upstream(upstream) {}
+};
+
+static bool IsIn(const std::pmr::string& value, std::pmr::memory_resource* resource)
+{
+    return value.get_allocator().resource() == resource;
+}
+
+static void CheckResource(const PmrTestRecord& record, std::pmr::memory_resource* resource)
+{
+    assert(IsIn(record.name, resource));
+    assert(record.tags.get_allocator().resource() == resource);
+    for(const std::pmr::string& tag : record.tags)
+        assert(IsIn(tag, resource));
+    assert(record.index.get_allocator().resource() == resource);
+    for(const auto& item : record.index)
+        assert(IsIn(item.second, resource));
+    assert(record.values.get_allocator().resource() == resource);
+    assert(IsIn(record.child.name, resource));
+    assert(record.optional.get_deleter().GetResource() == resource);
+    if(record.optional)
+        assert(IsIn(record.optional->name, resource));
+}
+
+void PmrTest()
+{
+    PmrTestRecord source;
+    source.id = 42;
+    source.name = "a record name, which doesn't fit small string";
+    for(int i = 0; i < 10; ++i)
+    {
+        source.tags.emplace_back("a tag, which doesn't fit small string " + std::to_string(i));
+        source.index[i] = std::pmr::string(20 + i, 'x');
+        source.values.push_back(i);
+    }
+    source.child.id = 7;
+    source.child.name = "a child name, which doesn't fit small string";
+    source.optional = PmrNew<PmrTestChild>(std::pmr::get_default_resource());
+    source.optional->id = 8;
+    source.optional->name = "an optional child name, which doesn't fit small string";
+    const std::string text = ToString(source);
+
+    std::pmr::memory_resource* defaultResource = std::pmr::get_default_resource();
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        PmrTestResource resource(&arena);
+
+        //  Nothing is allocated outside of the resource
+        std::pmr::set_default_resource(std::pmr::null_memory_resource());
+        PmrTestRecord copy;
+        PmrCopy(copy, source, &resource);
+        PmrPtr<PmrTestRecord> clone = PmrClone(source, &resource);
+        std::pmr::set_default_resource(defaultResource);
+
+        assert(ToString(copy) == text);
+        assert(ToString(*clone) == text);
+        CheckResource(copy, &resource);
+        CheckResource(*clone, &resource);
+        assert(clone.get_deleter().GetResource() == &resource);
+        assert(resource.allocationCount > 0);
+
+        //  Copy again into the same object
+        copy.optional.reset();
+        PmrCopy(copy, source, &resource);
+        assert(ToString(copy) == text);
+        CheckResource(copy, &resource);
+
+        //  Null pointer is copied as null bound to the resource
+        PmrTestRecord empty;
+        PmrCopy(copy, empty, &resource);
+        assert(!copy.optional);
+        assert(copy.tags.empty());
+        CheckResource(copy, &resource);
+    }
+
+    {
+        std::string data;
+        BinarySerialize(data, source);
+
+        std::pmr::monotonic_buffer_resource arena;
+        PmrTestResource resource(&arena);
+        PmrTestRecord decoded;
+        decoded.name = "previous value";
+        std::pmr::set_default_resource(std::pmr::null_memory_resource());
+        const bool ok = PmrBinaryDeserialize(data, decoded, &resource);
+        std::pmr::set_default_resource(defaultResource);
+        assert(ok);
+        assert(ToString(decoded) == text);
+        assert(IsIn(decoded.name, &resource));
+        assert(IsIn(decoded.optional->name, &resource));
+        assert(decoded.optional.get_deleter().GetResource() == &resource);
+    }
+
+    //  Pointee of PmrPtr is created in the resource of its deleter
+    {
+        const std::string json = ToJson(source);
+        std::pmr::monotonic_buffer_resource arena;
+        PmrTestResource resource(&arena);
+        PmrTestRecord decoded;
+        PmrClear(decoded, &resource);
+        assert(!decoded.optional);
+        assert(FromJson(json, decoded));
+        assert(ToString(decoded) == text);
+        assert(decoded.optional.get_deleter().GetResource() == &resource);
+        CheckResource(decoded, &resource);
+    }
+}
@@ -0,0 +1,84 @@
+#include "../Reflection.h"
+#include "../ToString.h"
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "Benchmark.h"
+
+using namespace vklib;
+
+class BenchmarkOrder
+{
+public:
+    int64_t id = 0;
+    std::string customer = "customer-000000";
+    std::vector<std::string> items { "keyboard", "monitor", "cable", "adapter" };
+    std::string address = "221B Baker Street, London";
+    double total = 1234.5;
+    std::string comment = "Leave the parcel at the door, please";
+
+    REFLECTABLE_FIELDS(id, customer, items, address, total, comment);
+    FIELD_PROJECTION(Key, id, customer);
+};
+
+int main(int argc, char** argv)
+{
+    typedef BenchmarkOrder::Key Key;
+    const size_t iterations = 1000000;
+    const int64_t valueCount = 1000;
+    std::vector<BenchmarkOrder> orders(valueCount);
+    for(int64_t i = 0; i < valueCount; ++i)
+        orders[i].id = i;
+    const BenchmarkOrder copy = orders[1];
+
+    size_t index = 0;
+    Benchmark("Hash of all fields", iterations, [&]()
+    {
+        DoNotOptimize(Reflection::Hash(orders[index++ % valueCount]));
+    });
+    Benchmark("Hash of key projection", iterations, [&]()
+    {
+        DoNotOptimize(Reflection::Hash<Key>(orders[index++ % valueCount]));
+    });
+
+    Benchmark("Equal of all fields", iterations, [&]()
+    {
+        DoNotOptimize(Reflection::Equal(orders[1], copy));
+    });
+    Benchmark("Equal of key projection", iterations, [&]()
+    {
+        DoNotOptimize(Reflection::Equal<Key>(orders[1], copy));
+    });
+
+    Benchmark("Less of all fields", iterations, [&]()
+    {
+        DoNotOptimize(Reflection::Less(orders[1], copy));
+    });
+    Benchmark("Less of key projection", iterations, [&]()
+    {
+        DoNotOptimize(Reflection::Less<Key>(orders[1], copy));
+    });
+
+    //  Lookup by key in a set of objects
+    std::unordered_set<BenchmarkOrder, ProjectionHash<Key>, ProjectionEqualTo<Key>> byKey(orders.begin(), orders.end());
+    Benchmark("Find by key projection", iterations, [&]()
+    {
+        DoNotOptimize(byKey.find(orders[index++ % valueCount]));
+    });
+
+    TextBuffer<> buffer;
+    Benchmark("ToString of all fields", iterations, [&]()
+    {
+        buffer.Clear();
+        ToString(buffer, orders[1]);
+        DoNotOptimize(buffer.View());
+    });
+    Benchmark("ToString of key projection", iterations, [&]()
+    {
+        buffer.Clear();
+        ToString<Key>(buffer, orders[1]);
+        DoNotOptimize(buffer.View());
+    });
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include "../Reflection.h"
+#include "../ToString.h"
+#include <cassert>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace vklib;
+
+//
+//  Neither comparable, hashable nor printable, so operations over the whole
+//  class don't compile, but projections without it do
+//
+struct ProjectionTestOpaque
+{
+    void* handle = nullptr;
+};
+
+class ProjectionTestRecord
+{
+public:
+    int32_t id = 0;
+    std::string name;
+    std::vector<int> values;
+    ProjectionTestOpaque opaque;
+    double weight = 0;
+
+    REFLECTABLE_FIELDS(id, name, values, opaque, weight);
+    FIELD_PROJECTION(Key, id, name);
+    FIELD_PROJECTION(ByWeight, weight, id);
+};
+
+class ProjectionTestCounter
+{
+public:
+    std::string name;
+    int32_t count = 0;
+
+    template<class T>
+    bool VisitField(const char* fieldName, const T&)
+    {
+        name += fieldName;
+        ++count;
+        return true;
+    }
+};
+
+static ProjectionTestRecord MakeRecord(int32_t id, const std::string& name, double weight)
+{
+    ProjectionTestRecord record;
+    record.id = id;
+    record.name = name;
+    record.values = { id, id };
+    record.weight = weight;
+    return record;
+}
+
+static void DeclarationTest()
+{
+    static_assert(IsFieldProjection<ProjectionTestRecord::Key>::value);
+    static_assert(!IsFieldProjection<ProjectionTestRecord>::value);
+    static_assert(std::is_same_v<ProjectionTestRecord::ByWeight::FieldIds, std::integer_sequence<uint32_t, 4, 0>>);
+
+    //  Projection of ids found by name is the same type
+    typedef FieldProjection<Reflection::FindFieldId<ProjectionTestRecord>("id"), Reflection::FindFieldId<ProjectionTestRecord>("name")> Key;
+    static_assert(std::is_same_v<Key, ProjectionTestRecord::Key>);
+}
+
+static void OperationsTest()
+{
+    typedef ProjectionTestRecord::Key Key;
+    typedef ProjectionTestRecord::ByWeight ByWeight;
+    ProjectionTestRecord record1 = MakeRecord(1, "first", 2.5);
+    ProjectionTestRecord record2 = MakeRecord(1, "first", 0.5);
+    ProjectionTestRecord record3 = MakeRecord(2, "first", 0.5);
+
+    ProjectionTestCounter counter;
+    assert(Reflection::VisitFields<Key>(record1, counter));
+    assert(counter.count == 2 && counter.name == "idname");
+
+    assert(Reflection::Equal<Key>(record1, record2));
+    assert(!Reflection::Equal<Key>(record1, record3));
+    assert(Reflection::Compare<Key>(record1, record2) == 0);
+    assert(Reflection::Less<Key>(record1, record3) && !Reflection::Less<Key>(record3, record1));
+
+    //  Fields are compared in the order of the projection
+    assert(Reflection::Less<ByWeight>(record2, record1));
+    assert(Reflection::Less<ByWeight>(record2, record3));
+    assert(Reflection::Compare<ByWeight>(record3, record2) > 0);
+
+    assert(Reflection::Hash<Key>(record1) == Reflection::Hash<Key>(record2));
+    assert(Reflection::Hash<Key>(record1) != Reflection::Hash<Key>(record3));
+    assert((Reflection::Hash<Key, BoostHasher>(record1) == Reflection::Hash<Key, BoostHasher>(record2)));
+
+    ProjectionTestRecord target = MakeRecord(5, "target", 7);
+    Reflection::Copy<Key>(target, record3);
+    assert(target.id == 2 && target.name == "first" && target.weight == 7 && target.values.size() == 2 && target.values[0] == 5);
+}
+
+static void FunctorsTest()
+{
+    typedef ProjectionTestRecord::Key Key;
+    std::unordered_set<ProjectionTestRecord, ProjectionHash<Key>, ProjectionEqualTo<Key>> unique;
+    assert(unique.insert(MakeRecord(1, "first", 1)).second);
+    assert(!unique.insert(MakeRecord(1, "first", 2)).second);
+    assert(unique.insert(MakeRecord(1, "second", 1)).second);
+    assert(unique.size() == 2);
+
+    std::set<ProjectionTestRecord, ProjectionLess<ProjectionTestRecord::ByWeight>> ordered;
+    ordered.insert(MakeRecord(1, "a", 3));
+    ordered.insert(MakeRecord(2, "b", 1));
+    ordered.insert(MakeRecord(3, "c", 3));
+    assert(ordered.size() == 3);
+    assert(ordered.begin()->id == 2 && ordered.rbegin()->id == 3);
+}
+
+static void PrintTest()
+{
+    ProjectionTestRecord record = MakeRecord(1, "first", 2.5);
+    assert(ToString<ProjectionTestRecord::Key>(record) == "{id=1,name=first}");
+    assert(ToString<ProjectionTestRecord::ByWeight>(record) == "{weight=2.5,id=1}");
+
+    typedef FieldFormatPlan<ProjectionTestRecord, ToStringFormat, ProjectionTestRecord::ByWeight::FieldIds> Plan;
+    static_assert(Plan::COUNT_OF_FIELDS == 2 && Plan::FieldId(0) == 4 && Plan::FieldId(1) == 0);
+    static_assert(Plan::Run(0) == "{weight=" && Plan::Run(1) == ",id=" && Plan::Run(2) == "}");
+
+    TextBuffer<> buffer;
+    ToString<ProjectionTestRecord::Key>(buffer, record);
+    assert(buffer.View() == "{id=1,name=first}");
+
+    //  Bounded printing of projection
+    PrintLimits limits;
+    limits.maxBytes = 6;
+    TextBuffer<> bounded;
+    BoundedWriter<TextBuffer<>> writer(bounded, limits);
+    ToString<ProjectionTestRecord::Key>(writer, record);
+    assert(bounded.View() == "{id=1,...");
+}
+
+void ProjectionTest()
+{
+    DeclarationTest();
+    OperationsTest();
+    FunctorsTest();
+    PrintTest();
+}
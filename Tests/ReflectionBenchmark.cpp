@@ -0,0 +1,413 @@
+//
+//  Reflection and ToString against hand-written equivalents for narrow,
+//  wide, deeply nested and container heavy classes.
+//  ./ReflectionBenchmark [--json <file>]
+//
+
+#define BENCHMARK_COUNT_ALLOCATIONS
+
+#include "../Reflection.h"
+#include "../ToString.h"
+#include "Benchmark.h"
+#include <boost/preprocessor/cat.hpp>
+#include <boost/preprocessor/repetition/repeat.hpp>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <string.h>
+#include <utility>
+#include <vector>
+
+using namespace vklib;
+
+inline void HashCombine(size_t& seed, size_t hash)
+{
+    seed ^= hash + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+class SumVisitor
+{
+public:
+    size_t sum = 0;
+
+    template<class T>
+    bool VisitField(const char* fieldName, const T& value)
+    {
+        if constexpr(Reflection::IsReflectable<T>())
+            Reflection::VisitFields(value, *this);
+        else if constexpr(std::is_arithmetic<T>::value)
+            sum += static_cast<size_t>(value);
+        else
+            sum += value.size();
+        return true;
+    }
+};
+
+//
+//  Narrow
+//
+class NarrowClass
+{
+public:
+    int32_t id = 17;
+    int64_t account = 123456789;
+    double balance = 1024.5;
+    std::string name = "narrow";
+
+    REFLECTABLE_FIELDS(id, account, balance, name);
+};
+
+size_t ManualVisit(const NarrowClass& obj)
+{
+    return obj.id + obj.account + static_cast<size_t>(obj.balance) + obj.name.size();
+}
+
+bool ManualEqual(const NarrowClass& a, const NarrowClass& b)
+{
+    return a.id == b.id && a.account == b.account && a.balance == b.balance && a.name == b.name;
+}
+
+bool ManualLess(const NarrowClass& a, const NarrowClass& b)
+{
+    return std::tie(a.id, a.account, a.balance, a.name) < std::tie(b.id, b.account, b.balance, b.name);
+}
+
+size_t ManualHash(const NarrowClass& obj)
+{
+    size_t seed = 0;
+    HashCombine(seed, std::hash<int32_t>()(obj.id));
+    HashCombine(seed, std::hash<int64_t>()(obj.account));
+    HashCombine(seed, std::hash<double>()(obj.balance));
+    HashCombine(seed, std::hash<std::string>()(obj.name));
+    return seed;
+}
+
+void ManualToString(std::string& text, const NarrowClass& obj)
+{
+    text += "{id=";
+    text += std::to_string(obj.id);
+    text += ",account=";
+    text += std::to_string(obj.account);
+    text += ",balance=";
+    text += std::to_string(obj.balance);
+    text += ",name=";
+    text += obj.name;
+    text += '}';
+}
+
+//
+//  Wide: 100 fields
+//
+#define WIDE_FIELD_COUNT    100
+#define WIDE_FIELD(z, n, data)    int64_t BOOST_PP_CAT(field, n) = n;
+#define WIDE_FIELD_SEQ(z, n, data)    (BOOST_PP_CAT(field, n))
+#define WIDE_VISIT(z, n, data)    + obj.BOOST_PP_CAT(field, n)
+#define WIDE_EQUAL(z, n, data)    && a.BOOST_PP_CAT(field, n) == b.BOOST_PP_CAT(field, n)
+#define WIDE_LESS(z, n, data)                                                                  \
+    if(a.BOOST_PP_CAT(field, n) != b.BOOST_PP_CAT(field, n))                                    \
+        return a.BOOST_PP_CAT(field, n) < b.BOOST_PP_CAT(field, n);
+#define WIDE_HASH(z, n, data)    HashCombine(seed, std::hash<int64_t>()(obj.BOOST_PP_CAT(field, n)));
+#define WIDE_TO_STRING(z, n, data)                                                             \
+    text += n ? ",field" #n "=" : "{field" #n "=";                                              \
+    text += std::to_string(obj.BOOST_PP_CAT(field, n));
+
+class WideClass
+{
+public:
+    BOOST_PP_REPEAT(WIDE_FIELD_COUNT, WIDE_FIELD, _)
+
+    REFLECTABLE_FIELDS_FROM_SEQ(BOOST_PP_REPEAT(WIDE_FIELD_COUNT, WIDE_FIELD_SEQ, _))
+};
+
+size_t ManualVisit(const WideClass& obj)
+{
+    return 0 BOOST_PP_REPEAT(WIDE_FIELD_COUNT, WIDE_VISIT, _);
+}
+
+bool ManualEqual(const WideClass& a, const WideClass& b)
+{
+    return true BOOST_PP_REPEAT(WIDE_FIELD_COUNT, WIDE_EQUAL, _);
+}
+
+bool ManualLess(const WideClass& a, const WideClass& b)
+{
+    BOOST_PP_REPEAT(WIDE_FIELD_COUNT, WIDE_LESS, _)
+    return false;
+}
+
+size_t ManualHash(const WideClass& obj)
+{
+    size_t seed = 0;
+    BOOST_PP_REPEAT(WIDE_FIELD_COUNT, WIDE_HASH, _)
+    return seed;
+}
+
+void ManualToString(std::string& text, const WideClass& obj)
+{
+    BOOST_PP_REPEAT(WIDE_FIELD_COUNT, WIDE_TO_STRING, _)
+    text += '}';
+}
+
+//
+//  Nested: 4 levels
+//
+class NestedLevel3
+{
+public:
+    int32_t value = 3;
+    std::string label = "level3";
+
+    REFLECTABLE_FIELDS(value, label);
+};
+
+class NestedLevel2
+{
+public:
+    int32_t value = 2;
+    NestedLevel3 child;
+
+    REFLECTABLE_FIELDS(value, child);
+};
+
+class NestedLevel1
+{
+public:
+    int32_t value = 1;
+    NestedLevel2 child;
+
+    REFLECTABLE_FIELDS(value, child);
+};
+
+class NestedClass
+{
+public:
+    int32_t value = 0;
+    NestedLevel1 child;
+
+    REFLECTABLE_FIELDS(value, child);
+};
+
+size_t ManualVisit(const NestedClass& obj)
+{
+    return obj.value + obj.child.value + obj.child.child.value + obj.child.child.child.value
+        + obj.child.child.child.label.size();
+}
+
+bool ManualEqual(const NestedClass& a, const NestedClass& b)
+{
+    return a.value == b.value && a.child.value == b.child.value && a.child.child.value == b.child.child.value
+        && a.child.child.child.value == b.child.child.child.value && a.child.child.child.label == b.child.child.child.label;
+}
+
+bool ManualLess(const NestedClass& a, const NestedClass& b)
+{
+    return std::tie(a.value, a.child.value, a.child.child.value, a.child.child.child.value, a.child.child.child.label)
+        < std::tie(b.value, b.child.value, b.child.child.value, b.child.child.child.value, b.child.child.child.label);
+}
+
+size_t ManualHash(const NestedClass& obj)
+{
+    size_t seed = 0;
+    HashCombine(seed, std::hash<int32_t>()(obj.value));
+    HashCombine(seed, std::hash<int32_t>()(obj.child.value));
+    HashCombine(seed, std::hash<int32_t>()(obj.child.child.value));
+    HashCombine(seed, std::hash<int32_t>()(obj.child.child.child.value));
+    HashCombine(seed, std::hash<std::string>()(obj.child.child.child.label));
+    return seed;
+}
+
+void ManualToString(std::string& text, const NestedClass& obj)
+{
+    text += "{value=";
+    text += std::to_string(obj.value);
+    text += ",child={value=";
+    text += std::to_string(obj.child.value);
+    text += ",child={value=";
+    text += std::to_string(obj.child.child.value);
+    text += ",child={value=";
+    text += std::to_string(obj.child.child.child.value);
+    text += ",label=";
+    text += obj.child.child.child.label;
+    text += "}}}}";
+}
+
+//
+//  Containers
+//
+class ContainerClass
+{
+public:
+    std::vector<int32_t> numbers;
+    std::vector<std::string> names;
+    std::map<int32_t, std::string> index;
+
+    ContainerClass()
+    {
+        for(int32_t i = 0; i < 100; ++i)
+            numbers.push_back(i);
+        for(int32_t i = 0; i < 20; ++i)
+        {
+            names.push_back("name" + std::to_string(i));
+            index[i] = "value" + std::to_string(i);
+        }
+    }
+
+    REFLECTABLE_FIELDS(numbers, names, index);
+};
+
+size_t ManualVisit(const ContainerClass& obj)
+{
+    return obj.numbers.size() + obj.names.size() + obj.index.size();
+}
+
+bool ManualEqual(const ContainerClass& a, const ContainerClass& b)
+{
+    return a.numbers == b.numbers && a.names == b.names && a.index == b.index;
+}
+
+bool ManualLess(const ContainerClass& a, const ContainerClass& b)
+{
+    return std::tie(a.numbers, a.names, a.index) < std::tie(b.numbers, b.names, b.index);
+}
+
+size_t ManualHash(const ContainerClass& obj)
+{
+    size_t seed = 0;
+    for(int32_t number : obj.numbers)
+        HashCombine(seed, std::hash<int32_t>()(number));
+    for(const std::string& name : obj.names)
+        HashCombine(seed, std::hash<std::string>()(name));
+    for(const auto& item : obj.index)
+    {
+        HashCombine(seed, std::hash<int32_t>()(item.first));
+        HashCombine(seed, std::hash<std::string>()(item.second));
+    }
+    return seed;
+}
+
+void ManualToString(std::string& text, const ContainerClass& obj)
+{
+    text += "{numbers=[";
+    for(size_t i = 0; i < obj.numbers.size(); ++i)
+    {
+        if(i)
+            text += ',';
+        text += std::to_string(obj.numbers[i]);
+    }
+    text += "],names=[";
+    for(size_t i = 0; i < obj.names.size(); ++i)
+    {
+        if(i)
+            text += ',';
+        text += obj.names[i];
+    }
+    text += "],index=[";
+    bool first = true;
+    for(const auto& item : obj.index)
+    {
+        text += first ? "{" : ",{";
+        text += std::to_string(item.first);
+        text += ',';
+        text += item.second;
+        text += '}';
+        first = false;
+    }
+    text += "]}";
+}
+
+//
+//  Every operation is measured with Reflection and hand-written code. Move
+//  moves the object there and back, i.e. two moves per op.
+//
+template<class T>
+void Run(const std::string& name, size_t iterations)
+{
+    T obj1;
+    T obj2;
+    T target;
+    const auto benchmark = [&](const char* operation, auto&& reflection, auto&& manual)
+    {
+        Benchmark((name + " " + operation).c_str(), iterations, reflection);
+        Benchmark((name + " " + operation + " (hand-written)").c_str(), iterations, manual);
+    };
+
+    benchmark("VisitFields", [&]()
+    {
+        SumVisitor visitor;
+        Reflection::VisitFields(obj1, visitor);
+        DoNotOptimize(visitor.sum);
+    }, [&]() { DoNotOptimize(ManualVisit(obj1)); });
+
+    benchmark("Equal", [&]() { DoNotOptimize(Reflection::Equal(obj1, obj2)); },
+        [&]() { DoNotOptimize(ManualEqual(obj1, obj2)); });
+
+    benchmark("Less", [&]() { DoNotOptimize(Reflection::Less(obj1, obj2)); },
+        [&]() { DoNotOptimize(ManualLess(obj1, obj2)); });
+
+    benchmark("Hash", [&]() { DoNotOptimize(Reflection::Hash(obj1)); },
+        [&]() { DoNotOptimize(ManualHash(obj1)); });
+
+    benchmark("Copy", [&]()
+    {
+        Reflection::Copy(target, obj1);
+        DoNotOptimize(target);
+    }, [&]()
+    {
+        target = obj1;
+        DoNotOptimize(target);
+    });
+
+    benchmark("Move", [&]()
+    {
+        Reflection::Move(target, std::move(obj2));
+        Reflection::Move(obj2, std::move(target));
+        DoNotOptimize(obj2);
+    }, [&]()
+    {
+        target = std::move(obj2);
+        obj2 = std::move(target);
+        DoNotOptimize(obj2);
+    });
+
+    std::string text;
+    benchmark("ToString", [&]()
+    {
+        text.clear();
+        StringWriter writer(text);
+        ToString(writer, obj1);
+        DoNotOptimize(text);
+    }, [&]()
+    {
+        text.clear();
+        ManualToString(text, obj1);
+        DoNotOptimize(text);
+    });
+}
+
+int main(int argc, char** argv)
+{
+    const char* jsonPath = nullptr;
+    for(int i = 1; i + 1 < argc; ++i)
+    {
+        if(strcmp(argv[i], "--json") == 0)
+            jsonPath = argv[i + 1];
+    }
+
+    Run<NarrowClass>("Narrow", 1000000);
+    Run<WideClass>("Wide", 100000);
+    Run<NestedClass>("Nested", 1000000);
+    Run<ContainerClass>("Containers", 100000);
+
+    if(jsonPath)
+    {
+        std::ofstream file(jsonPath);
+        WriteBenchmarkJson(file);
+        if(!file)
+        {
+            std::cerr << "Can't write " << jsonPath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
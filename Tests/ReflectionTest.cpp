@@ -35,8 +35,109 @@ void GeneralTest()
     assert(actual == expected);
 }
 
+void FieldFormatPlanTest()
+{
+    typedef FieldFormatPlan<ReflectableClass1, ToStringFormat> Plan;
+    static_assert(Plan::Run(0) == "{intField=", "Unexpected first run");
+    static_assert(Plan::Run(1) == ",stringField=", "Unexpected field run");
+    static_assert(Plan::Run(2) == ",boolField=", "Unexpected field run");
+    static_assert(Plan::Run(3) == "}", "Unexpected last run");
+}
+
+class WideReflectableClass
+{
+    int a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, b0, b1, b2, b3, b4, b5, b6, b7, b8, b9;
+    int c0, c1, c2, c3, c4, c5, c6, c7, c8, c9, d0, d1, d2, d3, d4, d5, d6, d7, d8, d9;
+
+    REFLECTABLE_FIELDS(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, b0, b1, b2, b3, b4, b5, b6, b7, b8, b9,
+        c0, c1, c2, c3, c4, c5, c6, c7, c8, c9, d0, d1, d2, d3, d4, d5, d6, d7, d8, d9);
+};
+
+class FieldNameVisitor
+{
+public:
+    std::string name;
+
+    template<class T>
+    bool VisitField(const char* fieldName, const T&)
+    {
+        name = fieldName;
+        return true;
+    }
+};
+
+template<class T, uint32_t... Index>
+void CheckFieldIds(std::integer_sequence<uint32_t, Index...>)
+{
+    static_assert(((Reflection::FindFieldId<T>(Reflection::GetFieldName<T, Index>()) == Index) && ...), "Wrong field id");
+}
+
+void FieldLookupTest()
+{
+    CheckFieldIds<ReflectableClass1>(std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<ReflectableClass1>()>());
+    CheckFieldIds<ReflectableClass2>(std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<ReflectableClass2>()>());
+    CheckFieldIds<WideReflectableClass>(std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<WideReflectableClass>()>());
+    assert(Reflection::FindFieldId<ReflectableClass1>("") == Reflection::GetFieldCount<ReflectableClass1>());
+    assert(Reflection::FindFieldId<ReflectableClass1>("intFiel") == Reflection::GetFieldCount<ReflectableClass1>());
+    assert(Reflection::FindFieldId<WideReflectableClass>("e0") == Reflection::GetFieldCount<WideReflectableClass>());
+
+    ReflectableClass1 obj;
+    FieldNameVisitor visitor;
+    assert(Reflection::VisitFieldByName(obj, "stringField", visitor));
+    assert(visitor.name == "stringField");
+    assert(!Reflection::VisitFieldByName(obj, "unknownField", visitor));
+
+    assert(Reflection::SetFieldByName(obj, "stringField", std::string("NewValue")));
+    assert(Reflection::SetFieldByName(obj, "intField", 5));
+    assert(!Reflection::SetFieldByName(obj, "intField", "text"));
+    assert(!Reflection::SetFieldByName(obj, "stringField", 65));
+    assert(!Reflection::SetFieldByName(obj, "unknownField", 5));
+    assert(ToString(obj) == "{intField=5,stringField=NewValue,boolField=1}");
+}
+
+void HashingTest();
+void CompareTest();
+void SortKeyTest();
+void TableTest();
+void ColumnStoreTest();
+void ColumnFileTest();
+void FlatBufferTest();
+void DiffTest();
+void BatchTest();
+void DeferredLogTest();
+void InternerTest();
+void InstrumentationTest();
+void PmrTest();
+void ProjectionTest();
+void SerializationTest();
+void TaggedSerializationTest();
+void TextWriterTest();
+void ToJsonTest();
+void FromJsonTest();
+
 int main(int argc, char** argv)
 {
     GeneralTest();
+    FieldFormatPlanTest();
+    FieldLookupTest();
+    HashingTest();
+    CompareTest();
+    SortKeyTest();
+    TableTest();
+    ColumnStoreTest();
+    ColumnFileTest();
+    FlatBufferTest();
+    DiffTest();
+    BatchTest();
+    DeferredLogTest();
+    InternerTest();
+    InstrumentationTest();
+    PmrTest();
+    ProjectionTest();
+    SerializationTest();
+    TaggedSerializationTest();
+    TextWriterTest();
+    ToJsonTest();
+    FromJsonTest();
     return 0;
 }
@@ -0,0 +1,57 @@
+#include "../Serialization.h"
+#include <iostream>
+#include "../ToString.h"
+#include "Benchmark.h"
+
+using namespace vklib;
+
+class BenchmarkPoint
+{
+public:
+    int32_t x = 1200;
+    int32_t y = -3400;
+    double weight = 0.125;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(x, y, weight);
+};
+
+class BenchmarkMessage
+{
+public:
+    uint64_t id = 123456789;
+    std::string name = "benchmark message";
+    bool active = true;
+    BenchmarkPoint origin;
+    std::vector<int32_t> samples { 1, 2, 3, 4, 5, 6, 7, 8 };
+    std::map<std::string, BenchmarkPoint> points { { "a", BenchmarkPoint() }, { "b", BenchmarkPoint() } };
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(id, name, active, origin, samples, points);
+};
+
+int main(int argc, char** argv)
+{
+    const size_t iterations = 1000000;
+    BenchmarkMessage message;
+    std::string buffer;
+
+    Benchmark("ToString", iterations, [&]()
+    {
+        DoNotOptimize(ToString(message));
+    });
+
+    Benchmark("BinarySerialize", iterations, [&]()
+    {
+        buffer.clear();
+        BinarySerialize(buffer, message);
+        DoNotOptimize(buffer);
+    });
+
+    BenchmarkMessage target;
+    Benchmark("BinaryDeserialize", iterations, [&]()
+    {
+        DoNotOptimize(BinaryDeserialize(buffer, target));
+    });
+
+    std::cout << "ToString size: " << ToString(message).size() << " bytes, binary size: " << buffer.size() << " bytes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "../Serialization.h"
+#include <iostream>
+#include "../ToString.h"
+#include <cassert>
+
+using namespace vklib;
+
+enum SerializationTestEnum : uint16_t
+{
+    SERIALIZATION_TEST_FIRST,
+    SERIALIZATION_TEST_SECOND
+};
+
+class SerializableClass1
+{
+public:
+    int intField = 3;
+    std::string stringField = "StringFieldTest";
+    bool boolField = true;
+    SerializationTestEnum enumField = SERIALIZATION_TEST_SECOND;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(intField, stringField, boolField, enumField);
+};
+
+class SerializableClass2
+{
+public:
+    std::unique_ptr<SerializableClass1> classField { new SerializableClass1() };
+    std::unique_ptr<SerializableClass1> nullField;
+    std::shared_ptr<SerializableClass1> sharedField { std::make_shared<SerializableClass1>() };
+    double doubleField = 3423.532;
+    std::tuple<char, int, std::string> tupleField { 'c', 6786, "tuple" };
+    std::pair<int, std::string> pairField { 5, "pair" };
+    std::array<int16_t, 3> arrayField {{ 1, -2, 3 }};
+    std::vector<SerializableClass1> vectorField { SerializableClass1(), SerializableClass1() };
+    std::vector<bool> boolVectorField { true, false, true };
+    std::deque<double> dequeField { 1.5, 2.5 };
+    std::forward_list<int> forwardListField { 1, 2, 3 };
+    std::list<std::string> listField { "a", "bc" };
+    std::set<std::string> setField { "x", "y" };
+    std::map<std::string, std::vector<int>> mapField { { "one", { 1 } }, { "two", { 2, 2 } } };
+    std::multimap<int, int> multimapField { { 1, 1 }, { 1, 2 } };
+    std::unordered_map<int, double> unorderedMapField { { 1, 1.1 }, { 2, 2.2 } };
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(classField, nullField, sharedField, doubleField, tupleField,
+        pairField, arrayField, vectorField, boolVectorField, dequeField, forwardListField, listField,
+        setField, mapField, multimapField, unorderedMapField);
+};
+
+static void Clear(SerializableClass2& obj)
+{
+    obj.classField.reset();
+    obj.nullField.reset(new SerializableClass1());
+    obj.sharedField.reset();
+    obj.doubleField = 0;
+    obj.tupleField = {};
+    obj.pairField = {};
+    obj.arrayField = {};
+    obj.vectorField.clear();
+    obj.boolVectorField.clear();
+    obj.dequeField.clear();
+    obj.forwardListField.clear();
+    obj.listField.clear();
+    obj.setField.clear();
+    obj.mapField.clear();
+    obj.multimapField.clear();
+    obj.unorderedMapField.clear();
+}
+
+static void RoundTripTest()
+{
+    SerializableClass2 source;
+    source.vectorField[1].stringField = "Second";
+    source.sharedField->intField = 42;
+
+    std::string buffer;
+    BinarySerialize(buffer, source);
+
+    SerializableClass2 target;
+    Clear(target);
+    assert(BinaryDeserialize(buffer, target));
+
+    assert(target.nullField == nullptr);
+    assert(target.sharedField->intField == 42);
+    assert(target.unorderedMapField == source.unorderedMapField);
+    assert(target.boolVectorField == source.boolVectorField);
+    source.sharedField.reset();
+    target.sharedField.reset();
+    source.unorderedMapField.clear();
+    target.unorderedMapField.clear();
+    assert(ToString(target) == ToString(source));
+}
+
+static void TruncatedDataTest()
+{
+    SerializableClass2 source;
+    std::vector<char> buffer;
+    BinarySerialize(buffer, source);
+
+    for(size_t size = 0; size < buffer.size(); ++size)
+    {
+        SerializableClass2 target;
+        assert(!BinaryDeserialize(buffer.data(), size, target));
+    }
+
+    buffer.push_back(0);
+    SerializableClass2 target;
+    assert(!BinaryDeserialize(buffer, target));
+}
+
+static void HugeCountTest()
+{
+    //  Count of items exceeds the data, containers aren't resized to it
+    const uint8_t data[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x0F };
+    std::list<int> list;
+    assert(!BinaryDeserialize(data, sizeof(data), list));
+    std::vector<std::string> strings;
+    assert(!BinaryDeserialize(data, sizeof(data), strings));
+    std::vector<bool> bits;
+    assert(!BinaryDeserialize(data, sizeof(data), bits));
+    std::map<int, int> map;
+    assert(!BinaryDeserialize(data, sizeof(data), map));
+}
+
+static void ReuseTest()
+{
+    std::vector<SerializableClass1> source(2);
+    source[0].stringField = "short";
+
+    std::vector<char> buffer;
+    BinarySerialize(buffer, source);
+
+    std::vector<SerializableClass1> target(2);
+    target[0].stringField.reserve(64);
+    const char* stringData = target[0].stringField.data();
+    const SerializableClass1* itemData = target.data();
+
+    assert(BinaryDeserialize(buffer, target));
+    assert(target.data() == itemData);
+    assert(target[0].stringField.data() == stringData);
+    assert(target[0].stringField == "short");
+}
+
+void SerializationTest()
+{
+    RoundTripTest();
+    TruncatedDataTest();
+    HugeCountTest();
+    ReuseTest();
+}
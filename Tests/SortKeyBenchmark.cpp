@@ -0,0 +1,57 @@
+#include "../SortKey.h"
+#include "Benchmark.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace vklib;
+
+class SortKeyBenchmarkRow
+{
+public:
+    int32_t region = 0;
+    int32_t day = 0;
+    int64_t account = 0;
+    double amount = 0.0;
+    std::string comment;
+
+    REFLECTABLE_FIELDS(region, day, account, amount, comment);
+};
+
+int main(int argc, char** argv)
+{
+    std::mt19937 random(1);
+    std::vector<SortKeyBenchmarkRow> rows(1000000);
+    for(SortKeyBenchmarkRow& row : rows)
+    {
+        row.region = random() % 16;
+        row.day = random() % 365;
+        row.account = random();
+        row.amount = static_cast<double>(random()) / 100;
+        row.comment = std::to_string(random() % 1000);
+    }
+
+    Benchmark("std::sort of 1M rows", 1, [&]()
+    {
+        std::vector<SortKeyBenchmarkRow> copy = rows;
+        std::sort(copy.begin(), copy.end(), vklib::Less<SortKeyBenchmarkRow>());
+        DoNotOptimize(copy.front().account);
+    });
+
+    Benchmark("RadixSort of 1M rows (1 thread)", 1, [&]()
+    {
+        std::vector<SortKeyBenchmarkRow> copy = rows;
+        RadixSort(copy, 1);
+        DoNotOptimize(copy.front().account);
+    });
+
+    Benchmark("RadixSort of 1M rows (all threads)", 1, [&]()
+    {
+        std::vector<SortKeyBenchmarkRow> copy = rows;
+        RadixSort(copy);
+        DoNotOptimize(copy.front().account);
+    });
+    return 0;
+}
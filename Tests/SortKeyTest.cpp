@@ -0,0 +1,132 @@
+#include "../SortKey.h"
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+class SortKeyTestInner
+{
+public:
+    int8_t level = 0;
+    std::string label;
+
+    REFLECTABLE_FIELDS(level, label);
+};
+
+enum class SortKeyTestEnum : int16_t { Low = -5, Middle = 0, High = 5 };
+
+class SortKeyTestRecord
+{
+public:
+    int32_t region = 0;
+    uint16_t day = 0;
+    int64_t amount = 0;
+    double price = 0.0;
+    float ratio = 0.0f;
+    bool flag = false;
+    SortKeyTestEnum kind = SortKeyTestEnum::Middle;
+    std::string name;
+    SortKeyTestInner inner;
+    std::vector<int16_t> values;
+    uint32_t sequence = 0;
+
+    REFLECTABLE_FIELDS(region, day, amount, price, ratio, flag, kind, name, inner, values, sequence);
+};
+
+static SortKeyTestRecord MakeRecord(std::mt19937& random, uint32_t sequence)
+{
+    static const char* names[] = { "", "a", "ab", "abc", "b", "ba" };
+    static const double prices[] = { -1e300, -2.5, -0.0, 0.0, 1e-300, 2.5, 1e300 };
+    SortKeyTestRecord record;
+    record.region = static_cast<int32_t>(random() % 5) - 2;
+    record.day = random() % 3;
+    record.amount = static_cast<int64_t>(random() % 7) - 3;
+    record.price = prices[random() % 7];
+    record.ratio = static_cast<float>(static_cast<int>(random() % 5) - 2) / 4;
+    record.flag = random() % 2;
+    record.kind = static_cast<SortKeyTestEnum>((static_cast<int>(random() % 3) - 1) * 5);
+    record.name = names[random() % 6];
+    if(random() % 4 == 0)
+        record.name.push_back('\0');
+    record.inner.level = static_cast<int8_t>(random() % 3) - 1;
+    record.inner.label = names[random() % 6];
+    for(size_t count = random() % 3; count > 0; --count)
+        record.values.push_back(static_cast<int16_t>(random() % 3) - 1);
+    record.sequence = sequence;
+    return record;
+}
+
+static void KeyOrderTest()
+{
+    std::mt19937 random(1);
+    for(int i = 0; i < 10000; ++i)
+    {
+        const SortKeyTestRecord record1 = MakeRecord(random, 0);
+        const SortKeyTestRecord record2 = MakeRecord(random, 0);
+        const int compare = Reflection::Compare(record1, record2);
+        const int keyCompare = GetSortKey(record1).compare(GetSortKey(record2));
+        assert((compare < 0) == (keyCompare < 0));
+        assert((compare == 0) == (keyCompare == 0));
+    }
+
+    //  Embedded zeros and prefixes
+    assert(GetSortKey(std::string("ab")) < GetSortKey(std::string("ab\0", 3)));
+    assert(GetSortKey(std::string("ab\0", 3)) < GetSortKey(std::string("ab\x01", 3)));
+    assert(GetSortKey(std::vector<int>{ 1 }) < GetSortKey(std::vector<int>{ 1, -5 }));
+}
+
+static void RadixSortTest()
+{
+    std::mt19937 random(2);
+    for(size_t count : { 0, 1, 10, 1000, 100000 })
+    {
+        std::vector<SortKeyTestRecord> records;
+        for(size_t i = 0; i < count; ++i)
+            records.push_back(MakeRecord(random, static_cast<uint32_t>(i)));
+
+        //  Sequence field makes the order total
+        std::vector<SortKeyTestRecord> expected = records;
+        std::sort(expected.begin(), expected.end(), vklib::Less<SortKeyTestRecord>());
+
+        for(unsigned threadCount : { 1, 4 })
+        {
+            std::vector<SortKeyTestRecord> sorted = records;
+            RadixSort(sorted, threadCount);
+            assert(sorted.size() == expected.size());
+            for(size_t i = 0; i < sorted.size(); ++i)
+                assert(sorted[i].sequence == expected[i].sequence);
+        }
+    }
+}
+
+static void FieldSubsetTest()
+{
+    typedef SortKeyTestRecord Record;
+    constexpr uint32_t DAY = Reflection::FindFieldId<Record>("day");
+    constexpr uint32_t NAME = Reflection::FindFieldId<Record>("name");
+
+    std::mt19937 random(3);
+    std::vector<Record> records;
+    for(uint32_t i = 0; i < 50000; ++i)
+        records.push_back(MakeRecord(random, i));
+
+    std::vector<Record> expected = records;
+    std::stable_sort(expected.begin(), expected.end(), [](const Record& a, const Record& b)
+    {
+        return std::tie(a.day, a.name) < std::tie(b.day, b.name);
+    });
+
+    RadixSort<DAY, NAME>(records, 2);
+    for(size_t i = 0; i < records.size(); ++i)
+        assert(records[i].sequence == expected[i].sequence);
+}
+
+void SortKeyTest()
+{
+    KeyOrderTest();
+    RadixSortTest();
+    FieldSubsetTest();
+}
@@ -0,0 +1,72 @@
+#include "../Table.h"
+#include <iostream>
+#include <string>
+#include "Benchmark.h"
+
+using namespace vklib;
+
+class BenchmarkUser
+{
+public:
+    int64_t id = 0;
+    std::string name;
+    int32_t age = 0;
+    std::string city = "Paris";
+
+    REFLECTABLE_FIELDS(id, name, age, city);
+};
+
+int main(int argc, char** argv)
+{
+    const size_t iterations = 1000000;
+    const int64_t rowCount = 100000;
+    constexpr uint32_t ID = Reflection::FindFieldId<BenchmarkUser>("id");
+    constexpr uint32_t AGE = Reflection::FindFieldId<BenchmarkUser>("age");
+    constexpr uint32_t CITY = Reflection::FindFieldId<BenchmarkUser>("city");
+
+    ReflectableTable<BenchmarkUser, HashIndex<ID>, OrderedIndex<AGE>> users;
+    for(int64_t i = 0; i < rowCount; ++i)
+    {
+        BenchmarkUser user;
+        user.id = i;
+        user.name = "user" + std::to_string(i);
+        user.age = static_cast<int32_t>(i % 100);
+        users.Insert(std::move(user));
+    }
+
+    int64_t id = 0;
+    Benchmark("FindFirst by hash index", iterations, [&]()
+    {
+        DoNotOptimize(users.FindFirst<ID>(id++ % rowCount));
+    });
+
+    id = 0;
+    Benchmark("Full scan by id", 100, [&]()
+    {
+        RowId found = users.NOT_FOUND;
+        const int64_t key = id++ * 997 % rowCount;
+        users.ForEach([&](RowId row, const BenchmarkUser& user) { if(user.id == key) found = row; });
+        DoNotOptimize(found);
+    });
+
+    Benchmark("ForEachInRange of 1% rows", 1000, [&]()
+    {
+        size_t count = 0;
+        users.ForEachInRange<AGE>(42, 43, [&](RowId) { ++count; });
+        DoNotOptimize(count);
+    });
+
+    RowId row = 0;
+    Benchmark("SetFieldValue of not indexed field", iterations, [&]()
+    {
+        users.SetFieldValue<CITY>(row++ % rowCount, "Rome");
+    });
+
+    row = 0;
+    int32_t age = 0;
+    Benchmark("SetFieldValue of indexed field", iterations / 10, [&]()
+    {
+        users.SetFieldValue<AGE>(row++ % rowCount, age++ % 100);
+    });
+    return 0;
+}
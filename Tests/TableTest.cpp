@@ -0,0 +1,93 @@
+#include "../Table.h"
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+class TableTestUser
+{
+public:
+    int64_t id = 0;
+    std::string name;
+    int32_t age = 0;
+    std::string city;
+
+    REFLECTABLE_FIELDS(id, name, age, city);
+};
+
+static TableTestUser MakeUser(int64_t id, const std::string& name, int32_t age, const std::string& city)
+{
+    TableTestUser user;
+    user.id = id;
+    user.name = name;
+    user.age = age;
+    user.city = city;
+    return user;
+}
+
+static std::vector<RowId> Sorted(std::vector<RowId> rows)
+{
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+void TableTest()
+{
+    typedef TableTestUser User;
+    constexpr uint32_t ID = Reflection::FindFieldId<User>("id");
+    constexpr uint32_t NAME = Reflection::FindFieldId<User>("name");
+    constexpr uint32_t AGE = Reflection::FindFieldId<User>("age");
+    constexpr uint32_t CITY = Reflection::FindFieldId<User>("city");
+
+    ReflectableTable<User, HashIndex<ID>, HashIndex<NAME>, OrderedIndex<AGE>, OrderedIndex<NAME>> users;
+    const RowId alice = users.Insert(MakeUser(1, "alice", 30, "Paris"));
+    const RowId bob = users.Insert(MakeUser(2, "bob", 17, "Rome"));
+    const RowId carol = users.Insert(MakeUser(3, "carol", 45, "Paris"));
+    const RowId dave = users.Insert(MakeUser(4, "bob", 30, "Oslo"));
+    assert(users.size() == 4);
+
+    //  Equality lookups
+    assert(users.FindFirst<ID>(3) == carol && users.Get(carol).name == "carol");
+    assert(users.FindFirst<ID>(5) == users.NOT_FOUND);
+    assert(Sorted(users.Find<NAME>("bob")) == std::vector<RowId>({ bob, dave }));
+    assert(Sorted(users.Find<AGE>(30)) == std::vector<RowId>({ alice, dave }));
+
+    //  Range lookups are ordered by the field
+    assert(users.FindRange<AGE>(18, 46) == std::vector<RowId>({ alice, dave, carol }));
+    assert(users.FindRange<NAME>("b", "c") == std::vector<RowId>({ bob, dave }));
+    assert(users.FindRange<AGE>(100, 200).empty());
+
+    //  Field update moves the row in the indexes of the field
+    assert(users.SetFieldValue<AGE>(bob, 18));
+    assert(users.Find<AGE>(17).empty() && users.Find<AGE>(18) == std::vector<RowId>({ bob }));
+    assert(users.SetFieldValue<CITY>(bob, std::string("Milan")));
+    assert(users.Get(bob).city == "Milan");
+
+    //  Update of the whole row
+    User renamed = users.Get(dave);
+    renamed.name = "dan";
+    assert(users.Update(dave, renamed));
+    assert(users.Find<NAME>("bob") == std::vector<RowId>({ bob }));
+    assert(users.FindFirst<NAME>("dan") == dave && users.FindRange<NAME>("d", "e") == std::vector<RowId>({ dave }));
+    assert(Sorted(users.Find<AGE>(30)) == std::vector<RowId>({ alice, dave }));
+
+    //  Erased rows disappear from indexes, their ids are reused
+    assert(users.Erase(alice) && !users.Erase(alice) && !users.Contains(alice));
+    assert(users.FindFirst<ID>(1) == users.NOT_FOUND && users.Find<AGE>(30) == std::vector<RowId>({ dave }));
+
+    //  Erased and unknown rows can't be changed
+    assert(!users.SetFieldValue<AGE>(alice, 30) && !users.Update(alice, renamed) && !users.Update(100, renamed));
+    assert(users.Find<AGE>(30) == std::vector<RowId>({ dave }) && users.FindRange<NAME>("d", "e") == std::vector<RowId>({ dave }));
+    assert(users.size() == 3);
+    const RowId eve = users.Insert(MakeUser(5, "eve", 30, "Paris"));
+    assert(eve == alice && users.FindFirst<ID>(5) == eve);
+
+    size_t count = 0;
+    users.ForEach([&](RowId row, const User& user) { assert(users.FindFirst<ID>(user.id) == row); ++count; });
+    assert(count == users.size());
+
+    users.Clear();
+    assert(users.empty() && users.Find<NAME>("bob").empty());
+}
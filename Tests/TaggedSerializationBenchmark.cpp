@@ -0,0 +1,85 @@
+#include "../TaggedSerialization.h"
+#include <iostream>
+#include "Benchmark.h"
+
+using namespace vklib;
+
+class BenchmarkTaggedPoint
+{
+public:
+    int32_t x = 1200;
+    int32_t y = -3400;
+    double weight = 0.125;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(x, y, weight);
+};
+
+class BenchmarkTaggedMessage
+{
+public:
+    uint64_t id = 123456789;
+    std::string name = "benchmark message";
+    bool active = true;
+    BenchmarkTaggedPoint origin;
+    std::vector<int32_t> samples { 1, 2, 3, 4, 5, 6, 7, 8 };
+    std::vector<BenchmarkTaggedPoint> points { BenchmarkTaggedPoint(), BenchmarkTaggedPoint() };
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(id, name, active, origin, samples, points);
+};
+
+//
+//  Older reader: fields are reordered, "active" is unknown to it
+//
+class BenchmarkTaggedMessageV1
+{
+public:
+    std::vector<BenchmarkTaggedPoint> points;
+    std::vector<int32_t> samples;
+    BenchmarkTaggedPoint origin;
+    std::string name;
+    uint64_t id = 0;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(points, samples, origin, name, id);
+};
+
+int main(int argc, char** argv)
+{
+    const size_t iterations = 1000000;
+    BenchmarkTaggedMessage message;
+    std::string binary;
+    std::string tagged;
+
+    Benchmark("BinarySerialize", iterations, [&]()
+    {
+        binary.clear();
+        BinarySerialize(binary, message);
+        DoNotOptimize(binary);
+    });
+
+    Benchmark("TaggedSerialize", iterations, [&]()
+    {
+        tagged.clear();
+        TaggedSerialize(tagged, message);
+        DoNotOptimize(tagged);
+    });
+
+    BenchmarkTaggedMessage target;
+    Benchmark("BinaryDeserialize", iterations, [&]()
+    {
+        DoNotOptimize(BinaryDeserialize(binary, target));
+    });
+
+    Benchmark("TaggedDeserialize in order", iterations, [&]()
+    {
+        DoNotOptimize(TaggedDeserialize(tagged, target));
+    });
+
+    BenchmarkTaggedMessageV1 oldTarget;
+    Benchmark("TaggedDeserialize reordered with unknown field", iterations, [&]()
+    {
+        DoNotOptimize(TaggedDeserialize(tagged, oldTarget));
+    });
+
+    std::cout << "binary size: " << binary.size() << " bytes, tagged size: " << tagged.size() << " bytes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,202 @@
+#include "../TaggedSerialization.h"
+#include <cassert>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace vklib;
+
+class TaggedTestItemV1
+{
+public:
+    int32_t id = 0;
+    std::string name;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(id, name);
+};
+
+class TaggedTestRecordV1
+{
+public:
+    int64_t id = 0;
+    std::string name;
+    int32_t obsolete = 0;
+    std::vector<TaggedTestItemV1> items;
+    TaggedTestItemV1 main;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(id, name, obsolete, items, main);
+};
+
+//
+//  Next version: fields are reordered, added and removed
+//
+class TaggedTestItemV2
+{
+public:
+    std::string name;
+    int32_t id = 0;
+    double weight = 1.5;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(name, id, weight);
+};
+
+class TaggedTestRecordV2
+{
+public:
+    std::vector<TaggedTestItemV2> items;
+    int64_t id = 0;
+    std::string name;
+    std::map<std::string, int32_t> counters;
+    TaggedTestItemV2 main;
+    int32_t version = 2;
+    std::unique_ptr<TaggedTestItemV2> optional;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(items, id, name, counters, main, version, optional);
+};
+
+//
+//  Explicit tags keep the wire format when fields are renamed
+//
+class TaggedTestExplicitV1
+{
+public:
+    int32_t count = 0;
+    std::string title;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(count, title);
+    FIELD_TAGS((count, 1), (title, 2));
+};
+
+class TaggedTestExplicitV2
+{
+public:
+    std::string caption;
+    int32_t total = 0;
+
+    REFLECTABLE_SERIALIZABLE_FIELDS(caption, total);
+    FIELD_TAGS((total, 1), (caption, 2));
+};
+
+static TaggedTestRecordV1 MakeRecordV1()
+{
+    TaggedTestRecordV1 record;
+    record.id = 1234567890123;
+    record.name = "record";
+    record.obsolete = 77;
+    record.items = { { 1, "first" }, { 2, "second" } };
+    record.main = { 3, "main" };
+    return record;
+}
+
+static void SchemaTest()
+{
+    typedef TaggedSchema<TaggedTestExplicitV2> ExplicitSchema;
+    static_assert(ExplicitSchema::tags[0] == 2 && ExplicitSchema::tags[1] == 1);
+    static_assert(ExplicitSchema::FindFieldId(1) == 1 && ExplicitSchema::FindFieldId(2) == 0);
+    static_assert(ExplicitSchema::FindFieldId(3) == ExplicitSchema::COUNT_OF_FIELDS);
+
+    //  Derived tags depend only on the name
+    typedef TaggedSchema<TaggedTestRecordV1> SchemaV1;
+    typedef TaggedSchema<TaggedTestRecordV2> SchemaV2;
+    static_assert(SchemaV1::tags[0] == SchemaV2::tags[1] && SchemaV1::tags[1] == SchemaV2::tags[2]);
+    static_assert(SchemaV1::tags[0] >= SchemaV1::DERIVED_TAG_BIT);
+    static_assert(SchemaV2::FindFieldId(SchemaV1::tags[3]) == 0);
+    static_assert(SchemaV2::FindFieldId(SchemaV1::tags[2]) == SchemaV2::COUNT_OF_FIELDS);
+}
+
+static void RoundTripTest()
+{
+    const TaggedTestRecordV1 record = MakeRecordV1();
+    std::string buffer;
+    TaggedSerialize(buffer, record);
+
+    TaggedTestRecordV1 copy;
+    assert(TaggedDeserialize(buffer, copy));
+    assert(copy.id == record.id && copy.name == record.name && copy.obsolete == record.obsolete);
+    assert(copy.items.size() == 2 && copy.items[1].id == 2 && copy.items[1].name == "second");
+    assert(copy.main.id == 3 && copy.main.name == "main");
+
+    //  Truncated data and trailing bytes are rejected
+    for(size_t size = 0; size < buffer.size(); ++size)
+        assert(!TaggedDeserialize(buffer.data(), size, copy));
+    assert(!TaggedDeserialize(buffer + '\0', copy));
+}
+
+static void UpgradeTest()
+{
+    //  New reader: old data, missing fields are defaulted, removed are skipped
+    const TaggedTestRecordV1 record = MakeRecordV1();
+    std::string buffer;
+    TaggedSerialize(buffer, record);
+
+    TaggedTestRecordV2 upgraded;
+    upgraded.counters["stale"] = 1;
+    upgraded.version = 5;
+    upgraded.optional = std::make_unique<TaggedTestItemV2>();
+    assert(TaggedDeserialize(buffer, upgraded));
+    assert(upgraded.id == record.id && upgraded.name == record.name);
+    assert(upgraded.items.size() == 2);
+    assert(upgraded.items[0].id == 1 && upgraded.items[0].name == "first" && upgraded.items[0].weight == 1.5);
+    assert(upgraded.main.id == 3 && upgraded.main.name == "main" && upgraded.main.weight == 1.5);
+    assert(upgraded.counters.empty() && upgraded.version == 2 && !upgraded.optional);
+
+    //  Old reader: new data, unknown fields are skipped
+    upgraded.counters["hits"] = 10;
+    upgraded.items[1].weight = 7;
+    upgraded.optional = std::make_unique<TaggedTestItemV2>();
+    upgraded.optional->name = "optional";
+    buffer.clear();
+    TaggedSerialize(buffer, upgraded);
+
+    TaggedTestRecordV1 downgraded;
+    downgraded.obsolete = 5;
+    assert(TaggedDeserialize(buffer, downgraded));
+    assert(downgraded.id == record.id && downgraded.name == record.name && downgraded.obsolete == 0);
+    assert(downgraded.items.size() == 2 && downgraded.items[1].id == 2 && downgraded.items[1].name == "second");
+    assert(downgraded.main.id == 3 && downgraded.main.name == "main");
+}
+
+static void ExplicitTagsTest()
+{
+    TaggedTestExplicitV1 original;
+    original.count = 42;
+    original.title = "title";
+    std::vector<uint8_t> buffer;
+    TaggedSerialize(buffer, original);
+    //  Size, then tag 1 and its size followed by int32
+    assert(buffer.size() > 5 && buffer[4] == 1);
+
+    TaggedTestExplicitV2 renamed;
+    assert(TaggedDeserialize(buffer, renamed));
+    assert(renamed.total == 42 && renamed.caption == "title");
+}
+
+static void CorruptedTest()
+{
+    TaggedTestExplicitV1 original;
+    original.count = 42;
+    original.title = "title";
+    std::string buffer;
+    TaggedSerialize(buffer, original);
+
+    //  Size of the field doesn't match its value
+    std::string corrupted = buffer;
+    corrupted[5] = 3;
+    TaggedTestExplicitV1 copy;
+    assert(!TaggedDeserialize(corrupted, copy));
+
+    //  Size of the field exceeds size of the object
+    corrupted = buffer;
+    corrupted[5] = 100;
+    assert(!TaggedDeserialize(corrupted, copy));
+}
+
+void TaggedSerializationTest()
+{
+    SchemaTest();
+    RoundTripTest();
+    UpgradeTest();
+    ExplicitTagsTest();
+    CorruptedTest();
+}
@@ -0,0 +1,233 @@
+#include "../Reflection.h"
+#include "../PagedWriter.h"
+#include "../ToString.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <new>
+
+using namespace vklib;
+
+static std::atomic<size_t> allocationCount { 0 };
+
+//
+//  All forms except over-aligned ones are replaced, so memory is never freed
+//  by another implementation (e.g. by the one of a sanitizer)
+//
+static void* CountedAllocate(size_t size) noexcept
+{
+    ++allocationCount;
+#ifdef VKLIB_INSTRUMENTATION
+    ++vklib::instrumentationAllocationCount;
+#endif
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size)
+{
+    if(void* ptr = CountedAllocate(size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    if(void* ptr = CountedAllocate(size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+
+class TextWriterTestClass
+{
+    int intField = -17;
+    unsigned long long longField = std::numeric_limits<unsigned long long>::max();
+    double doubleField = 0.1;
+    float floatField = 1e-7f;
+    char charField = 'z';
+    bool boolField = false;
+    std::string stringField = "text";
+    std::vector<double> vectorField { 1e20, -2.5, 100000, 1234567 };
+
+    REFLECTABLE_FIELDS(intField, longField, doubleField, floatField, charField, boolField, stringField, vectorField);
+};
+
+template<class ObjectT>
+static void CompareWithStreamTest(const ObjectT& obj)
+{
+    std::stringstream stream;
+    ToString(stream, obj);
+
+    TextBuffer<> buffer;
+    ToString(buffer, obj);
+    assert(buffer.View() == stream.str());
+}
+
+static void SpillTest()
+{
+    TextBuffer<8> buffer;
+    std::string expected;
+    for(int i = 0; i < 100; ++i)
+    {
+        buffer << i << ',';
+        expected += std::to_string(i) + ",";
+    }
+    assert(buffer.Str() == expected);
+}
+
+static void NoAllocationTest()
+{
+    TextWriterTestClass obj;
+    TextBuffer<16> buffer;
+    ToString(buffer, obj);
+
+    const size_t count = allocationCount;
+    for(int i = 0; i < 10; ++i)
+    {
+        buffer.Clear();
+        ToString(buffer, obj);
+    }
+    assert(allocationCount == count);
+}
+
+class PagedWriterTestClass
+{
+public:
+    std::string name = std::string(10000, 'n');
+    std::vector<int> values = std::vector<int>(100000, 12345);
+
+    REFLECTABLE_FIELDS(name, values);
+};
+
+static void PagedWriterTest()
+{
+    PagedWriterTestClass obj;
+    const std::string expected = ToString(obj);
+
+    //  Small writes are collected in pages, large ones are passed as is
+    std::string text;
+    size_t maxBlock = 0;
+    size_t blockCount = 0;
+    const size_t count = allocationCount;
+    {
+        CallbackWriter<std::function<void(const char*, size_t)>, 1024> writer([&](const char*, size_t size)
+        {
+            maxBlock = std::max(maxBlock, size);
+            ++blockCount;
+        });
+        ToString(writer, obj);
+    }
+    assert(allocationCount - count <= 3);
+    assert(maxBlock == obj.name.size());
+    assert(blockCount > (expected.size() - obj.name.size()) / 1024);
+
+    {
+        CallbackWriter writer([&](const char* data, size_t size) { text.append(data, size); });
+        ToString(writer, obj);
+        assert(text.size() < expected.size());
+    }
+    assert(text == expected);
+
+    //  File descriptor
+    const char* path = "PagedWriterTest.txt";
+    const int fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    assert(fd >= 0);
+    {
+        FdWriter<4096> writer(fd);
+        ToString(writer, obj);
+        writer << '\n' << 42;
+        assert(writer.Flush());
+    }
+    close(fd);
+
+    std::string written(expected.size() + 3, '\0');
+    FILE* file = fopen(path, "rb");
+    assert(fread(&written[0], 1, written.size() + 1, file) == written.size());
+    fclose(file);
+    std::remove(path);
+    assert(written == expected + "\n42");
+
+    FdWriter<16> closed(-1);
+    closed << std::string(100, 'x');
+    assert(!closed.Good() && !closed.Flush());
+}
+
+class BoundedTestNode
+{
+public:
+    int value = 0;
+    std::vector<int> items;
+    std::unordered_map<int, int> index;
+    std::unique_ptr<BoundedTestNode> next;
+
+    REFLECTABLE_FIELDS(value, items, index, next);
+};
+
+static void BoundedWriterTest()
+{
+    BoundedTestNode node;
+    node.value = 1;
+    node.items = { 1, 2, 3, 4, 5 };
+    node.next = std::make_unique<BoundedTestNode>();
+    node.next->value = 2;
+    node.next->next = std::make_unique<BoundedTestNode>();
+    node.next->next->value = 3;
+    assert(ToString(node) == "{value=1,items=[1,2,3,4,5],index=[],next={value=2,items=[],index=[],next={value=3,items=[],index=[],next=null}}}");
+
+    //  Items and depth
+    PrintLimits limits;
+    limits.maxItems = 2;
+    limits.maxDepth = 2;
+    assert(BoundedToString(node, limits) == "{value=1,items=[1,2,...(+3 more)],index=[],next={value=2,items=[...],index=[...],next={...}}}");
+    limits.maxItems = 0;
+    limits.maxDepth = 1;
+    assert(BoundedToString(node, limits) == "{value=1,items=[...],index=[...],next={...}}");
+    limits.maxDepth = 0;
+    assert(BoundedToString(node, limits) == "{...}");
+
+    //  Byte budget truncates the text and stops traversal
+    limits = PrintLimits();
+    limits.maxBytes = 20;
+    assert(BoundedToString(node, limits) == "{value=1,items=[1,2,...");
+
+    //  Cost doesn't depend on size of the container beyond the limits
+    for(int i = 0; i < 100000; ++i)
+        node.index[i] = i;
+    limits = PrintLimits();
+    limits.maxItems = 1;
+    const std::string text = BoundedToString(node, limits);
+    assert(text.find(",...(+99999 more)]") != std::string::npos && text.size() < 200);
+
+    //  Any sink
+    std::stringstream stream;
+    limits.maxBytes = 10;
+    BoundedToString(stream, node, limits);
+    assert(stream.str() == "{value=1,i...");
+}
+
+void TextWriterTest()
+{
+    BoundedWriterTest();
+    CompareWithStreamTest(TextWriterTestClass());
+    CompareWithStreamTest(std::make_tuple(std::numeric_limits<double>::infinity(), -0.0, 123456789.0, (signed char)'a'));
+    SpillTest();
+    NoAllocationTest();
+    PagedWriterTest();
+}
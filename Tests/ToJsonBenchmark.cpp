@@ -0,0 +1,74 @@
+#include "../Reflection.h"
+#include "../ToJson.h"
+#include "Benchmark.h"
+
+using namespace vklib;
+
+class JsonBenchmarkWide
+{
+    int32_t f00 = 0, f01 = 1, f02 = 2, f03 = 3, f04 = 4, f05 = 5, f06 = 6, f07 = 7;
+    double d00 = 0.5, d01 = 1.5, d02 = 2.5, d03 = 3.5, d04 = 4.5, d05 = 5.5, d06 = 6.5, d07 = 7.5;
+    bool b00 = true, b01 = false, b02 = true, b03 = false;
+    std::string s00 = "first string value", s01 = "second \"quoted\" value";
+    std::string s02 = "a somewhat longer string value, which doesn't need any escaping at all";
+    std::string s03 = "path\\to\\file";
+
+    REFLECTABLE_FIELDS(f00, f01, f02, f03, f04, f05, f06, f07, d00, d01, d02, d03, d04, d05, d06, d07,
+        b00, b01, b02, b03, s00, s01, s02, s03);
+};
+
+template<int depth>
+class JsonBenchmarkNested
+{
+    int32_t level = depth;
+    std::string name = "nested level";
+    std::vector<int32_t> values { depth, depth + 1, depth + 2 };
+    JsonBenchmarkNested<depth - 1> child;
+
+    REFLECTABLE_FIELDS(level, name, values, child);
+};
+
+template<>
+class JsonBenchmarkNested<0>
+{
+    int32_t level = 0;
+    std::string name = "leaf";
+
+    REFLECTABLE_FIELDS(level, name);
+};
+
+template<class ObjectT>
+void Run(const char* name, const ObjectT& obj)
+{
+    const size_t iterations = 500000;
+    std::cout << name << std::endl;
+
+    Benchmark("  ToString(std::stringstream)", iterations, [&]()
+    {
+        std::stringstream stream;
+        ToString(stream, obj);
+        DoNotOptimize(stream);
+    });
+
+    Benchmark("  ToJson(std::stringstream)", iterations, [&]()
+    {
+        std::stringstream stream;
+        ToJson(stream, obj);
+        DoNotOptimize(stream);
+    });
+
+    TextBuffer<> buffer;
+    Benchmark("  ToJson(reused TextBuffer)", iterations, [&]()
+    {
+        buffer.Clear();
+        ToJson(buffer, obj);
+        DoNotOptimize(buffer);
+    });
+}
+
+int main(int argc, char** argv)
+{
+    Run("Wide", JsonBenchmarkWide());
+    Run("Nested", JsonBenchmarkNested<8>());
+    return 0;
+}
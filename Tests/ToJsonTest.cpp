@@ -0,0 +1,108 @@
+#include "../Reflection.h"
+#include "../ToJson.h"
+#include <cassert>
+#include <limits>
+
+using namespace vklib;
+
+class JsonTestClass1
+{
+    int intField = -3;
+    std::string stringField = "quote\" backslash\\ newline\n";
+    bool boolField = true;
+
+    REFLECTABLE_FIELDS(intField, stringField, boolField);
+};
+
+class JsonTestClass2
+{
+    std::unique_ptr<JsonTestClass1> classField { new JsonTestClass1() };
+    std::shared_ptr<JsonTestClass1> nullField;
+    double doubleField = 0.1;
+    double nanField = std::numeric_limits<double>::quiet_NaN();
+    char charField = 'c';
+    std::tuple<char, int> tupleField { 'c', 6786 };
+    std::map<std::string, std::vector<int>> mapField { { "a", { 1, 2 } }, { "b", {} } };
+    const char* pointerField = "text";
+
+    REFLECTABLE_FIELDS(classField, nullField, doubleField, nanField, charField, tupleField, mapField, pointerField);
+};
+
+static std::string ReferenceEscape(const std::string& value)
+{
+    std::string result;
+    for(unsigned char c : value)
+    {
+        if(c == '"' || c == '\\')
+        {
+            result += '\\';
+            result += c;
+        }
+        else if(c < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            result += escaped;
+        }
+        else
+            result += c;
+    }
+    return result;
+}
+
+static void ObjectTest()
+{
+    JsonTestClass2 obj;
+    std::string expected = "{\"classField\":{\"intField\":-3,\"stringField\":\"quote\\\" backslash\\\\ newline\\n\",\"boolField\":true},"
+        "\"nullField\":null,\"doubleField\":0.1,\"nanField\":null,\"charField\":\"c\",\"tupleField\":[\"c\",6786],"
+        "\"mapField\":[[\"a\",[1,2]],[\"b\",[]]],\"pointerField\":\"text\"}";
+    assert(ToJson(obj) == expected);
+
+    std::stringstream stream;
+    ToJson(stream, obj);
+    assert(stream.str() == expected);
+}
+
+class JsonTestWide
+{
+public:
+    const wchar_t* text = L"wide \"\u00e9\u20ac\U0001F600";
+    const wchar_t* nullText = nullptr;
+
+    REFLECTABLE_FIELDS(text, nullText);
+};
+
+static void WideStringTest()
+{
+    //  Wide strings are narrowed to UTF-8 and escaped
+    JsonTestWide obj;
+    assert(ToJson(obj) == "{\"text\":\"wide \\\"\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80\",\"nullText\":null}");
+    assert(ToString(obj) == "{text=wide \"\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80,nullText=null}");
+}
+
+static void EscapeTest()
+{
+    const char special[] = { '"', '\\', '\x01', '\x1F', '\x7F', '\x80', '\xFF' };
+    for(size_t size : { 1, 15, 16, 17, 31, 32, 33, 64, 100 })
+    {
+        for(size_t position = 0; position < size; ++position)
+        {
+            for(char c : special)
+            {
+                std::string value(size, 'a');
+                value[position] = c;
+
+                TextBuffer<> buffer;
+                JsonEscape(buffer, value);
+                assert(buffer.View() == ReferenceEscape(value));
+            }
+        }
+    }
+}
+
+void ToJsonTest()
+{
+    ObjectTest();
+    WideStringTest();
+    EscapeTest();
+}
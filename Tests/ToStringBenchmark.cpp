@@ -0,0 +1,92 @@
+#include "../Reflection.h"
+#include "../ToString.h"
+#include "Benchmark.h"
+
+using namespace vklib;
+
+class ToStringBenchmarkPoint
+{
+    int32_t x = 1200;
+    int32_t y = -3400;
+    double weight = 0.125;
+
+    REFLECTABLE_FIELDS(x, y, weight);
+};
+
+class ToStringBenchmarkMessage
+{
+    uint64_t id = 123456789;
+    std::string name = "benchmark message";
+    bool active = true;
+    ToStringBenchmarkPoint origin;
+    std::vector<int32_t> samples { 1, 2, 3, 4, 5, 6, 7, 8 };
+    std::map<std::string, ToStringBenchmarkPoint> points { { "a", ToStringBenchmarkPoint() }, { "b", ToStringBenchmarkPoint() } };
+
+    REFLECTABLE_FIELDS(id, name, active, origin, samples, points);
+};
+
+class ToStringBenchmarkCache
+{
+public:
+    std::string name = "cache";
+    std::unordered_map<int32_t, int32_t> entries;
+
+    REFLECTABLE_FIELDS(name, entries);
+};
+
+int main(int argc, char** argv)
+{
+    const size_t iterations = 1000000;
+    ToStringBenchmarkMessage message;
+
+    Benchmark("ToString(std::stringstream)", iterations, [&]()
+    {
+        std::stringstream stream;
+        ToString(stream, message);
+        DoNotOptimize(stream);
+    });
+
+    Benchmark("ToString", iterations, [&]()
+    {
+        DoNotOptimize(ToString(message));
+    });
+
+    TextBuffer<> buffer;
+    Benchmark("ToString(reused TextBuffer)", iterations, [&]()
+    {
+        buffer.Clear();
+        ToString(buffer, message);
+        DoNotOptimize(buffer);
+    });
+
+    Benchmark("BoundedToString(reused TextBuffer)", iterations, [&]()
+    {
+        buffer.Clear();
+        BoundedToString(buffer, message, PrintLimits());
+        DoNotOptimize(buffer);
+    });
+
+    //  Object with a million entries
+    ToStringBenchmarkCache cache;
+    for(int32_t i = 0; i < 1000000; ++i)
+        cache.entries[i] = i;
+
+    Benchmark("ToString of 1M entries", 10, [&]()
+    {
+        buffer.Clear();
+        ToString(buffer, cache);
+        DoNotOptimize(buffer);
+    });
+
+    PrintLimits limits;
+    limits.maxBytes = 4096;
+    limits.maxItems = 64;
+    Benchmark("BoundedToString of 1M entries", iterations, [&]()
+    {
+        buffer.Clear();
+        BoundedToString(buffer, cache, limits);
+        DoNotOptimize(buffer);
+    });
+
+    return 0;
+}
@@ -0,0 +1,296 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains text sinks for ObjectPrinter (see ToString.h), which
+//  replace std::stringstream on hot paths.
+//  TextFormatter implements stream-like operator<< on top of the single
+//  Write(const char* data, size_t size) function of the derived class.
+//  Numbers are formatted with std::to_chars and produce the same text as
+//  std::ostream with default flags. Other types are formatted through their
+//  std::ostream operator<< (slow path).
+//  TextBuffer keeps the text in a small inline buffer and spills to the heap
+//  when it is exceeded. Clear() keeps the heap storage, so a buffer reused
+//  between calls doesn't allocate in steady state.
+//  StringWriter appends the text to an existing std::string.
+//  BoundedWriter passes the text to another sink until its byte budget is
+//  spent, ObjectPrinter also stops traversal and limits count of printed
+//  items of containers and nesting depth when it writes to BoundedWriter.
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <charconv>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace vklib
+{
+
+template<class DerivedT>
+class TextFormatter
+{
+protected:
+    DerivedT& Self() { return static_cast<DerivedT&>(*this); }
+
+    template<class T>
+    DerivedT& WriteNumber(T value)
+    {
+        char text[64];
+        const auto result = std::to_chars(text, text + sizeof(text), value);
+        Self().Write(text, result.ptr - text);
+        return Self();
+    }
+
+    template<class T>
+    DerivedT& WriteFloat(T value)
+    {
+        char text[64];
+        const auto result = std::to_chars(text, text + sizeof(text), value, std::chars_format::general, 6);
+        Self().Write(text, result.ptr - text);
+        return Self();
+    }
+
+    template<class T>
+    struct IsChar : std::integral_constant<bool,
+        std::is_same<T, char>::value || std::is_same<T, signed char>::value || std::is_same<T, unsigned char>::value> {};
+
+public:
+    DerivedT& operator<<(const char* value)
+    {
+        Self().Write(value, strlen(value));
+        return Self();
+    }
+
+    DerivedT& operator<<(char value)
+    {
+        Self().Write(&value, 1);
+        return Self();
+    }
+
+    DerivedT& operator<<(signed char value) { return *this << static_cast<char>(value); }
+
+    DerivedT& operator<<(unsigned char value) { return *this << static_cast<char>(value); }
+
+    DerivedT& operator<<(bool value) { return *this << (value ? '1' : '0'); }
+
+    DerivedT& operator<<(std::string_view value)
+    {
+        Self().Write(value.data(), value.size());
+        return Self();
+    }
+
+    template<class Traits, class Allocator>
+    DerivedT& operator<<(const std::basic_string<char, Traits, Allocator>& value)
+    {
+        Self().Write(value.data(), value.size());
+        return Self();
+    }
+
+    template<class T>
+    typename std::enable_if_t<std::is_integral<T>::value && !IsChar<T>::value && !std::is_same<T, bool>::value
+        && !std::is_same<T, wchar_t>::value, DerivedT&> operator<<(T value)
+    {
+        return WriteNumber(value);
+    }
+
+    template<class T>
+    typename std::enable_if_t<std::is_floating_point<T>::value, DerivedT&> operator<<(T value)
+    {
+        return WriteFloat(value);
+    }
+
+    template<class T>
+    typename std::enable_if_t<std::is_enum<T>::value, DerivedT&> operator<<(T value)
+    {
+        return WriteNumber(static_cast<std::underlying_type_t<T>>(value));
+    }
+
+    //
+    //  General case - format through std::ostream
+    //
+    template<class T>
+    typename std::enable_if_t<!std::is_arithmetic<T>::value && !std::is_enum<T>::value
+        && !std::is_convertible<const T&, const char*>::value
+        && !std::is_convertible<const T&, std::string_view>::value, DerivedT&> operator<<(const T& value)
+    {
+        std::ostringstream stream;
+        stream << value;
+        return *this << stream.str();
+    }
+};
+
+template<size_t InlineSize = 256>
+class TextBuffer : public TextFormatter<TextBuffer<InlineSize>>
+{
+protected:
+    char _inline[InlineSize];
+    std::unique_ptr<char[]> _heap;
+    char* _data = _inline;
+    size_t _size = 0;
+    size_t _capacity = InlineSize;
+
+    void Grow(size_t size)
+    {
+        size_t capacity = _capacity * 2;
+        while(capacity < size)
+            capacity *= 2;
+
+        std::unique_ptr<char[]> heap(new char[capacity]);
+        memcpy(heap.get(), _data, _size);
+        _heap = std::move(heap);
+        _data = _heap.get();
+        _capacity = capacity;
+    }
+
+public:
+    TextBuffer() = default;
+    TextBuffer(const TextBuffer&) = delete;
+    TextBuffer& operator=(const TextBuffer&) = delete;
+
+    void Write(const char* data, size_t size)
+    {
+        if(_size + size > _capacity)
+            Grow(_size + size);
+
+        memcpy(_data + _size, data, size);
+        _size += size;
+    }
+
+    //
+    //  Drops the text, but keeps allocated storage
+    //
+    void Clear() { _size = 0; }
+
+    const char* Data() const { return _data; }
+
+    size_t Size() const { return _size; }
+
+    std::string_view View() const { return std::string_view(_data, _size); }
+
+    std::string Str() const { return std::string(_data, _size); }
+};
+
+//
+//  Appends the text to std::string owned by the caller
+//
+class StringWriter : public TextFormatter<StringWriter>
+{
+protected:
+    std::string& _text;
+
+public:
+    explicit StringWriter(std::string& text) : _text(text) {}
+
+    void Write(const char* data, size_t size) { _text.append(data, size); }
+
+    size_t Size() const { return _text.size(); }
+};
+
+struct PrintLimits
+{
+    //  Text beyond it is dropped and "..." is written instead
+    size_t maxBytes = SIZE_MAX;
+    //  Items of every container, the rest is written as "...(+N more)"
+    size_t maxItems = SIZE_MAX;
+    //  Nesting of containers and reflectable objects (the printed object is
+    //  at depth 1), deeper ones are written as "..."
+    size_t maxDepth = SIZE_MAX;
+};
+
+//
+//  Writes to another sink (std::ostream or sink from this file) at most
+//  maxBytes of text followed by "..." if the text is truncated
+//
+template<class StreamT>
+class BoundedWriter : public TextFormatter<BoundedWriter<StreamT>>
+{
+protected:
+    StreamT& _stream;
+    const PrintLimits _limits;
+    size_t _size = 0;
+    size_t _depth = 0;
+    bool _exhausted = false;
+
+public:
+    BoundedWriter(StreamT& stream, const PrintLimits& limits) : _stream(stream), _limits(limits) {}
+
+    void Write(const char* data, size_t size)
+    {
+        if(_exhausted)
+            return;
+
+        if(size > _limits.maxBytes - _size)
+        {
+            _stream << std::string_view(data, _limits.maxBytes - _size) << std::string_view("...");
+            _size = _limits.maxBytes;
+            _exhausted = true;
+            return;
+        }
+
+        _stream << std::string_view(data, size);
+        _size += size;
+    }
+
+    const PrintLimits& GetLimits() const { return _limits; }
+
+    //
+    //  Bytes written, not including "..."
+    //
+    size_t Size() const { return _size; }
+
+    //
+    //  True when the budget is spent, nothing is written anymore
+    //
+    bool IsExhausted() const { return _exhausted; }
+
+    //
+    //  Nesting of containers and objects. Enter returns false, if it's too
+    //  deep, then Leave isn't called.
+    //
+    bool Enter()
+    {
+        if(_depth >= _limits.maxDepth)
+            return false;
+
+        ++_depth;
+        return true;
+    }
+
+    void Leave() { --_depth; }
+};
+
+template<class StreamT>
+struct IsBoundedWriter : std::false_type {};
+
+template<class StreamT>
+struct IsBoundedWriter<BoundedWriter<StreamT>> : std::true_type {};
+
+};  //  namespace vklib
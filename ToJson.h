@@ -0,0 +1,228 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2018, Valentin Kuznetsov <valkuzn@gmail.com>
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+//
+//  This file contains implementation of ToJson function, which prints the same
+//  set of types as ToString (see ToString.h) as JSON:
+//  - reflectable classes become objects with field names as keys;
+//  - sequence and associative containers become arrays;
+//  - pairs and tuples (including items of maps) become arrays;
+//  - empty pointers and non-finite floating point numbers become null;
+//  - strings are quoted and escaped, types printed through std::ostream are
+//    written as strings.
+//  Strings are escaped by JsonEscape, which skips over the characters that
+//  don't need escaping 32 (AVX2) or 16 (SSE2) bytes at a time.
+//
+
+#pragma once
+
+#include "ToString.h"
+#include <math.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace vklib
+{
+
+//
+//  Returns position of the first character, which should be escaped in JSON
+//  string, or size if there is no such character
+//
+inline size_t JsonFindEscape(const char* data, size_t size)
+{
+    size_t position = 0;
+
+#if defined(__AVX2__)
+    const __m256i quote32 = _mm256_set1_epi8('"');
+    const __m256i backslash32 = _mm256_set1_epi8('\\');
+    const __m256i control32 = _mm256_set1_epi8(0x1F);
+    for(; position + 32 <= size; position += 32)
+    {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+        const __m256i mask = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote32), _mm256_cmpeq_epi8(chunk, backslash32)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control32), chunk));
+        const uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(mask));
+        if(bits)
+            return position + __builtin_ctz(bits);
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i quote16 = _mm_set1_epi8('"');
+    const __m128i backslash16 = _mm_set1_epi8('\\');
+    const __m128i control16 = _mm_set1_epi8(0x1F);
+    for(; position + 16 <= size; position += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+        const __m128i mask = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote16), _mm_cmpeq_epi8(chunk, backslash16)),
+            _mm_cmpeq_epi8(_mm_min_epu8(chunk, control16), chunk));
+        const uint32_t bits = static_cast<uint32_t>(_mm_movemask_epi8(mask));
+        if(bits)
+            return position + __builtin_ctz(bits);
+    }
+#endif
+
+    for(; position < size; ++position)
+    {
+        const unsigned char c = static_cast<unsigned char>(data[position]);
+        if(c < 0x20 || c == '"' || c == '\\')
+            return position;
+    }
+    return size;
+}
+
+//
+//  Writes JSON string content (without quotes) into stream
+//
+template<class StreamT>
+void JsonEscape(StreamT& stream, std::string_view value)
+{
+    const char* data = value.data();
+    size_t size = value.size();
+    while(size)
+    {
+        const size_t clean = JsonFindEscape(data, size);
+        if(clean)
+            stream << std::string_view(data, clean);
+
+        if(clean == size)
+            break;
+
+        const unsigned char c = static_cast<unsigned char>(data[clean]);
+        switch(c)
+        {
+        case '"': stream << std::string_view("\\\"", 2); break;
+        case '\\': stream << std::string_view("\\\\", 2); break;
+        case '\b': stream << std::string_view("\\b", 2); break;
+        case '\f': stream << std::string_view("\\f", 2); break;
+        case '\n': stream << std::string_view("\\n", 2); break;
+        case '\r': stream << std::string_view("\\r", 2); break;
+        case '\t': stream << std::string_view("\\t", 2); break;
+        default:
+            {
+                const char hex[] = "0123456789abcdef";
+                const char escaped[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+                stream << std::string_view(escaped, sizeof(escaped));
+            }
+        }
+        data += clean + 1;
+        size -= clean + 1;
+    }
+}
+
+struct JsonFormat
+{
+    static constexpr const char* ObjectBegin = "{";
+    static constexpr const char* ObjectEnd = "}";
+    static constexpr const char* FieldSeparator = ",";
+    static constexpr const char* NameBegin = "\"";
+    static constexpr const char* NameEnd = "\":";
+    static constexpr const char* TupleBegin = "[";
+    static constexpr const char* TupleEnd = "]";
+    static constexpr const char* Null = "null";
+
+    template<class StreamT>
+    static void WriteString(StreamT& stream, std::string_view value)
+    {
+        stream << '"';
+        JsonEscape(stream, value);
+        stream << '"';
+    }
+
+    template<class StreamT>
+    static void WriteValue(StreamT& stream, bool value)
+    {
+        stream << (value ? std::string_view("true") : std::string_view("false"));
+    }
+
+    template<class StreamT>
+    static void WriteValue(StreamT& stream, char value)
+    {
+        WriteString(stream, std::string_view(&value, 1));
+    }
+
+    template<class StreamT, class T>
+    static typename std::enable_if_t<std::is_integral<T>::value, void> WriteValue(StreamT& stream, T value)
+    {
+        char text[32];
+        const auto result = std::to_chars(text, text + sizeof(text), value);
+        stream << std::string_view(text, result.ptr - text);
+    }
+
+    //
+    //  Floating point numbers are written in the shortest form, which reads
+    //  back to the same value
+    //
+    template<class StreamT, class T>
+    static typename std::enable_if_t<std::is_floating_point<T>::value, void> WriteValue(StreamT& stream, T value)
+    {
+        if(!isfinite(value))
+        {
+            stream << std::string_view(Null);
+            return;
+        }
+
+        char text[64];
+        const auto result = std::to_chars(text, text + sizeof(text), value);
+        stream << std::string_view(text, result.ptr - text);
+    }
+
+    template<class StreamT, class T>
+    static typename std::enable_if_t<std::is_enum<T>::value, void> WriteValue(StreamT& stream, T value)
+    {
+        WriteValue(stream, static_cast<std::underlying_type_t<T>>(value));
+    }
+
+    template<class StreamT, class T>
+    static typename std::enable_if_t<!std::is_arithmetic<T>::value && !std::is_enum<T>::value, void>
+        WriteValue(StreamT& stream, const T& value)
+    {
+        std::ostringstream text;
+        text << value;
+        WriteString(stream, text.str());
+    }
+};
+
+template<class StreamT>
+using JsonPrinter = ObjectPrinter<StreamT, JsonFormat>;
+
+template<typename StreamT, typename ObjectT>
+void ToJson(StreamT& stream, ObjectT& obj)
+{
+    JsonPrinter<StreamT> printer(stream);
+    printer.Visit(obj);
+}
+
+template<typename ObjectT>
+std::string ToJson(ObjectT& obj)
+{
+    TextBuffer<> buffer;
+    ToJson(buffer, obj);
+    return buffer.Str();
+}
+
+};  //  namespace vklib
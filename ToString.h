@@ -27,74 +27,235 @@
 //  ToString extent STL string stream functions with support of STL containers
 //  (e.g. it's possible to call ToString for maps, tuples, smart pointers, etc.)
 //  and reflectable classes (see Reflection.h for details).
-
+//  ObjectPrinter writes to any stream-like sink: std::ostream or one of the
+//  allocation-free sinks from TextWriter.h. To print without allocations in
+//  steady state, reuse the buffer between calls:
+//  TextBuffer<> buffer;
+//  buffer.Clear();
+//  ToString(buffer, obj);
+//  Log(buffer.View());
+//  BoundedToString puts hard limit on the cost of printing of large objects:
+//  PrintLimits limits;
+//  limits.maxBytes = 4096;
+//  limits.maxItems = 16;
+//  Log(BoundedToString(obj, limits));
+//  Only some of the fields are printed with a projection (see Reflection.h):
+//  Log(ToString<Record::Key>(record));
+
+#pragma once
+
+#include "Reflection.h"
+#include "TextWriter.h"
+#include <array>
+#include <deque>
 #include <forward_list>
 #include <list>
 #include <set>
 #include <map>
+#include <string>
 #include <unordered_set>
 #include <unordered_map>
+#include <vector>
 
 namespace vklib
 {
 
-template<class StreamT>
-class ReflectionFieldStreamWriterVisitor
+//
+//  ToStringFormat defines ToString output: punctuation used by ObjectPrinter
+//  and FieldFormatPlan, and formatting of strings and other leaf values
+//
+struct ToStringFormat
 {
-    StreamT& _stream;
-    bool firstField = true;
+    static constexpr const char* ObjectBegin = "{";
+    static constexpr const char* ObjectEnd = "}";
+    static constexpr const char* FieldSeparator = ",";
+    static constexpr const char* NameBegin = "";
+    static constexpr const char* NameEnd = "=";
+    static constexpr const char* TupleBegin = "{";
+    static constexpr const char* TupleEnd = "}";
+    static constexpr const char* Null = "null";
+
+    template<class StreamT>
+    static void WriteString(StreamT& stream, std::string_view value)
+    {
+        stream << value;
+    }
+
+    template<class StreamT, class T>
+    static void WriteValue(StreamT& stream, const T& value)
+    {
+        stream << value;
+    }
+};
+
+//
+//  FieldFormatPlan merges constant text between field values of reflectable
+//  class T (punctuation from FormatT and field names) into literal runs at
+//  compile time. Run(i) precedes value of field i, Run(COUNT_OF_FIELDS)
+//  follows the last value, so the object is printed as
+//  Run(0) value0 Run(1) value1 ... Run(COUNT_OF_FIELDS)
+//  FieldIdsT restricts the plan to fields of a projection, in its order.
+//
+template<class T, class FormatT, class FieldIdsT = std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<T>()>>
+class FieldFormatPlanBuilder
+{
+    static constexpr uint32_t COUNT_OF_FIELDS = FieldIdsT::size();
+
+    template<uint32_t... Index>
+    static constexpr std::array<const char*, sizeof...(Index) + 1> GetNames(std::integer_sequence<uint32_t, Index...>)
+    {
+        return {{ Reflection::GetFieldName<T, Index>()..., "" }};
+    }
+
+    template<uint32_t... Index>
+    static constexpr std::array<uint32_t, sizeof...(Index) + 1> GetFieldIds(std::integer_sequence<uint32_t, Index...>)
+    {
+        return {{ Index..., 0 }};
+    }
+
+    static constexpr size_t Length(const char* text)
+    {
+        size_t length = 0;
+        while(text[length])
+            ++length;
+        return length;
+    }
+
+    static constexpr void Append(char* text, size_t& size, const char* value)
+    {
+        while(*value)
+            text[size++] = *value++;
+    }
 
 public:
-    ReflectionFieldStreamWriterVisitor(StreamT& stream) : _stream(stream) {}
+    static constexpr std::array<const char*, COUNT_OF_FIELDS + 1> names = GetNames(FieldIdsT());
+    static constexpr std::array<uint32_t, COUNT_OF_FIELDS + 1> fieldIds = GetFieldIds(FieldIdsT());
 
-    template<class T>
-    bool VisitField(const char* fieldName, const T& value)
+    static constexpr size_t Size()
     {
-        if(firstField)
-            firstField = false;
-        else
-            _stream << ",";
+        size_t size = Length(FormatT::ObjectBegin) + Length(FormatT::ObjectEnd);
+        for(uint32_t i = 0; i < COUNT_OF_FIELDS; ++i)
+        {
+            size += Length(FormatT::NameBegin) + Length(names[i]) + Length(FormatT::NameEnd);
+            if(i != 0)
+                size += Length(FormatT::FieldSeparator);
+        }
+        return size;
+    }
+
+    struct Plan
+    {
+        char text[Size() + 1];
+        size_t offsets[COUNT_OF_FIELDS + 2];
+    };
 
-        _stream << fieldName << "=" << value;
-        return true;
+    static constexpr Plan Build()
+    {
+        Plan plan {};
+        size_t size = 0;
+        Append(plan.text, size, FormatT::ObjectBegin);
+        for(uint32_t i = 0; i < COUNT_OF_FIELDS; ++i)
+        {
+            if(i != 0)
+            {
+                plan.offsets[i] = size;
+                Append(plan.text, size, FormatT::FieldSeparator);
+            }
+            Append(plan.text, size, FormatT::NameBegin);
+            Append(plan.text, size, names[i]);
+            Append(plan.text, size, FormatT::NameEnd);
+        }
+        plan.offsets[COUNT_OF_FIELDS] = COUNT_OF_FIELDS ? size : 0;
+        Append(plan.text, size, FormatT::ObjectEnd);
+        plan.offsets[COUNT_OF_FIELDS + 1] = size;
+        return plan;
     }
 };
 
-template<class StreamT>
+template<class T, class FormatT, class FieldIdsT = std::make_integer_sequence<uint32_t, Reflection::GetFieldCount<T>()>>
+class FieldFormatPlan
+{
+    typedef FieldFormatPlanBuilder<T, FormatT, FieldIdsT> Builder;
+
+    static constexpr typename Builder::Plan plan = Builder::Build();
+
+public:
+    static constexpr uint32_t COUNT_OF_FIELDS = FieldIdsT::size();
+
+    //  Id of the field printed after Run(position)
+    static constexpr uint32_t FieldId(uint32_t position)
+    {
+        return Builder::fieldIds[position];
+    }
+
+    static constexpr std::string_view Run(uint32_t index)
+    {
+        return std::string_view(plan.text + plan.offsets[index], plan.offsets[index + 1] - plan.offsets[index]);
+    }
+};
+
+template<class StreamT, class FormatT = ToStringFormat>
 class ObjectPrinter
 {
 protected:
     StreamT& _stream;
 
+    static constexpr bool IS_BOUNDED = IsBoundedWriter<StreamT>::value;
+
+    template<class T, class = void>
+    struct HasSize : std::false_type {};
+
     template<class T>
-    void _Print(const char* fieldName, const T& value, std::true_type)
-    {
-        _stream << fieldName << "={";
-        Reflection::VisitFields(value, *this);
-        _stream << "} ";
-        return true;
-    }
+    struct HasSize<T, std::void_t<decltype(std::declval<const T&>().size())>> : std::true_type {};
 
+    //
+    //  Writes "...(+N more)" for items, which exceed the limit
+    //
     template<class T>
-    bool VisitField(const char* fieldName, const T& value, std::false_type)
+    void WriteMore(const T& value, size_t printed)
     {
-        _stream << fieldName << "=" << value << " ";
-        return true;
+        _stream << (printed ? ",..." : "...");
+        if constexpr(HasSize<T>::value)
+            _stream << "(+" << static_cast<size_t>(value.size() - printed) << " more)";
     }
 
     template<class T>
     void VisitList(const T& value)
     {
         _stream << "[";
-        bool first = true;
-        for(const auto& item : value)
+        if constexpr(IS_BOUNDED)
         {
-            if(first)
-                first = false;
+            if(!_stream.Enter())
+                _stream << "...";
             else
-                _stream << ',';
-
-            Visit(item);
+            {
+                size_t printed = 0;
+                for(auto it = value.begin(); it != value.end() && !_stream.IsExhausted(); ++it, ++printed)
+                {
+                    if(printed == _stream.GetLimits().maxItems)
+                    {
+                        WriteMore(value, printed);
+                        break;
+                    }
+                    if(printed)
+                        _stream << ',';
+                    Visit(*it);
+                }
+                _stream.Leave();
+            }
+        }
+        else
+        {
+            bool first = true;
+            for(const auto& item : value)
+            {
+                if(first)
+                    first = false;
+                else
+                    _stream << ',';
+
+                Visit(item);
+            }
         }
         _stream << "]";
     }
@@ -105,28 +266,66 @@ protected:
         if(value)
             Visit(*value);
         else
-            _stream << "null";
+            _stream << FormatT::Null;
     }
 
-    template<int fieldId, typename T, typename S>
-    struct TupleVisitor
+    //
+    //  Prints fields of the plan, Position is index of the field in the plan
+    //
+    template<class Plan, class T, uint32_t... Position>
+    void VisitFields(const T& value, std::integer_sequence<uint32_t, Position...>)
     {
-        static void Visit(S& stream, const T& value)
+        if constexpr(IS_BOUNDED)
         {
-            TupleVisitor<fieldId-1, T, S>::Visit(stream, value);
-            stream << ",";
-            stream << std::get<fieldId>(value);
+            if(!_stream.Enter())
+            {
+                _stream << FormatT::ObjectBegin << "..." << FormatT::ObjectEnd;
+                return;
+            }
+            //  Stops at the first field after the budget is spent
+            ((_stream.IsExhausted() || (_stream << Plan::Run(Position), Visit(Reflection::GetFieldValue<Plan::FieldId(Position)>(value)), false)) || ...);
+            _stream << Plan::Run(Plan::COUNT_OF_FIELDS);
+            _stream.Leave();
         }
-    };
+        else
+        {
+            ((_stream << Plan::Run(Position), Visit(Reflection::GetFieldValue<Plan::FieldId(Position)>(value))), ...);
+            _stream << Plan::Run(Plan::COUNT_OF_FIELDS);
+        }
+    }
 
-    template<typename T, typename S>
-    struct TupleVisitor<0, T, S>
+    static void AppendUtf8(std::string& text, uint32_t code)
     {
-        static void Visit(S& stream, const T& value)
+        if(code > 0x10FFFF || (code >= 0xD800 && code < 0xE000))
+            code = 0xFFFD;
+
+        if(code < 0x80)
+            text += static_cast<char>(code);
+        else if(code < 0x800)
         {
-            stream << std::get<0>(value);
+            text += static_cast<char>(0xC0 | (code >> 6));
+            text += static_cast<char>(0x80 | (code & 0x3F));
         }
-    };
+        else if(code < 0x10000)
+        {
+            text += static_cast<char>(0xE0 | (code >> 12));
+            text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            text += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else
+        {
+            text += static_cast<char>(0xF0 | (code >> 18));
+            text += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            text += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    template<class T, size_t... Index>
+    void VisitTuple(const T& value, std::index_sequence<Index...>)
+    {
+        ((_stream << (Index == 0 ? "" : ","), Visit(std::get<Index>(value))), ...);
+    }
 
 public:
     ObjectPrinter(StreamT& stream) : _stream(stream) {}
@@ -134,9 +333,33 @@ public:
     //
     //  Define specifications for strings, since we redefine Visit for generic "T*""
     //
-    void Visit(const char* value) { _stream << value; }
+    void Visit(const char* value) { FormatT::WriteString(_stream, value); }
+
+    //
+    //  Wide strings are narrowed to UTF-8 and written by the format like
+    //  other strings
+    //
+    void Visit(const wchar_t* value)
+    {
+        if(!value)
+        {
+            _stream << FormatT::Null;
+            return;
+        }
 
-    void Visit(const wchar_t* value) { _stream << value; }
+        std::string text;
+        for(; *value; ++value)
+        {
+            uint32_t code = static_cast<uint32_t>(*value);
+            if(sizeof(wchar_t) == 2 && code >= 0xD800 && code < 0xDC00 && value[1] >= 0xDC00 && value[1] < 0xE000)
+                code = 0x10000 + ((code - 0xD800) << 10) + (static_cast<uint32_t>(*++value) - 0xDC00);
+            AppendUtf8(text, code);
+        }
+        FormatT::WriteString(_stream, text);
+    }
+
+    template<class Traits, class Allocator>
+    void Visit(const std::basic_string<char, Traits, Allocator>& value) { FormatT::WriteString(_stream, value); }
 
     //
     //  Pointers (including smart)
@@ -148,7 +371,7 @@ public:
     void Visit(const std::unique_ptr<T, Deleter>& value) { VisitPtr(value); }
 
     template<class T>
-    void Visit(const std::shared_ptr<T>& value) { Visit(value); }
+    void Visit(const std::shared_ptr<T>& value) { VisitPtr(value); }
 
     template<class T>
     void Visit(const std::weak_ptr<T>& value) { Visit(value.lock()); }
@@ -159,19 +382,19 @@ public:
     template<typename T1, typename T2>
     void Visit(const std::pair<T1, T2>& value)
     {
-        _stream << "{";
+        _stream << FormatT::TupleBegin;
         Visit(value.first);
         _stream << ",";
         Visit(value.second);
-        _stream << "}";
+        _stream << FormatT::TupleEnd;
     }
 
     template<typename... TupleTypes>
     void Visit(const std::tuple<TupleTypes...>& value)
     {
-        _stream << "{";
-        TupleVisitor<sizeof...(TupleTypes)-1, std::tuple<TupleTypes...>, ObjectPrinter>::Visit(*this, value);
-        _stream << "}";
+        _stream << FormatT::TupleBegin;
+        VisitTuple(value, std::index_sequence_for<TupleTypes...>());
+        _stream << FormatT::TupleEnd;
     }
 
     //
@@ -223,33 +446,34 @@ public:
     void Visit(const std::unordered_multimap<Key, T, Hash, KeyEqual, Allocator>& value) { VisitList(value); }
 
     //
-    //  Specification for reflectable class
+    //  Specification for reflectable class. Constant text between field values
+    //  is precomputed by FieldFormatPlan and written as a single run.
     //
     template<class T>
     typename std::enable_if_t<Reflection::IsReflectable<T>(), void> Visit(const T& value)
     {
-        ReflectionFieldStreamWriterVisitor<ObjectPrinter> visitor(*this);
-        _stream << "{";
-        Reflection::VisitFields(value, visitor);
-        _stream << "}";
+        VKLIB_INSTRUMENT_STREAM(T, Print, _stream);
+        typedef FieldFormatPlan<T, FormatT> Plan;
+        VisitFields<Plan>(value, std::make_integer_sequence<uint32_t, Plan::COUNT_OF_FIELDS>());
     }
 
-    template<class T>
-    bool VisitField(const char* fieldName, const T& value)
+    //
+    //  Prints only fields of the projection, nested values are printed fully
+    //
+    template<class ProjectionT, class T>
+    void VisitProjection(const T& value)
     {
-        _stream << fieldName << "=";
-        Visit(value, *this);
-        _stream << " ";
-        return true;
+        typedef FieldFormatPlan<T, FormatT, typename ProjectionT::FieldIds> Plan;
+        VisitFields<Plan>(value, std::make_integer_sequence<uint32_t, Plan::COUNT_OF_FIELDS>());
     }
 
     //
-    //  General case - just leave for stream to resolve
+    //  General case - just leave for format (by default for stream) to resolve
     //
     template<class T>
     typename std::enable_if_t<!Reflection::IsReflectable<T>(), void> Visit(const T& value)
     {
-        _stream << value;
+        FormatT::WriteValue(_stream, value);
     }
 
     template<class T>
@@ -263,16 +487,53 @@ public:
 template<typename StreamT, typename ObjectT>
 void ToString(StreamT& stream, ObjectT& obj)
 {
-    ObjectPrinter<std::stringstream> printer(stream);
+    ObjectPrinter<StreamT> printer(stream);
     printer.Visit(obj);
 }
 
 template<typename ObjectT>
 std::string ToString(ObjectT& obj)
 {
-    std::stringstream ss;
-    ToString(ss, obj);
-    return ss.str();
+    TextBuffer<> buffer;
+    ToString(buffer, obj);
+    return buffer.Str();
+}
+
+//
+//  ToString of the projection fields, e.g. ToString<Record::Key>(record)
+//
+template<typename ProjectionT, typename StreamT, typename ObjectT>
+std::enable_if_t<IsFieldProjection<ProjectionT>::value> ToString(StreamT& stream, ObjectT& obj)
+{
+    ObjectPrinter<StreamT> printer(stream);
+    printer.template VisitProjection<ProjectionT>(obj);
+}
+
+template<typename ProjectionT, typename ObjectT>
+std::enable_if_t<IsFieldProjection<ProjectionT>::value, std::string> ToString(ObjectT& obj)
+{
+    TextBuffer<> buffer;
+    ToString<ProjectionT>(buffer, obj);
+    return buffer.Str();
+}
+
+//
+//  ToString within the limits, cost of printing doesn't depend on size of
+//  containers beyond them
+//
+template<typename StreamT, typename ObjectT>
+void BoundedToString(StreamT& stream, ObjectT& obj, const PrintLimits& limits)
+{
+    BoundedWriter<StreamT> writer(stream, limits);
+    ToString(writer, obj);
+}
+
+template<typename ObjectT>
+std::string BoundedToString(ObjectT& obj, const PrintLimits& limits)
+{
+    TextBuffer<> buffer;
+    BoundedToString(buffer, obj, limits);
+    return buffer.Str();
 }
 
 };  //  namespace vklib